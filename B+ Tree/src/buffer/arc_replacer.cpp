@@ -0,0 +1,235 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.cpp
+//
+// Identification: src/buffer/arc_replacer.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/arc_replacer.h"
+
+#include <algorithm>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+ARCReplacer::ARCReplacer(size_t num_pages)
+    : num_pages_(num_pages),
+      target_(0),
+      location_(num_pages, Location::NONE),
+      position_(num_pages),
+      page_(num_pages, INVALID_PAGE_ID),
+      referenced_(num_pages, false),
+      evictable_(num_pages, false),
+      size_(0) {}
+
+ARCReplacer::~ARCReplacer() = default;
+
+// REPLACE from the paper: take from T1 while it is larger than its target, otherwise from T2. If the preferred list
+// has nothing unpinned (and accepted), fall back to the other one.
+bool ARCReplacer::VictimIf(frame_id_t *frame_id, const FrameFilter &accept) {
+  if (size_ == 0) {
+    return false;
+  }
+  if (EvictFrom(&once_, nullptr, accept, frame_id)) {
+    return true;
+  }
+  if (!t1_.empty() && t1_.size() > target_) {
+    return EvictFrom(&t1_, &b1_, accept, frame_id) || EvictFrom(&t2_, &b2_, accept, frame_id);
+  }
+  return EvictFrom(&t2_, &b2_, accept, frame_id) || EvictFrom(&t1_, &b1_, accept, frame_id);
+}
+
+void ARCReplacer::Pin(frame_id_t frame_id) {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_pages_ || !evictable_[frame_id]) {
+    return;
+  }
+  evictable_[frame_id] = false;
+  size_--;
+}
+
+void ARCReplacer::Unpin(frame_id_t frame_id, AccessType access_type) {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_pages_ || evictable_[frame_id]) {
+    return;
+  }
+  if (location_[frame_id] == Location::NONE) {
+    // never told which page it holds: treat it as a page seen once
+    t1_.push_front(frame_id);
+    position_[frame_id] = t1_.begin();
+    location_[frame_id] = Location::T1;
+  }
+  if (referenced_[frame_id]) {
+    // the page had a normal access since it came in: a scan passing over it leaves it where it is
+    access_type = AccessType::NORMAL;
+  }
+  if (access_type == AccessType::ONCE && location_[frame_id] != Location::ONCE) {
+    // ONCE: out of T1 / T2 altogether, onto the list Victim empties first
+    once_.splice(once_.begin(), ListOf(location_[frame_id]), position_[frame_id]);
+    location_[frame_id] = Location::ONCE;
+  } else if (access_type == AccessType::SCAN && location_[frame_id] == Location::T1) {
+    // SCAN: LRU end of T1, the first place Victim looks while T1 is over its target
+    t1_.splice(t1_.end(), t1_, position_[frame_id]);
+  }
+  evictable_[frame_id] = true;
+  size_++;
+}
+
+size_t ARCReplacer::Size() { return size_; }
+
+void ARCReplacer::RecordAccess(frame_id_t frame_id, page_id_t page_id, AccessType access_type) {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_pages_) {
+    return;
+  }
+  // Case I: hit on a resident page, it has now been referenced at least twice. Re-reading a page during a scan
+  // says nothing about its frequency, so a scan hit leaves the page where it is.
+  if (location_[frame_id] != Location::NONE && page_[frame_id] == page_id) {
+    if (access_type != AccessType::NORMAL) {
+      return;
+    }
+    referenced_[frame_id] = true;
+    t2_.splice(t2_.begin(), ListOf(location_[frame_id]), position_[frame_id]);
+    location_[frame_id] = Location::T2;
+    return;
+  }
+
+  // a new page moves into the frame
+  Unlink(frame_id);
+  page_[frame_id] = page_id;
+  referenced_[frame_id] = access_type == AccessType::NORMAL;
+  if (EraseGhost(&b1_, page_id)) {
+    // Case II: T1 evicted it too early, grow T1
+    size_t delta = std::max<size_t>(b2_.size() / (b1_.size() + 1), 1);
+    target_ = std::min(target_ + delta, num_pages_);
+    t2_.push_front(frame_id);
+    location_[frame_id] = Location::T2;
+  } else if (EraseGhost(&b2_, page_id)) {
+    // Case III: T2 evicted it too early, grow T2
+    size_t delta = std::max<size_t>(b1_.size() / (b2_.size() + 1), 1);
+    target_ = target_ > delta ? target_ - delta : 0;
+    t2_.push_front(frame_id);
+    location_[frame_id] = Location::T2;
+  } else {
+    // Case IV: a page we have never seen (or have forgotten)
+    t1_.push_front(frame_id);
+    location_[frame_id] = Location::T1;
+  }
+  position_[frame_id] = location_[frame_id] == Location::T1 ? t1_.begin() : t2_.begin();
+  TrimGhosts();
+}
+
+void ARCReplacer::Remove(frame_id_t frame_id) {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_pages_) {
+    return;
+  }
+  Unlink(frame_id);
+  page_[frame_id] = INVALID_PAGE_ID;
+  referenced_[frame_id] = false;
+}
+
+// ONCE frames first, as in Victim. Then replays REPLACE without evicting: every frame taken from T1 shrinks it, which
+// is what decides when Victim switches over to T2. Evictions alone never move the target, so the replay is exact.
+void ARCReplacer::PeekVictims(size_t max_frames, std::vector<frame_id_t> *frame_ids) {
+  frame_ids->clear();
+  for (auto it = once_.rbegin(); it != once_.rend() && frame_ids->size() < max_frames; ++it) {
+    if (evictable_[*it]) {
+      frame_ids->push_back(*it);
+    }
+  }
+  size_t t1_size = t1_.size();
+  auto it1 = t1_.rbegin();
+  auto it2 = t2_.rbegin();
+  while (frame_ids->size() < max_frames) {
+    while (it1 != t1_.rend() && !evictable_[*it1]) {
+      ++it1;
+    }
+    while (it2 != t2_.rend() && !evictable_[*it2]) {
+      ++it2;
+    }
+    bool has_t1 = it1 != t1_.rend();
+    bool has_t2 = it2 != t2_.rend();
+    if (!has_t1 && !has_t2) {
+      break;
+    }
+    if (has_t1 && (t1_size > target_ || !has_t2)) {
+      frame_ids->push_back(*it1++);
+      t1_size--;
+    } else {
+      frame_ids->push_back(*it2++);
+    }
+  }
+}
+
+bool ARCReplacer::EvictFrom(std::list<frame_id_t> *list, GhostList *ghost, const FrameFilter &accept,
+                            frame_id_t *frame_id) {
+  for (auto it = list->rbegin(); it != list->rend(); ++it) {
+    if (!evictable_[*it] || (accept && !accept(*it))) {
+      continue;
+    }
+    *frame_id = *it;
+    PushGhost(ghost, page_[*frame_id]);
+    Unlink(*frame_id);
+    page_[*frame_id] = INVALID_PAGE_ID;
+    TrimGhosts();
+    return true;
+  }
+  return false;
+}
+
+void ARCReplacer::Unlink(frame_id_t frame_id) {
+  if (location_[frame_id] == Location::NONE) {
+    return;
+  }
+  ListOf(location_[frame_id]).erase(position_[frame_id]);
+  location_[frame_id] = Location::NONE;
+  if (evictable_[frame_id]) {
+    evictable_[frame_id] = false;
+    size_--;
+  }
+}
+
+std::list<frame_id_t> &ARCReplacer::ListOf(Location location) {
+  BUSTUB_ASSERT(location != Location::NONE, "frame is on no list");
+  if (location == Location::T1) {
+    return t1_;
+  }
+  return location == Location::T2 ? t2_ : once_;
+}
+
+bool ARCReplacer::EraseGhost(GhostList *ghost, page_id_t page_id) {
+  auto it = ghost->index_.find(page_id);
+  if (it == ghost->index_.end()) {
+    return false;
+  }
+  ghost->order_.erase(it->second);
+  ghost->index_.erase(it);
+  return true;
+}
+
+void ARCReplacer::PushGhost(GhostList *ghost, page_id_t page_id) {
+  if (ghost == nullptr || page_id == INVALID_PAGE_ID) {
+    return;
+  }
+  EraseGhost(ghost, page_id);
+  ghost->order_.push_front(page_id);
+  ghost->index_[page_id] = ghost->order_.begin();
+}
+
+void ARCReplacer::TrimGhosts() {
+  auto drop_lru = [](GhostList *ghost) {
+    ghost->index_.erase(ghost->order_.back());
+    ghost->order_.pop_back();
+  };
+  while (!b1_.order_.empty() && t1_.size() + b1_.size() > num_pages_) {
+    drop_lru(&b1_);
+  }
+  while (t1_.size() + t2_.size() + b1_.size() + b2_.size() > 2 * num_pages_) {
+    drop_lru(b2_.order_.empty() ? &b1_ : &b2_);
+  }
+}
+
+}  // namespace bustub
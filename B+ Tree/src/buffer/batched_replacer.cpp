@@ -0,0 +1,141 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// batched_replacer.cpp
+//
+// Identification: src/buffer/batched_replacer.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/batched_replacer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+namespace bustub {
+
+namespace {
+/** Stripe used by the calling thread, assigned round robin the first time the thread touches a replacer. */
+size_t ThreadStripe() {
+  static std::atomic<size_t> next_stripe{0};
+  thread_local size_t stripe = next_stripe.fetch_add(1, std::memory_order_relaxed) % BatchedReplacer::NUM_STRIPES;
+  return stripe;
+}
+}  // namespace
+
+BatchedReplacer::BatchedReplacer(Replacer *replacer, std::function<bool(frame_id_t)> is_pinned, size_t batch_size)
+    : replacer_(replacer), is_pinned_(std::move(is_pinned)), batch_size_(batch_size == 0 ? 1 : batch_size) {
+  for (auto &stripe : stripes_) {
+    stripe.buffer_.reserve(4 * batch_size_);
+  }
+}
+
+BatchedReplacer::~BatchedReplacer() { delete replacer_; }
+
+bool BatchedReplacer::VictimIf(frame_id_t *frame_id, const FrameFilter &accept) {
+  std::scoped_lock lock(latch_);
+  DrainAll();
+  while (replacer_->VictimIf(frame_id, accept)) {
+    if (!is_pinned_(*frame_id)) {
+      return true;
+    }
+    // pinned by an access that is still in flight; its Unpin will bring the frame back
+  }
+  return false;
+}
+
+void BatchedReplacer::Pin(frame_id_t frame_id) {
+  Record({AccessKind::PIN, frame_id, INVALID_PAGE_ID, AccessType::NORMAL});
+}
+
+void BatchedReplacer::Unpin(frame_id_t frame_id, AccessType access_type) {
+  Record({AccessKind::UNPIN, frame_id, INVALID_PAGE_ID, access_type});
+}
+
+size_t BatchedReplacer::Size() {
+  std::scoped_lock lock(latch_);
+  DrainAll();
+  return replacer_->Size();
+}
+
+void BatchedReplacer::RecordAccess(frame_id_t frame_id, page_id_t page_id, AccessType access_type) {
+  Record({AccessKind::ACCESS, frame_id, page_id, access_type});
+}
+
+void BatchedReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock lock(latch_);
+  DrainAll();
+  replacer_->Remove(frame_id);
+}
+
+void BatchedReplacer::PeekVictims(size_t max_frames, std::vector<frame_id_t> *frame_ids) {
+  std::scoped_lock lock(latch_);
+  DrainAll();
+  replacer_->PeekVictims(max_frames, frame_ids);
+  // same re-check as Victim: drop frames pinned by accesses that are still in flight
+  frame_ids->erase(std::remove_if(frame_ids->begin(), frame_ids->end(), is_pinned_), frame_ids->end());
+}
+
+void BatchedReplacer::Record(const Access &access) {
+  Stripe &stripe = stripes_[ThreadStripe()];
+  std::vector<Access> batch;
+  {
+    std::unique_lock stripe_lock(stripe.latch_);
+    stripe.buffer_.push_back(access);
+    if (stripe.buffer_.size() < batch_size_) {
+      return;
+    }
+    // try_lock under the stripe latch cannot deadlock with DrainAll, which takes latch_ first
+    std::unique_lock lock(latch_, std::try_to_lock);
+    if (lock.owns_lock()) {
+      batch.swap(stripe.buffer_);
+      stripe_lock.unlock();
+      Commit(batch);
+      batch.clear();
+      // hand the allocation back so the stripe does not reallocate next time
+      stripe_lock.lock();
+      if (stripe.buffer_.empty()) {
+        stripe.buffer_.swap(batch);
+      }
+      return;
+    }
+    if (stripe.buffer_.size() < 4 * batch_size_) {
+      // someone else is committing; keep buffering instead of waiting
+      return;
+    }
+    batch.swap(stripe.buffer_);
+  }
+  // the buffer hit its hard limit: wait for the replacer lock
+  std::scoped_lock lock(latch_);
+  Commit(batch);
+}
+
+void BatchedReplacer::Commit(const std::vector<Access> &batch) {
+  for (const auto &access : batch) {
+    if (access.kind_ == AccessKind::ACCESS) {
+      replacer_->RecordAccess(access.frame_id_, access.page_id_, access.access_type_);
+    } else if (is_pinned_(access.frame_id_)) {
+      replacer_->Pin(access.frame_id_);
+    } else {
+      replacer_->Unpin(access.frame_id_, access.access_type_);
+    }
+  }
+}
+
+void BatchedReplacer::DrainAll() {
+  std::vector<Access> batch;
+  for (auto &stripe : stripes_) {
+    {
+      std::scoped_lock stripe_lock(stripe.latch_);
+      batch.swap(stripe.buffer_);
+    }
+    Commit(batch);
+    batch.clear();
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,1367 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_manager_instance.cpp
+//
+// Identification: src/buffer/buffer_pool_manager_instance.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_manager_instance.h"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <future>  // NOLINT
+#include <list>
+#include <string>
+#include <utility>
+
+#include "buffer/arc_replacer.h"
+#include "buffer/batched_replacer.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "common/logger.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+namespace {
+/** Warm restart file layout: this magic number, the number of page ids as a uint64_t, then the page ids. */
+constexpr uint32_t WARM_FILE_MAGIC = 0x57524d31;  // "WRM1"
+}  // namespace
+
+BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager,
+                                                     LogManager *log_manager, const BufferPoolOptions &options)
+    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, log_manager, options) {}
+
+BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                                                     DiskManager *disk_manager, LogManager *log_manager,
+                                                     const BufferPoolOptions &options,
+                                                     DiskScheduler *disk_scheduler)
+    : pool_size_(pool_size),
+      max_pool_size_(std::max(options.max_pool_size_, pool_size)),
+      num_instances_(num_instances),
+      instance_index_(instance_index),
+      next_page_id_(instance_index),
+      arena_(max_pool_size_, pool_size, options.huge_pages_, options.prefault_threads_),
+      disk_manager_(disk_manager),
+      log_manager_(log_manager),
+      disk_scheduler_(disk_scheduler != nullptr ? disk_scheduler
+                                                : new DiskScheduler(disk_manager, options.io_queue_depth_,
+                                                                    options.db_file_, options.direct_io_)),
+      owns_disk_scheduler_(disk_scheduler == nullptr),
+      page_table_(max_pool_size_),
+      cleaner_buffer_(std::max<size_t>(options.cleaner_max_writes_, 1),
+                      options.cleaner_interval_ms_ > 0 ? options.cleaner_max_writes_ : 0, HugePagePolicy::NONE, 1),
+      options_(options) {
+  BUSTUB_ASSERT(num_instances > 0, "If BPI is not part of a pool, then the pool size should just be 1");
+  BUSTUB_ASSERT(
+      instance_index < num_instances,
+      "BPI index cannot be greater than the number of BPIs in the pool. In non-parallel case, index should just be 1.");
+  // We allocate a consecutive memory space for the buffer pool: the frames live in the arena, page aligned and
+  // already faulted in, the pages only hold the book-keeping.
+  pages_ = new Page[max_pool_size_];
+  for (size_t i = 0; i < max_pool_size_; ++i) {
+    pages_[i].data_ = arena_.GetFrame(static_cast<frame_id_t>(i));
+  }
+  switch (options.replacer_policy_) {
+    case ReplacerPolicy::CLOCK:
+      replacer_ = new ClockReplacer(max_pool_size_);
+      break;
+    case ReplacerPolicy::LRU_K:
+      replacer_ = new LRUKReplacer(max_pool_size_, options.lru_k_, options.lru_k_correlated_window_);
+      break;
+    case ReplacerPolicy::ARC:
+      replacer_ = new ARCReplacer(max_pool_size_);
+      break;
+    case ReplacerPolicy::LRU:
+    default:
+      replacer_ = new LRUReplacer(max_pool_size_);
+      break;
+  }
+  if (options.replacer_batch_size_ > 0) {
+    replacer_unlatched_ = true;
+    // called without latch_, by whichever thread commits a batch; pin_count_ is atomic for this, and a relaxed load is
+    // enough, as a stale answer is corrected by the Pin / Unpin entry that changed the count, committed later
+    replacer_ = new BatchedReplacer(
+        replacer_,
+        [this](frame_id_t frame_id) { return pages_[frame_id].pin_count_.load(std::memory_order_relaxed) > 0; },
+        options.replacer_batch_size_);
+  }
+
+  if (options.compressed_cache_bytes_ > 0) {
+    compressed_cache_ = new CompressedPageCache(options.compressed_cache_bytes_);
+  }
+  if (!options.spill_file_.empty() && options.spill_capacity_pages_ > 0) {
+    spill_cache_ = new SpillCache(InstanceFile(options.spill_file_), options.spill_capacity_pages_,
+                                  options.io_queue_depth_);
+  }
+
+  io_in_progress_.resize(max_pool_size_, false);
+  io_prefetch_.resize(max_pool_size_, false);
+  io_reads_.resize(max_pool_size_);
+
+  // a reopened database: new pages go past the ones on disk
+  if (!options.db_file_.empty()) {
+    next_page_id_ = FirstFreePageId(options.db_file_);
+  } else if (options.direct_io_) {
+    LOG_WARN("BufferPoolManagerInstance: direct_io_ without db_file_, using buffered I/O");
+  } else if (!options.warm_file_.empty()) {
+    LOG_WARN("BufferPoolManagerInstance: warm restart without db_file_, new page ids start at %d again",
+             next_page_id_);
+  }
+
+  // the default partition has no quota
+  AddPartition("default", 0, max_pool_size_);
+  frame_partition_.resize(max_pool_size_, DEFAULT_PARTITION);
+
+  // Initially, every page is in the free list.
+  free_list_pos_.resize(max_pool_size_);
+  in_free_list_.resize(max_pool_size_, false);
+  for (size_t i = 0; i < pool_size_; ++i) {
+    PushFreeFrame(static_cast<frame_id_t>(i));
+  }
+
+  if (!options.warm_file_.empty()) {
+    warm_file_ = InstanceFile(options.warm_file_);
+    LoadWarmSet();
+  }
+
+  cleaner_writing_.resize(max_pool_size_, false);
+  if (options.cleaner_interval_ms_ > 0 && options.cleaner_max_writes_ > 0) {
+    SetCleanerWatermarks();
+    cleaner_thread_ = std::thread(&BufferPoolManagerInstance::CleanerLoop, this);
+  }
+  if (!warm_file_.empty() && options.warm_save_interval_ms_ > 0) {
+    warm_saver_thread_ = std::thread(&BufferPoolManagerInstance::WarmSaverLoop, this);
+  }
+}
+
+BufferPoolManagerInstance::~BufferPoolManagerInstance() {
+  if (cleaner_thread_.joinable()) {
+    {
+      std::scoped_lock latch{latch_};
+      cleaner_stop_ = true;
+    }
+    cleaner_cv_.notify_one();
+    cleaner_thread_.join();
+  }
+  if (warm_saver_thread_.joinable()) {
+    {
+      std::scoped_lock latch{latch_};
+      warm_saver_stop_ = true;
+    }
+    warm_saver_cv_.notify_one();
+    warm_saver_thread_.join();
+  }
+  // a clean shutdown: the next instance starts with what this one has in memory now
+  SaveWarmSet();
+  // outstanding prefetches still read into pages_
+  for (auto &read : io_reads_) {
+    if (read.valid()) {
+      read.wait();
+    }
+  }
+  if (owns_disk_scheduler_) {
+    delete disk_scheduler_;
+  }
+  delete[] pages_;
+  delete replacer_;
+  delete compressed_cache_;
+  delete spill_cache_;
+  for (auto *view : partition_views_) {
+    delete view;
+  }
+}
+
+Page *BufferPoolManagerInstance::FetchPageImpl(page_id_t page_id, AccessType access_type, partition_id_t partition) {
+  if (page_id == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+  std::unique_lock latch{latch_};
+  ReapPrefetches();
+  // 1.     Search the page table for the requested page (P).
+  // page_id exists in the table
+
+  frame_id_t frame_id;
+  frame_id_t frame_to_evict;
+  while (true) {
+    while (page_table_.Find(page_id, &frame_id)) {
+      if (!io_in_progress_[frame_id]) {
+        // 1.1    If P exists, pin it and return it immediately.
+        pages_[frame_id].pin_count_ += 1;
+        metrics_.fetch_hits_++;
+        partitions_[partition].fetch_hits_++;
+        if (replacer_unlatched_) {
+          // our pin keeps the page in the frame; the replacer sorts out the order of the accesses itself
+          latch.unlock();
+        }
+        replacer_->RecordAccess(frame_id, page_id, access_type);
+        replacer_->Pin(frame_id);
+        return &pages_[frame_id];
+      }
+      // P is being read in by another fetch or a prefetch: wait for that read instead of issuing a second one, then
+      // look again
+      std::shared_future<bool> read = io_reads_[frame_id];
+      latch.unlock();
+      read.wait();
+      latch.lock();
+      FinishRead(frame_id);
+    }
+    // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
+    // 2.     If R is dirty, write it back to the disk.
+    // 3.     Delete R from the page table and insert P.
+    if (TakeFrame(&frame_to_evict, partition)) {
+      break;
+    }
+    // every frame is pinned; frames pinned only by a prefetch come free once its read completes, and frames skipped
+    // because the cleaner is writing them, or because the log is not on disk up to their LSN, once that is done
+    if (!WaitForPrefetch(&latch) && !WaitForCleanerBatch(&latch) && !ForceEvictionLog(&latch)) {
+      metrics_.fetch_failures_++;
+      partitions_[partition].failures_++;
+      return nullptr;
+    }
+  }
+  metrics_.fetch_misses_++;
+  partitions_[partition].fetch_misses_++;
+  page_table_.Insert(page_id, frame_to_evict);
+
+  // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
+  //        Optimistic readers fail on the frame until FinishRead, as it holds P before P's data is in.
+  pages_[frame_to_evict].BeginWrite();
+  pages_[frame_to_evict].page_id_ = page_id;
+  pages_[frame_to_evict].pin_count_ = 1;
+  pages_[frame_to_evict].is_dirty_ = false;
+  replacer_->RecordAccess(frame_to_evict, page_id, access_type);
+  replacer_->Pin(frame_to_evict);
+
+  // 5.     Read P in without holding the latch. The frame is pinned, so it cannot be evicted meanwhile, and marked as
+  //        I/O in progress, so concurrent fetches of P wait for this read.
+  std::shared_future<bool> read = StartRead(frame_to_evict);
+  RunTierWork(&latch);
+  latch.unlock();
+  read.wait();
+  latch.lock();
+  FinishRead(frame_to_evict);
+  if (!read.get()) {
+    // FinishRead took P out of the page table, so this fetch holds the only pin
+    FreeFrame(frame_to_evict);
+    metrics_.fetch_failures_++;
+    partitions_[partition].failures_++;
+    return nullptr;
+  }
+  Page *result = &pages_[frame_to_evict];
+
+  return result;
+}
+
+bool BufferPoolManagerInstance::PrefetchPageImpl(page_id_t page_id, AccessType access_type,
+                                                 partition_id_t partition) {
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  std::unique_lock latch{latch_};
+  ReapPrefetches();
+  bool resident = StartPrefetch(page_id, access_type, partition);
+  RunTierWork(&latch);
+  return resident;
+}
+
+void BufferPoolManagerInstance::PrefetchPagesImpl(const std::vector<page_id_t> &page_ids, AccessType access_type,
+                                                  partition_id_t partition) {
+  std::unique_lock latch{latch_};
+  ReapPrefetches();
+  for (page_id_t page_id : page_ids) {
+    if (page_id != INVALID_PAGE_ID) {
+      StartPrefetch(page_id, access_type, partition);
+    }
+  }
+  RunTierWork(&latch);
+}
+
+bool BufferPoolManagerInstance::UnpinPageImpl(page_id_t page_id, bool is_dirty, AccessType access_type) {
+  std::unique_lock latch{latch_};
+  frame_id_t frame_id;
+  if (!page_table_.Find(page_id, &frame_id)) {
+    // page_id doesn't exist
+    return false;
+  }
+  if (pages_[frame_id].GetPinCount() <= 0) {
+    return false;
+  }
+  UnpinFrame(&latch, frame_id, is_dirty, access_type);
+  return true;
+}
+
+bool BufferPoolManagerInstance::FlushPageImpl(page_id_t page_id) {
+  std::unique_lock latch{latch_};
+  // Make sure you call DiskManager::WritePage!
+  // page_id exists in the table
+  frame_id_t frame_id;
+  do {
+    if (!page_table_.Find(page_id, &frame_id)) {
+      return false;
+    }
+    // the page may have moved while we waited for the cleaner or the log: look it up again
+  } while (WaitForCleaner(&latch, frame_id) ||
+           (!io_in_progress_[frame_id] && ForceLog(&latch, pages_[frame_id].GetLSN())));
+  return FlushFrame(frame_id);
+}
+
+bool BufferPoolManagerInstance::FlushFrame(frame_id_t frame_id) {
+  // a page still being read in is the same as on disk, and its frame holds only part of it
+  if (io_in_progress_[frame_id]) {
+    return true;
+  }
+  // flushing does not touch the pin count: other threads may still be holding the page
+  if (!disk_scheduler_->WritePage(pages_[frame_id].GetPageId(), pages_[frame_id].GetData())) {
+    // the frame holds the only up-to-date copy, so it stays dirty
+    metrics_.write_failures_++;
+    return false;
+  }
+  pages_[frame_id].is_dirty_ = false;
+  metrics_.flushes_++;
+  return true;
+}
+
+Page *BufferPoolManagerInstance::NewPageImpl(page_id_t *page_id, partition_id_t partition) {
+  std::unique_lock latch{latch_};
+  ReapPrefetches();
+  *page_id = INVALID_PAGE_ID;
+
+  // 0.   Make sure you call DiskManager::AllocatePage!
+  // 1.   If all the pages in the buffer pool are pinned, return nullptr.
+  // bool all_pinned = true;
+  // if (sizeof(pages_) >= pool_size_) {
+  //   for (unsigned int i = 0; i < sizeof(pages_); i = i + 1) {
+  //     if (pages_[i].GetPinCount() == 0) {
+  //       all_pinned = false;
+  //     }
+  //   }
+  // }
+  // if (all_pinned) {
+  //   return nullptr;
+  // }
+  // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
+  frame_id_t frame_to_evict;
+  while (!TakeFrame(&frame_to_evict, partition)) {
+    if (!WaitForPrefetch(&latch) && !WaitForCleanerBatch(&latch) && !ForceEvictionLog(&latch)) {
+      metrics_.new_page_failures_++;
+      partitions_[partition].failures_++;
+      return nullptr;
+    }
+  }
+  metrics_.new_pages_++;
+  partitions_[partition].new_pages_++;
+  // page ids are handed out per instance so that they route back here in a parallel BPM
+  page_id_t new_page_id = AllocatePage();
+  // 3.   Update P's metadata, zero out memory and add P to the page table.
+  page_table_.Insert(new_page_id, frame_to_evict);
+
+  pages_[frame_to_evict].BeginWrite();
+  pages_[frame_to_evict].ResetMemory();
+  pages_[frame_to_evict].page_id_ = new_page_id;
+  pages_[frame_to_evict].EndWrite();
+  pages_[frame_to_evict].pin_count_ = 1;
+  pages_[frame_to_evict].is_dirty_ = false;
+  replacer_->RecordAccess(frame_to_evict, new_page_id);
+  replacer_->Pin(frame_to_evict);
+
+  // 4.   Set the page ID output parameter. Return a pointer to P.
+  *page_id = new_page_id;
+  Page *result = &pages_[frame_to_evict];
+  RunTierWork(&latch);
+
+  return result;
+}
+
+bool BufferPoolManagerInstance::DeletePageImpl(page_id_t page_id) {
+  std::unique_lock latch{latch_};
+  // a finished prefetch still holds its pin until it is reaped
+  ReapPrefetches();
+  // 0.   Make sure you call DiskManager::DeallocatePage!
+  // 1.   Search the page table for the requested page (P).
+  // 1.   If P does not exist, return true.
+
+  if (compressed_cache_ != nullptr) {
+    compressed_cache_->Erase(page_id);
+    compress_tickets_.erase(page_id);
+  }
+  if (spill_cache_ != nullptr) {
+    spill_cache_->Erase(page_id);
+  }
+  frame_id_t frame;
+  do {
+    if (!page_table_.Find(page_id, &frame)) {
+      return true;
+    }
+    // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
+    if (pages_[frame].GetPinCount() > 0) {
+      return false;
+    }
+    // anything may have happened to P while we waited for the cleaner or the log: look again
+  } while (WaitForCleaner(&latch, frame) || (pages_[frame].IsDirty() && ForceLog(&latch, pages_[frame].GetLSN())));
+  if (pages_[frame].IsDirty()) {
+    if (!disk_scheduler_->WritePage(pages_[frame].GetPageId(), pages_[frame].GetData())) {
+      metrics_.write_failures_++;
+      return false;
+    }
+  }
+  page_table_.Erase(page_id);
+
+  pages_[frame].BeginWrite();
+  pages_[frame].ResetMemory();
+  pages_[frame].EndWrite();
+  // remove frame from LRU list, the deleted page should not be remembered
+  FreeFrame(frame);
+  DeallocatePage(page_id);
+  metrics_.deletes_++;
+
+  return true;
+}
+
+void BufferPoolManagerInstance::FlushAllPagesImpl(FlushStats *stats) {
+  auto start = std::chrono::steady_clock::now();
+  std::unique_lock latch{latch_};
+  // 1.   Collect the dirty frames, including those of a shrink still waiting for their last unpin. A page being read
+  //      in is the same as on disk. An older copy of a page written by the cleaner must not land on disk after this
+  //      one; if we have to wait for the cleaner, the pool may have changed meanwhile, so we start over. So we do
+  //      after forcing the log, once for all of them, with latch_ released.
+  std::vector<std::pair<page_id_t, frame_id_t>> dirty;
+  lsn_t max_lsn;
+  do {
+    dirty.clear();
+    max_lsn = INVALID_LSN;
+    for (size_t i = 0; i < max_pool_size_; i++) {
+      auto frame_id = static_cast<frame_id_t>(i);
+      if (pages_[i].GetPageId() != INVALID_PAGE_ID && pages_[i].IsDirty() && !io_in_progress_[i]) {
+        if (WaitForCleaner(&latch, frame_id)) {
+          dirty.clear();
+          max_lsn = INVALID_LSN;
+          i = static_cast<size_t>(-1);
+          continue;
+        }
+        dirty.emplace_back(pages_[i].GetPageId(), frame_id);
+        max_lsn = std::max(max_lsn, pages_[i].GetLSN());
+      }
+    }
+  } while (ForceLog(&latch, max_lsn));
+
+  // 2.   Sort by page id and write each run of consecutive page ids with one request. All the requests are scheduled
+  //      before waiting for any, so the scheduler's I/O threads work on them in parallel.
+  std::sort(dirty.begin(), dirty.end());
+  size_t max_run = std::max<size_t>(options_.flush_max_run_pages_, 1);
+  std::vector<std::pair<size_t, size_t>> runs;
+  std::vector<std::future<bool>> writes;
+  for (size_t begin = 0; begin < dirty.size();) {
+    size_t end = begin + 1;
+    while (end < dirty.size() && end - begin < max_run && dirty[end].first == dirty[end - 1].first + 1) {
+      end++;
+    }
+    DiskRequest r{true, pages_[dirty[begin].second].data_, dirty[begin].first, disk_scheduler_->CreatePromise(),
+                  nullptr, {}, {}};
+    if (end - begin > 1) {
+      for (size_t i = begin; i < end; i++) {
+        r.iov_.push_back(pages_[dirty[i].second].data_);
+      }
+    }
+    writes.push_back(r.callback_.get_future());
+    disk_scheduler_->Schedule(std::move(r));
+    runs.emplace_back(begin, end);
+    begin = end;
+  }
+
+  // 3.   The pages of every write that succeeded are clean.
+  uint64_t pages_written = 0;
+  for (size_t i = 0; i < runs.size(); i++) {
+    if (writes[i].get()) {
+      for (size_t j = runs[i].first; j < runs[i].second; j++) {
+        pages_[dirty[j].second].is_dirty_ = false;
+      }
+      pages_written += runs[i].second - runs[i].first;
+    } else {
+      metrics_.write_failures_ += runs[i].second - runs[i].first;
+    }
+  }
+  metrics_.flushes_ += pages_written;
+  if (stats != nullptr) {
+    stats->pages_written_ = pages_written;
+    stats->bytes_written_ = pages_written * PAGE_SIZE;
+    stats->write_requests_ = runs.size();
+    stats->elapsed_ns_ = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+  }
+}
+
+bool BufferPoolManagerInstance::ResizeImpl(size_t pool_size) {
+  if (pool_size == 0 || pool_size > max_pool_size_) {
+    return false;
+  }
+  // a shrink releases latch_ while it writes back, so resizes take turns
+  std::scoped_lock resize_latch{resize_latch_};
+  std::unique_lock latch{latch_};
+  size_t reserved = 0;
+  for (const auto &partition : partitions_) {
+    reserved += partition.min_frames_;
+  }
+  if (pool_size < reserved) {
+    return false;
+  }
+  ReapPrefetches();
+  size_t old_size = pool_size_;
+  pool_size_ = pool_size;
+
+  if (pool_size > old_size) {
+    // grow: every frame that is not still holding a pinned page from an earlier shrink becomes free
+    auto begin = static_cast<frame_id_t>(old_size);
+    for (auto frame_id = begin; frame_id < static_cast<frame_id_t>(pool_size); frame_id++) {
+      if (pages_[frame_id].GetPageId() != INVALID_PAGE_ID) {
+        // still in use, or in the replacer after a failed write-back; either way it stays where it is
+        arena_.Populate(begin, frame_id);
+        begin = frame_id + 1;
+        continue;
+      }
+      PushFreeFrame(frame_id);
+    }
+    arena_.Populate(begin, static_cast<frame_id_t>(pool_size));
+  } else {
+    // shrink, 1: the removed frames leave the free list and the replacer, so TakeFrame no longer hands them out.
+    // Pinned frames stay where they are: lookups keep finding their pages, and each is retired on its last unpin.
+    std::vector<frame_id_t> dirty;
+    for (auto frame_id = static_cast<frame_id_t>(pool_size); frame_id < static_cast<frame_id_t>(old_size); frame_id++) {
+      if (in_free_list_[frame_id]) {
+        free_list_.erase(free_list_pos_[frame_id]);
+        in_free_list_[frame_id] = false;
+        continue;
+      }
+      if (pages_[frame_id].GetPageId() == INVALID_PAGE_ID || pages_[frame_id].GetPinCount() > 0) {
+        continue;
+      }
+      replacer_->Remove(frame_id);
+      if (pages_[frame_id].IsDirty()) {
+        dirty.push_back(frame_id);
+      }
+    }
+
+    // 2: write the dirty pages back in batches, like the cleaner, with latch_ released so that fetches go on
+    size_t batch_size = std::max<size_t>(options_.cleaner_max_writes_, 1);
+    for (size_t i = 0; i < dirty.size(); i += batch_size) {
+      std::vector<frame_id_t> batch(dirty.begin() + i, dirty.begin() + std::min(i + batch_size, dirty.size()));
+      metrics_.resize_writes_ += WriteBackFrames(&latch, batch);
+    }
+
+    // 3: evict the pages that are still there and unpinned, which only writes those dirtied again or whose write-back
+    // failed, and give the memory of the empty frames back
+    auto begin = static_cast<frame_id_t>(pool_size);
+    for (auto frame_id = begin; frame_id < static_cast<frame_id_t>(old_size); frame_id++) {
+      Page &page = pages_[frame_id];
+      if (page.GetPageId() != INVALID_PAGE_ID && (page.GetPinCount() > 0 || !EvictFrame(frame_id))) {
+        if (page.GetPinCount() == 0) {
+          // the page could not be written back: TakeFrame retires the frame once it can evict it
+          replacer_->Unpin(frame_id);
+        }
+        arena_.Release(begin, frame_id);
+        begin = frame_id + 1;
+      }
+    }
+    arena_.Release(begin, static_cast<frame_id_t>(old_size));
+  }
+
+  if (cleaner_thread_.joinable()) {
+    SetCleanerWatermarks();
+  }
+  RunTierWork(&latch);
+  return true;
+}
+
+PageHandle BufferPoolManagerInstance::FetchPageHandleImpl(page_id_t page_id, AccessType access_type,
+                                                          partition_id_t partition) {
+  Page *page = FetchPageImpl(page_id, access_type, partition);
+  if (page == nullptr) {
+    return {};
+  }
+  return PageHandle(this, page, static_cast<frame_id_t>(page - pages_), access_type);
+}
+
+PageHandle BufferPoolManagerInstance::NewPageHandleImpl(page_id_t *page_id, partition_id_t partition) {
+  Page *page = NewPageImpl(page_id, partition);
+  if (page == nullptr) {
+    return {};
+  }
+  return PageHandle(this, page, static_cast<frame_id_t>(page - pages_), AccessType::NORMAL);
+}
+
+void BufferPoolManagerInstance::UnpinFrameImpl(frame_id_t frame_id, page_id_t page_id, bool is_dirty,
+                                               AccessType access_type) {
+  std::unique_lock latch{latch_};
+  // the handle's pin keeps the page in its frame, so no page table lookup is needed to find it
+  BUSTUB_ASSERT(pages_[frame_id].page_id_ == page_id && pages_[frame_id].pin_count_ > 0,
+                "the frame does not hold the handle's pinned page");
+  UnpinFrame(&latch, frame_id, is_dirty, access_type);
+}
+
+void BufferPoolManagerInstance::PinFrameImpl(frame_id_t frame_id, page_id_t page_id, AccessType access_type) {
+  std::unique_lock latch{latch_};
+  BUSTUB_ASSERT(pages_[frame_id].page_id_ == page_id && pages_[frame_id].pin_count_ > 0,
+                "the frame does not hold the handle's pinned page");
+  pages_[frame_id].pin_count_ += 1;
+  if (replacer_unlatched_) {
+    latch.unlock();
+  }
+  replacer_->RecordAccess(frame_id, page_id, access_type);
+  replacer_->Pin(frame_id);
+}
+
+Page *BufferPoolManagerInstance::PeekPageImpl(page_id_t page_id, uint64_t *version) {
+  // no latch_: the page table lookup is a hint, the frame's version and page id decide
+  frame_id_t frame_id;
+  if (!page_table_.FindUnlatched(page_id, &frame_id) || frame_id < 0 ||
+      static_cast<size_t>(frame_id) >= max_pool_size_) {
+    return nullptr;
+  }
+  Page *page = &pages_[frame_id];
+  *version = page->GetVersion();
+  // odd: the frame is being written or filled; another page id: the lookup raced with an eviction
+  if ((*version & 1) != 0 || page->GetPageId() != page_id) {
+    return nullptr;
+  }
+  return page;
+}
+
+BufferPoolMetrics BufferPoolManagerInstance::GetMetricsImpl() {
+  BufferPoolMetrics metrics;
+  {
+    std::scoped_lock latch{latch_};
+    metrics = metrics_;
+  }
+  DiskSchedulerStats io = disk_scheduler_->GetStats();
+  metrics.read_latency_ = io.read_latency_;
+  metrics.write_latency_ = io.write_latency_;
+  if (spill_cache_ != nullptr) {
+    metrics.spill_read_latency_ = spill_cache_->GetIOStats().read_latency_;
+  }
+  return metrics;
+}
+
+BufferPoolManager *BufferPoolManagerInstance::CreatePartitionImpl(const std::string &name, size_t min_frames,
+                                                                  size_t max_frames) {
+  std::scoped_lock latch{latch_};
+  size_t reserved = min_frames;
+  for (const auto &partition : partitions_) {
+    if (partition.name_ == name) {
+      return nullptr;
+    }
+    reserved += partition.min_frames_;
+  }
+  if (name.empty() || max_frames == 0 || min_frames > max_frames || reserved > pool_size_) {
+    return nullptr;
+  }
+  partition_views_.push_back(new BufferPoolPartition(this, AddPartition(name, min_frames, max_frames)));
+  return partition_views_.back();
+}
+
+std::vector<BufferPoolPartitionMetrics> BufferPoolManagerInstance::GetPartitionMetricsImpl() {
+  std::scoped_lock latch{latch_};
+  return partitions_;
+}
+
+partition_id_t BufferPoolManagerInstance::AddPartition(const std::string &name, size_t min_frames, size_t max_frames) {
+  BufferPoolPartitionMetrics partition;
+  partition.name_ = name;
+  partition.min_frames_ = min_frames;
+  partition.max_frames_ = max_frames;
+  partitions_.push_back(partition);
+  return static_cast<partition_id_t>(partitions_.size() - 1);
+}
+
+void BufferPoolManagerInstance::PushFreeFrame(frame_id_t frame_id) {
+  free_list_pos_[frame_id] = free_list_.insert(free_list_.end(), frame_id);
+  in_free_list_[frame_id] = true;
+}
+
+frame_id_t BufferPoolManagerInstance::PopFreeFrame() {
+  frame_id_t frame_id = free_list_.front();
+  free_list_.pop_front();
+  in_free_list_[frame_id] = false;
+  return frame_id;
+}
+
+void BufferPoolManagerInstance::SetCleanerWatermarks() {
+  auto frames = [this](double fraction) {
+    return std::max<size_t>(static_cast<size_t>(std::ceil(fraction * static_cast<double>(pool_size_))), 1);
+  };
+  cleaner_low_frames_ = frames(options_.cleaner_low_watermark_);
+  cleaner_high_frames_ = std::max(frames(options_.cleaner_high_watermark_), cleaner_low_frames_);
+}
+
+page_id_t BufferPoolManagerInstance::AllocatePage() {
+  const page_id_t next_page_id = next_page_id_;
+  next_page_id_ += num_instances_;
+  ValidatePageId(next_page_id);
+  return next_page_id;
+}
+
+page_id_t BufferPoolManagerInstance::FirstFreePageId(const std::string &db_file) const {
+  struct stat st;
+  if (stat(db_file.c_str(), &st) != 0) {
+    // not created yet
+    return static_cast<page_id_t>(instance_index_);
+  }
+  // a partial page at the end counts as a page
+  auto num_pages = static_cast<uint64_t>((st.st_size + PAGE_SIZE - 1) / PAGE_SIZE);
+  // the first id of this instance at or past the end of the file
+  num_pages += (instance_index_ + num_instances_ - num_pages % num_instances_) % num_instances_;
+  return static_cast<page_id_t>(num_pages);
+}
+
+void BufferPoolManagerInstance::ValidatePageId(const page_id_t page_id) const {
+  assert(page_id % num_instances_ == instance_index_);  // allocated pages mod back to this BPI
+}
+
+bool BufferPoolManagerInstance::TakeFrame(frame_id_t *frame_id, partition_id_t partition) {
+  BufferPoolPartitionMetrics &owner = partitions_[partition];
+  bool at_max = owner.frames_ >= owner.max_frames_;
+  // pages are always found from the free list first
+  if (!at_max && !free_list_.empty()) {
+    *frame_id = PopFreeFrame();
+  } else {
+    // if free _list is empty, get a victim page from the replacer; without partitions, any victim will do
+    Replacer::FrameFilter accept;
+    if (at_max) {
+      accept = [this, partition](frame_id_t frame) { return frame_partition_[frame] == partition; };
+    } else if (partitions_.size() > 1) {
+      accept = [this, partition](frame_id_t frame) {
+        const BufferPoolPartitionMetrics &victim = partitions_[frame_partition_[frame]];
+        return frame_partition_[frame] == partition || victim.frames_ > victim.min_frames_;
+      };
+    }
+    // victims whose page cannot be written back stay resident and go back to the replacer afterwards
+    std::vector<frame_id_t> unwritable;
+    bool found = false;
+    while (!found && replacer_->VictimIf(frame_id, accept)) {
+      if (pages_[*frame_id].page_id_ == INVALID_PAGE_ID) {
+        // an unpin that reached the replacer after the frame was freed; the frame is on the free list or retired
+        continue;
+      }
+      partition_id_t victim_partition = frame_partition_[*frame_id];
+      if (!EvictFrame(*frame_id)) {
+        unwritable.push_back(*frame_id);
+        continue;
+      }
+      partitions_[victim_partition].evictions_++;
+      if (victim_partition != partition) {
+        partitions_[victim_partition].evictions_by_others_++;
+      }
+      if (static_cast<size_t>(*frame_id) >= pool_size_) {
+        // left over from a shrink whose write-back failed: retire it now and keep looking
+        FreeFrame(*frame_id);
+        continue;
+      }
+      found = true;
+    }
+    for (frame_id_t unwritten : unwritable) {
+      replacer_->Unpin(unwritten);
+    }
+    if (!found) {
+      return false;
+    }
+  }
+  frame_partition_[*frame_id] = partition;
+  owner.frames_++;
+  return true;
+}
+
+bool BufferPoolManagerInstance::EvictFrame(frame_id_t frame_id) {
+  if (cleaner_writing_[frame_id]) {
+    // the cleaner's copy of the page is not on disk yet, so the frame cannot go; rather than wait for the whole batch
+    // with latch_ held, the caller picks another victim or comes back later
+    return false;
+  }
+  if (pages_[frame_id].IsDirty()) {
+    // the log has to reach this page's LSN first, which it usually has already; if not, it is forced with latch_
+    // released once the caller runs out of other victims, see ForceEvictionLog
+    if (!LogIsFlushed(pages_[frame_id].GetLSN())) {
+      evict_log_lsn_ = std::max(evict_log_lsn_, pages_[frame_id].GetLSN());
+      return false;
+    }
+    if (!disk_scheduler_->WritePage(pages_[frame_id].GetPageId(), pages_[frame_id].GetData())) {
+      // the frame holds the only up-to-date copy: it stays dirty and resident
+      metrics_.write_failures_++;
+      return false;
+    }
+    pages_[frame_id].is_dirty_ = false;
+    metrics_.evictions_dirty_++;
+  } else {
+    metrics_.evictions_clean_++;
+  }
+  // the page is clean now, so the compressed tier may hand it out again in place of the copy on disk; only a copy is
+  // made here, RunTierWork compresses it without latch_. The tiers are exclusive: only what the compressed tier
+  // turns away or drops goes on to the spill tier.
+  if (compressed_cache_ != nullptr) {
+    if (compressions_.size() == MAX_PENDING_COMPRESSIONS) {
+      PendingCompression &oldest = compressions_.front();
+      auto ticket = compress_tickets_.find(oldest.page_id_);
+      if (ticket != compress_tickets_.end() && ticket->second == oldest.ticket_) {
+        compress_tickets_.erase(ticket);
+        SpillPage(oldest.page_id_, oldest.data_.data());
+      }
+      compressions_.erase(compressions_.begin());
+    }
+    compress_tickets_[pages_[frame_id].GetPageId()] = ++next_compress_ticket_;
+    compressions_.push_back(
+        {pages_[frame_id].GetPageId(), next_compress_ticket_, std::string(pages_[frame_id].data_, PAGE_SIZE), {}});
+  } else {
+    SpillPage(pages_[frame_id].GetPageId(), pages_[frame_id].data_);
+  }
+  page_table_.Erase(pages_[frame_id].GetPageId());
+  partitions_[frame_partition_[frame_id]].frames_--;
+  // optimistic readers of the page that was here fail from now on
+  pages_[frame_id].BeginWrite();
+  pages_[frame_id].page_id_ = INVALID_PAGE_ID;
+  pages_[frame_id].EndWrite();
+  return true;
+}
+
+void BufferPoolManagerInstance::FreeFrame(frame_id_t frame_id) {
+  replacer_->Remove(frame_id);
+  // an evicted frame was uncharged by EvictFrame
+  if (pages_[frame_id].page_id_ != INVALID_PAGE_ID) {
+    partitions_[frame_partition_[frame_id]].frames_--;
+  }
+  pages_[frame_id].BeginWrite();
+  pages_[frame_id].page_id_ = INVALID_PAGE_ID;
+  pages_[frame_id].EndWrite();
+  pages_[frame_id].pin_count_ = 0;
+  pages_[frame_id].is_dirty_ = false;
+  if (static_cast<size_t>(frame_id) < pool_size_) {
+    PushFreeFrame(frame_id);
+  } else {
+    // the pool shrank while the frame was in use
+    arena_.Release(frame_id, frame_id + 1);
+  }
+}
+
+void BufferPoolManagerInstance::RetireFrame(frame_id_t frame_id) {
+  if (EvictFrame(frame_id)) {
+    FreeFrame(frame_id);
+  } else {
+    // TakeFrame retires it once its page can be written back
+    replacer_->Unpin(frame_id);
+  }
+}
+
+void BufferPoolManagerInstance::UnpinFrame(std::unique_lock<std::mutex> *latch, frame_id_t frame_id, bool is_dirty,
+                                           AccessType access_type) {
+  pages_[frame_id].pin_count_ -= 1;
+  if (!pages_[frame_id].IsDirty()) {
+    pages_[frame_id].is_dirty_ = is_dirty;
+  }
+  if (pages_[frame_id].pin_count_ == 0) {
+    if (static_cast<size_t>(frame_id) >= pool_size_) {
+      // the pool shrank while the page was pinned: the frame goes away now
+      RetireFrame(frame_id);
+    } else {
+      if (replacer_unlatched_) {
+        // the frame may be pinned, evicted or even freed again before this reaches the replacer, see TakeFrame
+        latch->unlock();
+      }
+      replacer_->Unpin(frame_id, access_type);
+    }
+  }
+}
+
+std::shared_future<bool> BufferPoolManagerInstance::StartRead(frame_id_t frame_id) {
+  auto promise = disk_scheduler_->CreatePromise();
+  io_reads_[frame_id] = promise.get_future().share();
+  io_in_progress_[frame_id] = true;
+  page_id_t page_id = pages_[frame_id].GetPageId();
+  std::string compressed;
+  if (compressed_cache_ != nullptr && compressed_cache_->Take(page_id, &compressed)) {
+    // decompressing is much cheaper than a read, so the caller's RunTierWork does it right away
+    decompressions_.push_back({frame_id, page_id, std::move(compressed), std::move(promise)});
+    metrics_.compressed_hits_++;
+    // the tiers only hold pages that are not in the pool, as the pool may change them
+    if (spill_cache_ != nullptr) {
+      spill_cache_->Erase(page_id);
+    }
+    return io_reads_[frame_id];
+  }
+  // a failed read of the cache file is not the end of it: the page is clean, so the database file has it too. The
+  // frame is pinned and its read in progress, so nobody touches its data until the fallback read completes.
+  char *data = pages_[frame_id].data_;
+  auto read_from_disk = [this, data, page_id](std::promise<bool> done) {
+    disk_scheduler_->Schedule({false, data, page_id, std::move(done), nullptr, {}, {}});
+  };
+  if (spill_cache_ != nullptr && spill_cache_->Read(page_id, data, &promise, read_from_disk)) {
+    metrics_.spill_hits_++;
+    return io_reads_[frame_id];
+  }
+  disk_scheduler_->Schedule({false, pages_[frame_id].data_, page_id, std::move(promise), nullptr, {}, {}});
+  return io_reads_[frame_id];
+}
+
+void BufferPoolManagerInstance::RunTierWork(std::unique_lock<std::mutex> *latch) {
+  if (compressions_.empty() && decompressions_.empty()) {
+    return;
+  }
+  std::vector<PendingCompression> compressions;
+  std::vector<PendingDecompression> decompressions;
+  compressions.swap(compressions_);
+  decompressions.swap(decompressions_);
+  latch->unlock();
+  for (auto &pending : decompressions) {
+    // the frame is pinned and its read in progress, so nobody else touches its data
+    char *data = pages_[pending.frame_id_].data_;
+    if (CompressedPageCache::Decompress(pending.compressed_, data)) {
+      pending.done_.set_value(true);
+    } else {
+      // the tier only holds clean pages, so the copy on disk will do
+      disk_scheduler_->Schedule({false, data, pending.page_id_, std::move(pending.done_), nullptr, {}, {}});
+    }
+  }
+  for (auto &pending : compressions) {
+    pending.compressed_ = CompressedPageCache::Compress(pending.data_.data());
+  }
+  latch->lock();
+  std::vector<CompressedPageCache::DroppedPage> dropped;
+  for (auto &pending : compressions) {
+    auto ticket = compress_tickets_.find(pending.page_id_);
+    if (ticket == compress_tickets_.end() || ticket->second != pending.ticket_) {
+      // deleted, or evicted again and queued again meanwhile
+      continue;
+    }
+    compress_tickets_.erase(ticket);
+    // the tiers only hold pages that are not in the pool, as the pool may change them
+    frame_id_t frame_id;
+    if (page_table_.Find(pending.page_id_, &frame_id)) {
+      continue;
+    }
+    if (compressed_cache_->Insert(pending.page_id_, std::move(pending.compressed_), &dropped)) {
+      metrics_.compressed_inserts_++;
+    } else {
+      // it does not compress well enough to be kept
+      SpillPage(pending.page_id_, pending.data_.data());
+    }
+  }
+  if (spill_cache_ != nullptr && !dropped.empty()) {
+    // the pages the compressed tier made room by dropping go on to the spill tier; decompressing them is about as
+    // cheap as the copy SpillCache::Insert makes, so it is done right here, before anyone can fetch them again
+    std::string data(PAGE_SIZE, '\0');
+    for (auto &[page_id, compressed] : dropped) {
+      if (CompressedPageCache::Decompress(compressed, data.data())) {
+        SpillPage(page_id, data.data());
+      }
+    }
+  }
+}
+
+void BufferPoolManagerInstance::SpillPage(page_id_t page_id, const char *data) {
+  if (spill_cache_ != nullptr && spill_cache_->Insert(page_id, data)) {
+    metrics_.spill_writes_++;
+  }
+}
+
+void BufferPoolManagerInstance::FinishRead(frame_id_t frame_id) {
+  // whoever gets latch_ first after the read completes finishes it; everyone else finds nothing to do
+  if (!io_in_progress_[frame_id] ||
+      io_reads_[frame_id].wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+    return;
+  }
+  bool read_ok = io_reads_[frame_id].get();
+  io_in_progress_[frame_id] = false;
+  io_reads_[frame_id] = {};
+  // the page's data is in: optimistic readers may read it from here
+  pages_[frame_id].EndWrite();
+  if (!read_ok) {
+    // no one may find the page any more; its frame goes back to the free list with the reader's pin
+    page_table_.Erase(pages_[frame_id].GetPageId());
+  }
+  if (io_prefetch_[frame_id]) {
+    // the prefetch only pinned the frame for the duration of the read
+    io_prefetch_[frame_id] = false;
+    if (!read_ok) {
+      FreeFrame(frame_id);
+    } else if (--pages_[frame_id].pin_count_ == 0) {
+      if (static_cast<size_t>(frame_id) >= pool_size_) {
+        // the pool shrank during the read
+        RetireFrame(frame_id);
+      } else {
+        // unpinned as a normal access whatever the hint, or a SCAN prefetch would be the next victim before it is used
+        replacer_->Unpin(frame_id);
+      }
+    }
+  }
+}
+
+bool BufferPoolManagerInstance::StartPrefetch(page_id_t page_id, AccessType access_type, partition_id_t partition) {
+  frame_id_t frame_id;
+  if (page_table_.Find(page_id, &frame_id)) {
+    return !io_in_progress_[frame_id];
+  }
+  if (!TakePrefetchFrame(page_id, access_type, partition, &frame_id)) {
+    return false;
+  }
+  StartRead(frame_id);
+  metrics_.prefetches_++;
+  return false;
+}
+
+bool BufferPoolManagerInstance::TakePrefetchFrame(page_id_t page_id, AccessType access_type, partition_id_t partition,
+                                                  frame_id_t *frame_id) {
+  if (!TakeFrame(frame_id, partition)) {
+    return false;
+  }
+  page_table_.Insert(page_id, *frame_id);
+  // as in FetchPageImpl, optimistic readers fail on the frame until FinishRead
+  pages_[*frame_id].BeginWrite();
+  pages_[*frame_id].page_id_ = page_id;
+  pages_[*frame_id].pin_count_ = 1;
+  pages_[*frame_id].is_dirty_ = false;
+  replacer_->RecordAccess(*frame_id, page_id, access_type);
+  replacer_->Pin(*frame_id);
+  io_prefetch_[*frame_id] = true;
+  prefetching_.push_back(*frame_id);
+  return true;
+}
+
+void BufferPoolManagerInstance::ReapPrefetches() {
+  prefetching_.erase(std::remove_if(prefetching_.begin(), prefetching_.end(),
+                                    [this](frame_id_t frame_id) {
+                                      FinishRead(frame_id);
+                                      return !io_in_progress_[frame_id] || !io_prefetch_[frame_id];
+                                    }),
+                     prefetching_.end());
+}
+
+bool BufferPoolManagerInstance::WaitForPrefetch(std::unique_lock<std::mutex> *latch) {
+  ReapPrefetches();
+  if (prefetching_.empty()) {
+    return false;
+  }
+  std::shared_future<bool> read = io_reads_[prefetching_.front()];
+  latch->unlock();
+  read.wait();
+  latch->lock();
+  ReapPrefetches();
+  return true;
+}
+
+bool BufferPoolManagerInstance::WaitForCleaner(std::unique_lock<std::mutex> *latch, frame_id_t frame_id) {
+  if (!cleaner_writing_[frame_id]) {
+    return false;
+  }
+  // the batch is settled by its writer, or by the next batch, under latch_, which they cannot get while we hold it
+  cleaner_settled_cv_.wait(*latch, [this, frame_id] { return !cleaner_writing_[frame_id]; });
+  return true;
+}
+
+bool BufferPoolManagerInstance::WaitForCleanerBatch(std::unique_lock<std::mutex> *latch) {
+  if (cleaner_unsettled_ == 0) {
+    return false;
+  }
+  uint64_t settles = cleaner_settles_;
+  cleaner_settled_cv_.wait(*latch, [this, settles] { return cleaner_settles_ != settles; });
+  return true;
+}
+
+void BufferPoolManagerInstance::FinishCleanerWrites() {
+  size_t settled = 0;
+  for (size_t i = 0; i < cleaner_writes_.size(); i++) {
+    frame_id_t frame_id = cleaner_writes_[i].first;
+    if (!cleaner_writing_[frame_id]) {
+      continue;
+    }
+    cleaner_writing_[frame_id] = false;
+    settled++;
+    if (!cleaner_write_ok_[i]) {
+      // the frame still holds the only up-to-date copy; it may have been dirtied again meanwhile, which is the same
+      pages_[frame_id].is_dirty_ = true;
+      metrics_.write_failures_++;
+    }
+  }
+  if (settled > 0) {
+    cleaner_unsettled_ -= settled;
+    cleaner_settles_++;
+    cleaner_settled_cv_.notify_all();
+  }
+}
+
+bool BufferPoolManagerInstance::ForceLog(lsn_t lsn) {
+  return log_manager_ != nullptr && log_manager_->Flush(lsn);
+}
+
+bool BufferPoolManagerInstance::LogIsFlushed(lsn_t lsn) {
+  // as in LogManager::Flush, an LSN past the last record appended stands for the last record appended
+  return log_manager_ == nullptr || std::min(lsn, log_manager_->GetNextLSN() - 1) <= log_manager_->GetPersistentLSN();
+}
+
+bool BufferPoolManagerInstance::ForceLog(std::unique_lock<std::mutex> *latch, lsn_t lsn) {
+  if (LogIsFlushed(lsn)) {
+    return false;
+  }
+  latch->unlock();
+  bool forced = ForceLog(lsn);
+  latch->lock();
+  if (forced) {
+    metrics_.log_forces_++;
+  }
+  return true;
+}
+
+bool BufferPoolManagerInstance::ForceEvictionLog(std::unique_lock<std::mutex> *latch) {
+  lsn_t lsn = evict_log_lsn_;
+  evict_log_lsn_ = INVALID_LSN;
+  return lsn != INVALID_LSN && ForceLog(latch, lsn);
+}
+
+void BufferPoolManagerInstance::CleanerLoop() {
+  std::unique_lock latch{latch_};
+  auto interval = std::chrono::milliseconds(options_.cleaner_interval_ms_);
+  while (!cleaner_stop_) {
+    cleaner_cv_.wait_for(latch, interval, [this] { return cleaner_stop_; });
+    if (!cleaner_stop_) {
+      CleanRound(&latch);
+    }
+  }
+}
+
+size_t BufferPoolManagerInstance::CleanRound(std::unique_lock<std::mutex> *latch) {
+  // 1.   Look at the frames next in line for eviction. The free frames, then the run of clean candidates up to the
+  //      first dirty one, can be handed out without a write; if there are enough of them, there is nothing to do.
+  replacer_->PeekVictims(cleaner_high_frames_, &cleaner_candidates_);
+  size_t ready = free_list_.size();
+  for (frame_id_t frame_id : cleaner_candidates_) {
+    if (pages_[frame_id].IsDirty()) {
+      break;
+    }
+    ready++;
+  }
+  if (ready >= cleaner_low_frames_) {
+    return 0;
+  }
+
+  // 2.   Write back the dirty candidates, coldest first, with latch_ released.
+  size_t written = WriteBackFrames(latch, cleaner_candidates_);
+  metrics_.cleaner_writes_ += written;
+  return written;
+}
+
+size_t BufferPoolManagerInstance::WriteBackFrames(std::unique_lock<std::mutex> *latch,
+                                                 const std::vector<frame_id_t> &frames) {
+  // 1.   The previous batch is on disk once we hold the I/O latch, but the thread that wrote it may not have latch_
+  //      back yet to settle it, and its scratch space is about to be reused. If the cleaner and a shrink meet here, the
+  //      one waiting lets go of latch_ first; the frames are checked again below.
+  if (!cleaner_io_latch_.try_lock()) {
+    latch->unlock();
+    cleaner_io_latch_.lock();
+    latch->lock();
+  }
+  FinishCleanerWrites();
+  cleaner_writes_.clear();
+  uint64_t batch = ++cleaner_batch_;
+
+  // 2.   Copy the dirty frames and mark them clean. Nobody can pin one of them and change it while we hold latch_, so
+  //      each copy is consistent. A page dirtied again after this simply gets written again later; one whose write
+  //      fails is marked dirty again by FinishCleanerWrites.
+  //      Until the batch is settled, the frames cannot be evicted or written by anyone else, see WaitForCleaner.
+  lsn_t max_lsn = INVALID_LSN;
+  size_t capacity = std::max<size_t>(options_.cleaner_max_writes_, 1);
+  for (frame_id_t frame_id : frames) {
+    if (cleaner_writes_.size() == capacity) {
+      break;
+    }
+    Page &page = pages_[frame_id];
+    if (!page.is_dirty_ || page.pin_count_ > 0) {
+      continue;
+    }
+    cleaner_writing_[frame_id] = true;
+    cleaner_unsettled_++;
+    memcpy(cleaner_buffer_.GetFrame(static_cast<frame_id_t>(cleaner_writes_.size())), page.data_, PAGE_SIZE);
+    page.is_dirty_ = false;
+    cleaner_writes_.emplace_back(frame_id, page.page_id_);
+    max_lsn = std::max(max_lsn, page.GetLSN());
+  }
+  if (cleaner_writes_.empty()) {
+    cleaner_io_latch_.unlock();
+    return 0;
+  }
+
+  // 3.   Write the copies without holding latch_, all at once, and wait for the whole batch. The log goes first, so
+  //      the write-back also takes forcing the log off the path of the fetches that evict these pages.
+  latch->unlock();
+  bool forced = ForceLog(max_lsn);
+  std::vector<std::future<bool>> done;
+  done.reserve(cleaner_writes_.size());
+  for (size_t i = 0; i < cleaner_writes_.size(); i++) {
+    auto promise = disk_scheduler_->CreatePromise();
+    done.push_back(promise.get_future());
+    disk_scheduler_->Schedule(
+        {true, cleaner_buffer_.GetFrame(static_cast<frame_id_t>(i)), cleaner_writes_[i].second, std::move(promise),
+         nullptr, {}, {}});
+  }
+  cleaner_write_ok_.clear();
+  for (auto &write : done) {
+    cleaner_write_ok_.push_back(write.get());
+  }
+  size_t written = std::count(cleaner_write_ok_.begin(), cleaner_write_ok_.end(), true);
+  cleaner_io_latch_.unlock();
+  latch->lock();
+  // unless the next batch got to it first
+  if (cleaner_batch_ == batch) {
+    FinishCleanerWrites();
+  }
+  if (forced) {
+    metrics_.log_forces_++;
+  }
+  return written;
+}
+
+std::string BufferPoolManagerInstance::InstanceFile(const std::string &file) const {
+  if (num_instances_ == 1) {
+    return file;
+  }
+  std::string instance_file = file;
+  size_t dot = instance_file.rfind('.');
+  if (dot == std::string::npos || instance_file.find('/', dot) != std::string::npos) {
+    dot = instance_file.size();
+  }
+  instance_file.insert(dot, "." + std::to_string(instance_index_));
+  return instance_file;
+}
+
+size_t BufferPoolManagerInstance::SaveWarmSet() {
+  if (warm_file_.empty()) {
+    return 0;
+  }
+  std::vector<page_id_t> page_ids;
+  {
+    std::scoped_lock latch{latch_};
+    // the replacer lists its frames coldest first; the frames it does not list are pinned, the hottest of all
+    std::vector<frame_id_t> ranked;
+    replacer_->PeekVictims(max_pool_size_, &ranked);
+    std::vector<bool> in_replacer(max_pool_size_, false);
+    for (frame_id_t frame_id : ranked) {
+      in_replacer[frame_id] = true;
+    }
+    for (size_t i = 0; i < max_pool_size_; i++) {
+      if (pages_[i].page_id_ != INVALID_PAGE_ID && !in_replacer[i]) {
+        page_ids.push_back(pages_[i].page_id_);
+      }
+    }
+    for (auto it = ranked.rbegin(); it != ranked.rend(); ++it) {
+      if (pages_[*it].page_id_ != INVALID_PAGE_ID) {
+        page_ids.push_back(pages_[*it].page_id_);
+      }
+    }
+  }
+
+  std::scoped_lock file_latch{warm_file_latch_};
+  std::string tmp_file = warm_file_ + ".tmp";
+  std::ofstream out(tmp_file, std::ios::binary | std::ios::trunc);
+  uint64_t count = page_ids.size();
+  out.write(reinterpret_cast<const char *>(&WARM_FILE_MAGIC), sizeof(WARM_FILE_MAGIC));
+  out.write(reinterpret_cast<const char *>(&count), sizeof(count));
+  out.write(reinterpret_cast<const char *>(page_ids.data()), static_cast<std::streamsize>(count * sizeof(page_id_t)));
+  out.close();
+  if (!out || std::rename(tmp_file.c_str(), warm_file_.c_str()) != 0) {
+    LOG_WARN("BufferPoolManagerInstance: cannot save the resident pages to %s", warm_file_.c_str());
+    std::remove(tmp_file.c_str());
+    return 0;
+  }
+  return page_ids.size();
+}
+
+void BufferPoolManagerInstance::LoadWarmSet() {
+  std::ifstream in(warm_file_, std::ios::binary | std::ios::ate);
+  if (!in) {
+    // nothing saved yet
+    return;
+  }
+  auto size = static_cast<uint64_t>(in.tellg());
+  in.seekg(0);
+  uint32_t magic = 0;
+  uint64_t count = 0;
+  in.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+  in.read(reinterpret_cast<char *>(&count), sizeof(count));
+  if (!in || magic != WARM_FILE_MAGIC || count > size ||
+      size != sizeof(magic) + sizeof(count) + count * sizeof(page_id_t)) {
+    LOG_WARN("BufferPoolManagerInstance: %s is not a warm restart file, starting cold", warm_file_.c_str());
+    return;
+  }
+  std::vector<page_id_t> saved(count);
+  in.read(reinterpret_cast<char *>(saved.data()), static_cast<std::streamsize>(count * sizeof(page_id_t)));
+  if (!in) {
+    LOG_WARN("BufferPoolManagerInstance: cannot read %s, starting cold", warm_file_.c_str());
+    return;
+  }
+
+  // 1.   Keep the hottest pages that fit, skipping those of other instances in case the pool was split differently
+  //      when the file was saved, and sort them, so the reads sweep the database file from start to end.
+  std::vector<page_id_t> page_ids;
+  for (page_id_t page_id : saved) {
+    if (page_ids.size() == pool_size_) {
+      break;
+    }
+    if (page_id >= 0 && static_cast<uint32_t>(page_id) % num_instances_ == instance_index_) {
+      page_ids.push_back(page_id);
+    }
+  }
+  std::sort(page_ids.begin(), page_ids.end());
+  page_ids.erase(std::unique(page_ids.begin(), page_ids.end()), page_ids.end());
+
+  // 2.   Give each run of consecutive page ids its frames and one vectored read, which all of the run's frames wait
+  //      on. The compressed and spill tiers start out empty, so everything comes from the database file. The reads
+  //      are only scheduled here: they complete in the background, as prefetches.
+  std::scoped_lock latch{latch_};
+  size_t max_run = std::max<size_t>(options_.warm_max_run_pages_, 1);
+  std::vector<frame_id_t> run;
+  for (size_t begin = 0; begin < page_ids.size(); begin += run.size()) {
+    run.clear();
+    frame_id_t frame_id;
+    while (begin + run.size() < page_ids.size() && run.size() < max_run &&
+           (run.empty() || page_ids[begin + run.size()] == page_ids[begin + run.size() - 1] + 1) &&
+           TakePrefetchFrame(page_ids[begin + run.size()], AccessType::NORMAL, DEFAULT_PARTITION, &frame_id)) {
+      run.push_back(frame_id);
+    }
+    if (run.empty()) {
+      // out of frames
+      break;
+    }
+    DiskRequest r{false, pages_[run[0]].data_, page_ids[begin], disk_scheduler_->CreatePromise(), nullptr, {}, {}};
+    std::shared_future<bool> read = r.callback_.get_future().share();
+    for (frame_id_t frame : run) {
+      io_reads_[frame] = read;
+      io_in_progress_[frame] = true;
+      if (run.size() > 1) {
+        r.iov_.push_back(pages_[frame].data_);
+      }
+    }
+    disk_scheduler_->Schedule(std::move(r));
+    metrics_.warm_loads_ += run.size();
+  }
+}
+
+void BufferPoolManagerInstance::WarmSaverLoop() {
+  std::unique_lock latch{latch_};
+  auto interval = std::chrono::milliseconds(options_.warm_save_interval_ms_);
+  while (!warm_saver_stop_) {
+    warm_saver_cv_.wait_for(latch, interval, [this] { return warm_saver_stop_; });
+    if (!warm_saver_stop_) {
+      latch.unlock();
+      SaveWarmSet();
+      latch.lock();
+    }
+  }
+}
+
+}  // namespace bustub
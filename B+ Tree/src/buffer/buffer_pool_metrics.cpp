@@ -0,0 +1,135 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_metrics.cpp
+//
+// Identification: src/buffer/buffer_pool_metrics.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_metrics.h"
+
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+namespace bustub {
+
+namespace {
+/** The counters by name, in the order they are printed. */
+std::vector<std::pair<const char *, uint64_t>> Counters(const BufferPoolMetrics &metrics) {
+  return {{"fetch_hits", metrics.fetch_hits_},
+          {"fetch_misses", metrics.fetch_misses_},
+          {"fetch_failures", metrics.fetch_failures_},
+          {"new_pages", metrics.new_pages_},
+          {"new_page_failures", metrics.new_page_failures_},
+          {"evictions_clean", metrics.evictions_clean_},
+          {"evictions_dirty", metrics.evictions_dirty_},
+          {"flushes", metrics.flushes_},
+          {"write_failures", metrics.write_failures_},
+          {"cleaner_writes", metrics.cleaner_writes_},
+          {"resize_writes", metrics.resize_writes_},
+          {"deletes", metrics.deletes_},
+          {"prefetches", metrics.prefetches_},
+          {"compressed_inserts", metrics.compressed_inserts_},
+          {"compressed_hits", metrics.compressed_hits_},
+          {"spill_writes", metrics.spill_writes_},
+          {"spill_hits", metrics.spill_hits_},
+          {"log_forces", metrics.log_forces_},
+          {"warm_loads", metrics.warm_loads_}};
+}
+}  // namespace
+
+BufferPoolMetrics &BufferPoolMetrics::operator+=(const BufferPoolMetrics &other) {
+  fetch_hits_ += other.fetch_hits_;
+  fetch_misses_ += other.fetch_misses_;
+  fetch_failures_ += other.fetch_failures_;
+  new_pages_ += other.new_pages_;
+  new_page_failures_ += other.new_page_failures_;
+  evictions_clean_ += other.evictions_clean_;
+  evictions_dirty_ += other.evictions_dirty_;
+  flushes_ += other.flushes_;
+  write_failures_ += other.write_failures_;
+  cleaner_writes_ += other.cleaner_writes_;
+  resize_writes_ += other.resize_writes_;
+  deletes_ += other.deletes_;
+  prefetches_ += other.prefetches_;
+  compressed_inserts_ += other.compressed_inserts_;
+  compressed_hits_ += other.compressed_hits_;
+  spill_writes_ += other.spill_writes_;
+  spill_hits_ += other.spill_hits_;
+  log_forces_ += other.log_forces_;
+  warm_loads_ += other.warm_loads_;
+  read_latency_.Merge(other.read_latency_);
+  write_latency_.Merge(other.write_latency_);
+  spill_read_latency_.Merge(other.spill_read_latency_);
+  return *this;
+}
+
+double BufferPoolMetrics::HitRatio() const {
+  uint64_t fetches = fetch_hits_ + fetch_misses_;
+  return fetches == 0 ? 0 : static_cast<double>(fetch_hits_) / static_cast<double>(fetches);
+}
+
+std::string BufferPoolMetrics::ToString() const {
+  std::string text;
+  for (const auto &[name, value] : Counters(*this)) {
+    text += std::string(name) + " " + std::to_string(value) + "\n";
+  }
+  char hit_ratio[32];
+  snprintf(hit_ratio, sizeof(hit_ratio), "%.4f", HitRatio());
+  text += std::string("hit_ratio ") + hit_ratio + "\n";
+  text += "read_latency " + read_latency_.ToString() + "\n";
+  text += "write_latency " + write_latency_.ToString() + "\n";
+  text += "spill_read_latency " + spill_read_latency_.ToString() + "\n";
+  return text;
+}
+
+std::string BufferPoolMetrics::ToJson() const {
+  std::string json = "{";
+  for (const auto &[name, value] : Counters(*this)) {
+    json += "\"" + std::string(name) + "\":" + std::to_string(value) + ",";
+  }
+  char hit_ratio[32];
+  snprintf(hit_ratio, sizeof(hit_ratio), "%.4f", HitRatio());
+  json += std::string("\"hit_ratio\":") + hit_ratio + ",";
+  json += "\"read_latency\":" + read_latency_.ToJson() + ",";
+  json += "\"write_latency\":" + write_latency_.ToJson() + ",";
+  json += "\"spill_read_latency\":" + spill_read_latency_.ToJson() + "}";
+  return json;
+}
+
+BufferPoolPartitionMetrics &BufferPoolPartitionMetrics::operator+=(const BufferPoolPartitionMetrics &other) {
+  min_frames_ += other.min_frames_;
+  max_frames_ += other.max_frames_;
+  frames_ += other.frames_;
+  fetch_hits_ += other.fetch_hits_;
+  fetch_misses_ += other.fetch_misses_;
+  new_pages_ += other.new_pages_;
+  failures_ += other.failures_;
+  evictions_ += other.evictions_;
+  evictions_by_others_ += other.evictions_by_others_;
+  return *this;
+}
+
+std::string BufferPoolPartitionMetrics::ToString() const {
+  std::vector<std::pair<const char *, uint64_t>> counters = {{"frames", frames_},
+                                                             {"min_frames", min_frames_},
+                                                             {"max_frames", max_frames_},
+                                                             {"fetch_hits", fetch_hits_},
+                                                             {"fetch_misses", fetch_misses_},
+                                                             {"new_pages", new_pages_},
+                                                             {"failures", failures_},
+                                                             {"evictions", evictions_},
+                                                             {"evictions_by_others", evictions_by_others_}};
+  std::string text = name_;
+  for (const auto &[name, value] : counters) {
+    text += " " + std::string(name) + " " + std::to_string(value);
+  }
+  return text;
+}
+
+}  // namespace bustub
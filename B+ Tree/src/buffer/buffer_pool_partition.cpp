@@ -0,0 +1,79 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_partition.cpp
+//
+// Identification: src/buffer/buffer_pool_partition.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_partition.h"
+
+namespace bustub {
+
+Page *BufferPoolPartition::FetchPageImpl(page_id_t page_id, AccessType access_type, partition_id_t partition) {
+  return pool_->FetchPageImpl(page_id, access_type, partition_id_);
+}
+
+bool BufferPoolPartition::UnpinPageImpl(page_id_t page_id, bool is_dirty, AccessType access_type) {
+  return pool_->UnpinPageImpl(page_id, is_dirty, access_type);
+}
+
+bool BufferPoolPartition::FlushPageImpl(page_id_t page_id) { return pool_->FlushPageImpl(page_id); }
+
+Page *BufferPoolPartition::NewPageImpl(page_id_t *page_id, partition_id_t partition) {
+  return pool_->NewPageImpl(page_id, partition_id_);
+}
+
+bool BufferPoolPartition::DeletePageImpl(page_id_t page_id) { return pool_->DeletePageImpl(page_id); }
+
+void BufferPoolPartition::FlushAllPagesImpl(FlushStats *stats) { pool_->FlushAllPagesImpl(stats); }
+
+bool BufferPoolPartition::PrefetchPageImpl(page_id_t page_id, AccessType access_type, partition_id_t partition) {
+  return pool_->PrefetchPageImpl(page_id, access_type, partition_id_);
+}
+
+void BufferPoolPartition::PrefetchPagesImpl(const std::vector<page_id_t> &page_ids, AccessType access_type,
+                                            partition_id_t partition) {
+  pool_->PrefetchPagesImpl(page_ids, access_type, partition_id_);
+}
+
+bool BufferPoolPartition::ResizeImpl(size_t pool_size) { return pool_->ResizeImpl(pool_size); }
+
+PageHandle BufferPoolPartition::FetchPageHandleImpl(page_id_t page_id, AccessType access_type,
+                                                    partition_id_t partition) {
+  return pool_->FetchPageHandleImpl(page_id, access_type, partition_id_);
+}
+
+PageHandle BufferPoolPartition::NewPageHandleImpl(page_id_t *page_id, partition_id_t partition) {
+  return pool_->NewPageHandleImpl(page_id, partition_id_);
+}
+
+void BufferPoolPartition::UnpinFrameImpl(frame_id_t frame_id, page_id_t page_id, bool is_dirty,
+                                         AccessType access_type) {
+  pool_->UnpinFrameImpl(frame_id, page_id, is_dirty, access_type);
+}
+
+void BufferPoolPartition::PinFrameImpl(frame_id_t frame_id, page_id_t page_id, AccessType access_type) {
+  pool_->PinFrameImpl(frame_id, page_id, access_type);
+}
+
+Page *BufferPoolPartition::PeekPageImpl(page_id_t page_id, uint64_t *version) {
+  return pool_->PeekPageImpl(page_id, version);
+}
+
+BufferPoolMetrics BufferPoolPartition::GetMetricsImpl() { return pool_->GetMetricsImpl(); }
+
+BufferPoolManager *BufferPoolPartition::CreatePartitionImpl(const std::string &name, size_t min_frames,
+                                                            size_t max_frames) {
+  return pool_->CreatePartitionImpl(name, min_frames, max_frames);
+}
+
+std::vector<BufferPoolPartitionMetrics> BufferPoolPartition::GetPartitionMetricsImpl() {
+  return pool_->GetPartitionMetricsImpl();
+}
+
+}  // namespace bustub
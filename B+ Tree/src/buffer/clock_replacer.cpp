@@ -0,0 +1,156 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// clock_replacer.cpp
+//
+// Identification: src/buffer/clock_replacer.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/clock_replacer.h"
+
+namespace bustub {
+
+ClockReplacer::ClockReplacer(size_t num_pages)
+    : frames_(num_pages, 0),
+      frame_page_(num_pages, INVALID_PAGE_ID),
+      cold_ring_(num_pages),
+      cold_head_(0),
+      cold_count_(0),
+      hand_(0),
+      size_(0),
+      num_pages_(num_pages) {}
+
+ClockReplacer::~ClockReplacer() = default;
+
+// Sweep the hand around the clock: a frame with its ref bit set gets a second chance (the bit is cleared),
+// the first frame found without it is the victim. Two full turns are always enough.
+// Frames accept rejects are passed over untouched, by the hand and in the cold ring alike.
+bool ClockReplacer::VictimIf(frame_id_t *frame_id, const FrameFilter &accept) {
+  if (size_ == 0) {
+    return false;
+  }
+  // cold frames first; entries whose frame was pinned or re-unpinned normally since are dropped from the head, and
+  // a frame taken from behind a rejected one leaves its entry behind, stale, as Pin does
+  auto pop_head = [this](uint8_t *state) {
+    cold_head_ = (cold_head_ + 1) % num_pages_;
+    cold_count_--;
+    *state &= ~QUEUED_BIT;
+  };
+  for (size_t i = 0; i < cold_count_;) {
+    frame_id_t cold = cold_ring_[(cold_head_ + i) % num_pages_];
+    uint8_t &state = frames_[cold];
+    bool live = (state & (IN_CLOCK | COLD_BIT)) == (IN_CLOCK | COLD_BIT);
+    if (!live || (accept && !accept(cold))) {
+      if (!live && i == 0) {
+        pop_head(&state);
+      } else {
+        i++;
+      }
+      continue;
+    }
+    if (i == 0) {
+      pop_head(&state);
+    }
+    state &= QUEUED_BIT;
+    size_--;
+    *frame_id = cold;
+    return true;
+  }
+  for (size_t step = 0; step < 2 * num_pages_; step++) {
+    uint8_t &state = frames_[hand_];
+    size_t current = hand_;
+    hand_ = (hand_ + 1) % num_pages_;
+    if ((state & IN_CLOCK) == 0 || (accept && !accept(static_cast<frame_id_t>(current)))) {
+      continue;
+    }
+    if ((state & REF_BIT) != 0) {
+      state &= ~REF_BIT;
+      continue;
+    }
+    state &= QUEUED_BIT;
+    size_--;
+    *frame_id = static_cast<frame_id_t>(current);
+    return true;
+  }
+  return false;
+}
+
+// A pinned frame simply drops out of the clock (a cold ring entry, if any, goes stale)
+void ClockReplacer::Pin(frame_id_t frame_id) {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_pages_ || (frames_[frame_id] & IN_CLOCK) == 0) {
+    return;
+  }
+  frames_[frame_id] &= QUEUED_BIT | HOT_BIT;
+  size_--;
+}
+
+// An unpinned frame enters the clock with its ref bit set, so it survives the next pass of the hand.
+// SCAN / ONCE frames get no second chance: they are queued on the cold ring, SCAN frames at its tail and ONCE frames
+// at its head, so the ONCE ones go first. Hot frames ignore the hint, a scan passing over them does not make them cold.
+void ClockReplacer::Unpin(frame_id_t frame_id, AccessType access_type) {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_pages_ || (frames_[frame_id] & IN_CLOCK) != 0) {
+    return;
+  }
+  uint8_t &state = frames_[frame_id];
+  size_++;
+  if (access_type == AccessType::NORMAL || (state & HOT_BIT) != 0) {
+    state = (state & (QUEUED_BIT | HOT_BIT)) | IN_CLOCK | REF_BIT;
+    return;
+  }
+  state |= IN_CLOCK | COLD_BIT;
+  if ((state & QUEUED_BIT) == 0) {
+    state |= QUEUED_BIT;
+    if (access_type == AccessType::ONCE) {
+      cold_head_ = (cold_head_ + num_pages_ - 1) % num_pages_;
+      cold_ring_[cold_head_] = frame_id;
+    } else {
+      cold_ring_[(cold_head_ + cold_count_) % num_pages_] = frame_id;
+    }
+    cold_count_++;
+  }
+}
+
+size_t ClockReplacer::Size() { return size_; }
+
+// A page new to the frame starts out cold; its first normal access makes it hot
+void ClockReplacer::RecordAccess(frame_id_t frame_id, page_id_t page_id, AccessType access_type) {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_pages_) {
+    return;
+  }
+  if (frame_page_[frame_id] != page_id) {
+    frame_page_[frame_id] = page_id;
+    frames_[frame_id] &= ~HOT_BIT;
+  }
+  if (access_type == AccessType::NORMAL) {
+    frames_[frame_id] |= HOT_BIT;
+  }
+}
+
+// The order Victim would go in: live cold ring entries, then frames the hand takes on its first turn (no ref bit),
+// then the ones it takes on its second turn (ref bit set, cleared on the first)
+void ClockReplacer::PeekVictims(size_t max_frames, std::vector<frame_id_t> *frame_ids) {
+  frame_ids->clear();
+  for (size_t i = 0; i < cold_count_ && frame_ids->size() < max_frames; i++) {
+    frame_id_t cold = cold_ring_[(cold_head_ + i) % num_pages_];
+    if ((frames_[cold] & (IN_CLOCK | COLD_BIT)) == (IN_CLOCK | COLD_BIT)) {
+      frame_ids->push_back(cold);
+    }
+  }
+  for (int turn = 0; turn < 2; turn++) {
+    for (size_t step = 0; step < num_pages_ && frame_ids->size() < max_frames; step++) {
+      size_t current = (hand_ + step) % num_pages_;
+      uint8_t state = frames_[current];
+      // cold frames were listed with the ring
+      if ((state & IN_CLOCK) == 0 || (state & COLD_BIT) != 0 || ((state & REF_BIT) != 0) == (turn == 0)) {
+        continue;
+      }
+      frame_ids->push_back(static_cast<frame_id_t>(current));
+    }
+  }
+}
+
+}  // namespace bustub
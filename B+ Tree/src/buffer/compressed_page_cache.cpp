@@ -0,0 +1,180 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache.cpp
+//
+// Identification: src/buffer/compressed_page_cache.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/compressed_page_cache.h"
+
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <utility>
+
+namespace bustub {
+
+namespace {
+/** Shortest back-reference worth encoding. */
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t HASH_BITS = 12;
+
+uint32_t Load32(const char *p) {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+uint32_t Hash(uint32_t sequence) { return (sequence * 2654435761U) >> (32 - HASH_BITS); }
+
+void PutVarint(std::string *out, size_t value) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>(value | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+bool GetVarint(const std::string &in, size_t *pos, size_t *value) {
+  *value = 0;
+  for (size_t shift = 0; shift < 28; shift += 7) {
+    if (*pos >= in.size()) {
+      return false;
+    }
+    auto byte = static_cast<uint8_t>(in[(*pos)++]);
+    *value |= static_cast<size_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace
+
+CompressedPageCache::CompressedPageCache(size_t capacity) : capacity_(capacity) {}
+
+bool CompressedPageCache::Insert(page_id_t page_id, const char *data) { return Insert(page_id, Compress(data)); }
+
+bool CompressedPageCache::Insert(page_id_t page_id, std::string compressed, std::vector<DroppedPage> *dropped) {
+  Erase(page_id);
+  if (compressed.size() > MAX_COMPRESSED_SIZE || compressed.size() > capacity_) {
+    return false;
+  }
+  Shrink(capacity_ - compressed.size(), dropped);
+  bytes_ += compressed.size();
+  entries_.push_back({page_id, std::move(compressed)});
+  index_[page_id] = std::prev(entries_.end());
+  return true;
+}
+
+bool CompressedPageCache::Take(page_id_t page_id, char *data) {
+  std::string compressed;
+  return Take(page_id, &compressed) && Decompress(compressed, data);
+}
+
+bool CompressedPageCache::Take(page_id_t page_id, std::string *compressed) {
+  auto it = index_.find(page_id);
+  if (it == index_.end()) {
+    return false;
+  }
+  *compressed = std::move(it->second->compressed_);
+  // the moved-from string no longer says how many bytes it took
+  bytes_ -= compressed->size();
+  entries_.erase(it->second);
+  index_.erase(it);
+  return true;
+}
+
+void CompressedPageCache::Erase(page_id_t page_id) {
+  auto it = index_.find(page_id);
+  if (it == index_.end()) {
+    return;
+  }
+  bytes_ -= it->second->compressed_.size();
+  entries_.erase(it->second);
+  index_.erase(it);
+}
+
+void CompressedPageCache::Shrink(size_t target, std::vector<DroppedPage> *dropped) {
+  while (bytes_ > target) {
+    Entry &oldest = entries_.front();
+    bytes_ -= oldest.compressed_.size();
+    index_.erase(oldest.page_id_);
+    if (dropped != nullptr) {
+      dropped->emplace_back(oldest.page_id_, std::move(oldest.compressed_));
+    }
+    entries_.pop_front();
+  }
+}
+
+// The compressed page is a sequence of (literal length, literals, match length, match offset), all lengths and
+// offsets varints. A match length of 0 ends the page, with no offset after it.
+std::string CompressedPageCache::Compress(const char *data) {
+  std::string out;
+  out.reserve(PAGE_SIZE / 4);
+  // table[h]: 1 + the last position whose 4 bytes hashed to h, 0 = none
+  uint16_t table[1U << HASH_BITS] = {};
+  size_t anchor = 0;
+  size_t pos = 0;
+  while (pos + MIN_MATCH <= PAGE_SIZE) {
+    uint32_t sequence = Load32(data + pos);
+    uint32_t h = Hash(sequence);
+    size_t candidate = table[h];
+    table[h] = static_cast<uint16_t>(pos + 1);
+    if (candidate == 0 || Load32(data + candidate - 1) != sequence) {
+      pos++;
+      continue;
+    }
+    candidate--;
+    size_t length = MIN_MATCH;
+    while (pos + length < PAGE_SIZE && data[candidate + length] == data[pos + length]) {
+      length++;
+    }
+    PutVarint(&out, pos - anchor);
+    out.append(data + anchor, pos - anchor);
+    PutVarint(&out, length);
+    PutVarint(&out, pos - candidate);
+    pos += length;
+    anchor = pos;
+  }
+  PutVarint(&out, PAGE_SIZE - anchor);
+  out.append(data + anchor, PAGE_SIZE - anchor);
+  PutVarint(&out, 0);
+  return out;
+}
+
+bool CompressedPageCache::Decompress(const std::string &compressed, char *data) {
+  size_t in = 0;
+  size_t out = 0;
+  while (true) {
+    size_t literals;
+    if (!GetVarint(compressed, &in, &literals) || literals > compressed.size() - in || literals > PAGE_SIZE - out) {
+      return false;
+    }
+    memcpy(data + out, compressed.data() + in, literals);
+    in += literals;
+    out += literals;
+    size_t length;
+    if (!GetVarint(compressed, &in, &length)) {
+      return false;
+    }
+    if (length == 0) {
+      return out == PAGE_SIZE && in == compressed.size();
+    }
+    size_t offset;
+    if (!GetVarint(compressed, &in, &offset) || offset == 0 || offset > out || length > PAGE_SIZE - out) {
+      return false;
+    }
+    // byte by byte: a match may overlap the bytes it produces, e.g. a run of zeros at offset 1
+    for (size_t i = 0; i < length; i++, out++) {
+      data[out] = data[out - offset];
+    }
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,146 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.cpp
+//
+// Identification: src/buffer/frame_arena.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+namespace {
+size_t RoundUp(size_t size, size_t alignment) { return (size + alignment - 1) / alignment * alignment; }
+}  // namespace
+
+FrameArena::FrameArena(size_t max_frames, size_t num_frames, HugePagePolicy huge_pages, size_t prefault_threads)
+    : size_(std::max<size_t>(max_frames, 1) * PAGE_SIZE), huge_pages_(huge_pages), prefault_threads_(prefault_threads) {
+  if (prefault_threads_ == 0) {
+    prefault_threads_ = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  }
+  // a huge page for a handful of frames would mostly be wasted
+  if (size_ < HUGE_PAGE_SIZE) {
+    huge_pages_ = HugePagePolicy::NONE;
+  }
+  if (huge_pages_ != HugePagePolicy::NONE) {
+    size_ = RoundUp(size_, HUGE_PAGE_SIZE);
+  }
+
+  base_ = Map(huge_pages_);
+  if (base_ == nullptr && huge_pages_ == HugePagePolicy::EXPLICIT) {
+    LOG_WARN("FrameArena: no %zu bytes of reserved huge pages, falling back to transparent huge pages", size_);
+    huge_pages_ = HugePagePolicy::TRANSPARENT;
+    base_ = Map(huge_pages_);
+  }
+  if (base_ == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "FrameArena: cannot map the buffer pool frames");
+  }
+
+  Populate(0, static_cast<frame_id_t>(std::min(num_frames, max_frames)));
+}
+
+FrameArena::~FrameArena() { munmap(base_, size_); }
+
+char *FrameArena::Map(HugePagePolicy huge_pages) {
+  switch (huge_pages) {
+    case HugePagePolicy::EXPLICIT: {
+#ifdef MAP_HUGETLB
+      // reserves huge pages for the whole arena up front, or the pool could run out of them while growing
+      void *addr = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+      return addr == MAP_FAILED ? nullptr : static_cast<char *>(addr);
+#else
+      return nullptr;
+#endif
+    }
+    case HugePagePolicy::TRANSPARENT: {
+      // mmap only guarantees the base page alignment: map one huge page more than needed and trim both ends, so the
+      // arena starts on a huge page boundary and every 2MB of it can be backed by one huge page
+      size_t padded = size_ + HUGE_PAGE_SIZE;
+      void *addr =
+          mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+      if (addr == MAP_FAILED) {
+        return nullptr;
+      }
+      auto start = reinterpret_cast<uintptr_t>(addr);
+      uintptr_t aligned = RoundUp(start, HUGE_PAGE_SIZE);
+      if (aligned > start) {
+        munmap(addr, aligned - start);
+      }
+      if (start + padded > aligned + size_) {
+        munmap(reinterpret_cast<void *>(aligned + size_), start + padded - (aligned + size_));
+      }
+#ifdef MADV_HUGEPAGE
+      // only advice: the kernel may not have transparent huge pages enabled
+      madvise(reinterpret_cast<void *>(aligned), size_, MADV_HUGEPAGE);
+#endif
+      return reinterpret_cast<char *>(aligned);
+    }
+    case HugePagePolicy::NONE:
+    default: {
+      void *addr = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+      return addr == MAP_FAILED ? nullptr : static_cast<char *>(addr);
+    }
+  }
+}
+
+void FrameArena::Populate(frame_id_t begin, frame_id_t end) {
+  if (begin < end) {
+    Prefault(GetFrame(begin), GetFrame(end));
+  }
+}
+
+void FrameArena::Release(frame_id_t begin, frame_id_t end) {
+  if (begin < end && huge_pages_ != HugePagePolicy::EXPLICIT) {
+    madvise(GetFrame(begin), static_cast<size_t>(end - begin) * PAGE_SIZE, MADV_DONTNEED);
+  }
+}
+
+void FrameArena::Prefault(char *begin, char *end) {
+  // one write per page the range is backed by. With huge pages, the range may start or end inside one: round it out
+  // to huge page boundaries (the arena starts on one) so that a partial huge page at either end is counted, but write
+  // to the first byte of each page that is inside the range, as the rest of a partial page may hold frames in use.
+  size_t step = huge_pages_ == HugePagePolicy::NONE ? static_cast<size_t>(sysconf(_SC_PAGESIZE)) : HUGE_PAGE_SIZE;
+  size_t first_page = static_cast<size_t>(begin - base_) / step;
+  size_t end_page = RoundUp(static_cast<size_t>(end - base_), step) / step;
+  size_t num_steps = end_page - first_page;
+  size_t size = num_steps * step;
+  // below 64MB per thread, starting the threads costs more than they save
+  size_t num_threads = std::clamp<size_t>(size / (64 * 1024 * 1024), 1, prefault_threads_);
+
+  auto touch = [this, begin, step, first_page](size_t first, size_t last) {
+    for (size_t i = first; i < last; i++) {
+      // a write, so the page is actually allocated rather than mapped to the shared zero page
+      *static_cast<volatile char *>(std::max(begin, base_ + (first_page + i) * step)) = 0;
+    }
+  };
+  if (num_threads == 1) {
+    touch(0, num_steps);
+    return;
+  }
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  for (size_t t = 0; t < num_threads; t++) {
+    threads.emplace_back(touch, num_steps * t / num_threads, num_steps * (t + 1) / num_threads);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+}  // namespace bustub
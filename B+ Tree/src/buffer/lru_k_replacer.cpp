@@ -0,0 +1,220 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.cpp
+//
+// Identification: src/buffer/lru_k_replacer.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/lru_k_replacer.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "common/logger.h"
+
+namespace bustub {
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k, uint64_t correlated_window)
+    : num_pages_(num_pages),
+      k_(std::max<size_t>(k, 1)),
+      correlated_window_(correlated_window),
+      history_(num_pages * k_, 0),
+      history_size_(num_pages, 0),
+      last_reference_(num_pages, 0),
+      frame_page_(num_pages, INVALID_PAGE_ID),
+      nodes_(num_pages),
+      node_key_(num_pages),
+      place_(num_pages, Place::PINNED),
+      retained_(num_pages),
+      retained_history_(num_pages * k_, 0) {
+  for (size_t i = 0; i < num_pages; i++) {
+    auto frame_id = static_cast<frame_id_t>(i);
+    nodes_[i] = evictable_.extract(evictable_.insert({Rank::FEWER_THAN_K, 0, frame_id}).first);
+  }
+  retained_index_.reserve(num_pages);
+}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+bool LRUKReplacer::VictimIf(frame_id_t *frame_id, const FrameFilter &accept) {
+  ExpireWindow();
+  auto accepted = [&accept](const EvictionKey &key) { return !accept || accept(std::get<2>(key)); };
+  // frames referenced within the correlated window only go if nothing else can
+  KeySet *candidates = &evictable_;
+  auto victim = std::find_if(evictable_.begin(), evictable_.end(), accepted);
+  if (victim == evictable_.end()) {
+    candidates = &in_window_;
+    victim = std::find_if(in_window_.begin(), in_window_.end(), accepted);
+    if (victim == in_window_.end()) {
+      return false;
+    }
+  }
+  *frame_id = std::get<2>(*victim);
+  nodes_[*frame_id] = candidates->extract(victim);
+  place_[*frame_id] = Place::PINNED;
+  // the frame will hold a different page next; the history stays with the page
+  RetainHistory(*frame_id);
+  return true;
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_pages_) {
+    return;
+  }
+  MakePinned(frame_id);
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id, AccessType access_type) {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_pages_ || place_[frame_id] != Place::PINNED) {
+    return;
+  }
+  if (history_size_[frame_id] > 0) {
+    // the page has been referenced: a scan passing over it does not make it any colder, it keeps its rank
+    access_type = AccessType::NORMAL;
+  }
+  bool in_window = access_type == AccessType::NORMAL && correlated_window_ > 0 && history_size_[frame_id] > 0 &&
+                   current_timestamp_ - last_reference_[frame_id] <= correlated_window_;
+  if (in_window) {
+    node_key_[frame_id] = {Rank::FEWER_THAN_K, last_reference_[frame_id], frame_id};
+  } else if (access_type == AccessType::NORMAL) {
+    node_key_[frame_id] = MakeKey(frame_id);
+  } else {
+    // SCAN / ONCE: ahead of every frame ranked by its history, ONCE frames first
+    Rank rank = access_type == AccessType::ONCE ? Rank::ONCE : Rank::SCAN;
+    node_key_[frame_id] = {rank, current_timestamp_, frame_id};
+  }
+  nodes_[frame_id].value() = node_key_[frame_id];
+  (in_window ? in_window_ : evictable_).insert(std::move(nodes_[frame_id]));
+  place_[frame_id] = in_window ? Place::IN_WINDOW : Place::EVICTABLE;
+}
+
+size_t LRUKReplacer::Size() { return evictable_.size() + in_window_.size(); }
+
+void LRUKReplacer::RecordAccess(frame_id_t frame_id, page_id_t page_id, AccessType access_type) {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_pages_) {
+    return;
+  }
+  if (frame_page_[frame_id] != page_id) {
+    // a different page in the frame: it starts from its own retained history, if it has one
+    RetainHistory(frame_id);
+    frame_page_[frame_id] = page_id;
+    auto retained = retained_index_.find(page_id);
+    if (retained != retained_index_.end()) {
+      size_t slot = retained->second;
+      std::copy_n(&retained_history_[slot * k_], k_, &history_[frame_id * k_]);
+      history_size_[frame_id] = retained_[slot].size_;
+      last_reference_[frame_id] = retained_[slot].last_reference_;
+      retained_[slot].page_id_ = INVALID_PAGE_ID;
+      retained_index_.erase(retained);
+    }
+  }
+  if (access_type != AccessType::NORMAL) {
+    // a scan touching the page says nothing about how often it is used: no reference, and the clock stands still
+    return;
+  }
+
+  uint64_t now = ++current_timestamp_;
+  uint64_t *history = &history_[frame_id * k_];
+  size_t &size = history_size_[frame_id];
+  if (size > 0 && now - last_reference_[frame_id] <= correlated_window_) {
+    // correlated reference: the burst counts as a single reference
+    last_reference_[frame_id] = now;
+    return;
+  }
+  if (size > 0) {
+    // close the previous correlated period: shift the older references forward by its length so that the burst
+    // does not make the page look older than it is
+    uint64_t correlated_period = last_reference_[frame_id] - history[0];
+    for (size_t i = std::min(size, k_ - 1); i > 0; i--) {
+      history[i] = history[i - 1] + correlated_period;
+    }
+  }
+  history[0] = now;
+  size = std::min(size + 1, k_);
+  last_reference_[frame_id] = now;
+}
+
+void LRUKReplacer::Remove(frame_id_t frame_id) {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_pages_) {
+    return;
+  }
+  MakePinned(frame_id);
+  ClearHistory(frame_id);
+}
+
+void LRUKReplacer::PeekVictims(size_t max_frames, std::vector<frame_id_t> *frame_ids) {
+  ExpireWindow();
+  frame_ids->clear();
+  for (const KeySet *candidates : {&evictable_, &in_window_}) {
+    for (auto it = candidates->begin(); it != candidates->end() && frame_ids->size() < max_frames; ++it) {
+      frame_ids->push_back(std::get<2>(*it));
+    }
+  }
+}
+
+LRUKReplacer::EvictionKey LRUKReplacer::MakeKey(frame_id_t frame_id) const {
+  size_t size = history_size_[frame_id];
+  if (size == 0) {
+    // never referenced (e.g. unpinned straight after construction): evict first
+    return {Rank::FEWER_THAN_K, 0, frame_id};
+  }
+  // with size < k_ this is the oldest reference we know of, with size == k_ it is the K-th most recent one
+  return {size == k_ ? Rank::K : Rank::FEWER_THAN_K, history_[frame_id * k_ + size - 1], frame_id};
+}
+
+void LRUKReplacer::ExpireWindow() {
+  while (!in_window_.empty() && current_timestamp_ - std::get<1>(*in_window_.begin()) > correlated_window_) {
+    frame_id_t frame_id = std::get<2>(*in_window_.begin());
+    KeySet::node_type node = in_window_.extract(in_window_.begin());
+    node_key_[frame_id] = MakeKey(frame_id);
+    node.value() = node_key_[frame_id];
+    evictable_.insert(std::move(node));
+    place_[frame_id] = Place::EVICTABLE;
+  }
+}
+
+void LRUKReplacer::MakePinned(frame_id_t frame_id) {
+  if (place_[frame_id] == Place::EVICTABLE) {
+    nodes_[frame_id] = evictable_.extract(node_key_[frame_id]);
+  } else if (place_[frame_id] == Place::IN_WINDOW) {
+    nodes_[frame_id] = in_window_.extract(node_key_[frame_id]);
+  }
+  place_[frame_id] = Place::PINNED;
+}
+
+void LRUKReplacer::RetainHistory(frame_id_t frame_id) {
+  page_id_t page_id = frame_page_[frame_id];
+  if (page_id != INVALID_PAGE_ID && history_size_[frame_id] > 0 && !retained_.empty()) {
+    // the oldest retained history makes room, and once the ring is full its index node is reused for ours. The page
+    // has no retained history yet: RecordAccess took it out when the page came back into a frame.
+    size_t slot = next_retained_;
+    next_retained_ = (next_retained_ + 1) % retained_.size();
+    decltype(retained_index_)::node_type node;
+    if (retained_[slot].page_id_ != INVALID_PAGE_ID) {
+      node = retained_index_.extract(retained_[slot].page_id_);
+    }
+    retained_[slot] = {page_id, history_size_[frame_id], last_reference_[frame_id]};
+    std::copy_n(&history_[frame_id * k_], k_, &retained_history_[slot * k_]);
+    if (node.empty()) {
+      retained_index_.emplace(page_id, slot);
+    } else {
+      node.key() = page_id;
+      node.mapped() = slot;
+      retained_index_.insert(std::move(node));
+    }
+  }
+  ClearHistory(frame_id);
+}
+
+void LRUKReplacer::ClearHistory(frame_id_t frame_id) {
+  history_size_[frame_id] = 0;
+  last_reference_[frame_id] = 0;
+  frame_page_[frame_id] = INVALID_PAGE_ID;
+}
+
+}  // namespace bustub
@@ -14,16 +14,23 @@
 // replacer = abstract class that keeps track of frames/slots in our BP that are avaiable to be replaced
 // with some new page from disk
 #include "buffer/lru_replacer.h"
-#include <algorithm>
 #include "common/logger.h"
 
 namespace bustub {
 
-LRUReplacer::LRUReplacer(size_t num_pages) {
-  // clear the list
-  LRU.clear();
-  // assign num_pages
-  number_pages = num_pages;
+LRUReplacer::LRUReplacer(size_t num_pages)
+    : prev_(num_pages + 2),
+      next_(num_pages + 2),
+      in_lru_(num_pages, false),
+      frame_page_(num_pages, INVALID_PAGE_ID),
+      hot_(num_pages, false),
+      size_(0),
+      number_pages(num_pages) {
+  // both lists start out empty: each sentinel points at itself
+  for (frame_id_t sentinel : {OnceSentinel(), LruSentinel()}) {
+    prev_[sentinel] = sentinel;
+    next_[sentinel] = sentinel;
+  }
 }
 
 LRUReplacer::~LRUReplacer() = default;
@@ -31,22 +38,20 @@ LRUReplacer::~LRUReplacer() = default;
 // Victim = get a frame that should be replaced
 // Victim stores frame_id inside of T; i,e, it takes a frame_id as a parameter
 // returns whether or not the call was succesfful
-bool LRUReplacer::Victim(frame_id_t *frame_id) {
-  // page_id matches frame_id eventaully
-  // First, check if list empty
-  if (LRU.empty()) {
-    // frame_id = nullptr; There is nothing in the list
-    // return false
-    frame_id = nullptr;
-    return false;
+// VictimIf walks the ONCE frames, then the LRU list from the least recently unpinned frame, right after its
+// sentinel, to the first one accept takes
+bool LRUReplacer::VictimIf(frame_id_t *frame_id, const FrameFilter &accept) {
+  for (frame_id_t sentinel : {OnceSentinel(), LruSentinel()}) {
+    for (frame_id_t frame = next_[sentinel]; frame != sentinel; frame = next_[frame]) {
+      if (!accept || accept(frame)) {
+        *frame_id = frame;
+        Unlink(frame);
+        return true;
+      }
+    }
   }
-  // if list is not empty
-  // go to my list and get the LRU
-  // *frame_id = first position in the list
-  *frame_id = LRU.front();
-  // and remove the frame_id from the list
-  LRU.pop_front();
-  return true;
+  // the list is empty, or nothing in it was accepted
+  return false;
 }
 
 // Corresponding to pinning a page in the BPM
@@ -54,51 +59,98 @@ bool LRUReplacer::Victim(frame_id_t *frame_id) {
 // Do nothing if the frame isn't in the LRU
 // In other words, pin() tells the replacer - this frame is in use and can't  be replaced
 void LRUReplacer::Pin(frame_id_t frame_id) {
-  // look in your list
-  // if it's not there, return - do nothing
-  // if it's there, remove it from the list
-  bool list_contains_frame_id = std::find(LRU.begin(), LRU.end(), frame_id) != LRU.end();
-
-  if (list_contains_frame_id) {
-    LRU.remove(frame_id);
-  } else {
+  // frame_id >= num_pages can never have been unpinned
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= number_pages || !in_lru_[frame_id]) {
     return;
   }
+  Unlink(frame_id);
 }
 
-// Adds the specified frame into the LRU - std::list<frame_id_t>
+// Adds the specified frame into the LRU
 // Called by the BPM when the pin count reaches 0
 // Does nothing when the frame (frame_id) is already unpinned
 // In other words, this frame isn't being used, pin_count = 0; it's eligible to be replaced
-void LRUReplacer::Unpin(frame_id_t frame_id) {
-  // initially, your list is empty
-  // the test case passed in frame id 1, which isn't in the list
-  // check if the frame_id_t is in the list
-  if (LRU.size() < number_pages) {
-    bool list_contains_frame_id = std::find(LRU.begin(), LRU.end(), frame_id) != LRU.end();
+// A SCAN frame goes to the cold end instead, so it is the next victim after the ONCE frames, which are kept on a
+// list of their own that Victim empties first. A hot frame, one whose page was accessed normally since it came into
+// the frame, ignores the hint: a scan passing over it does not make it any colder.
+void LRUReplacer::Unpin(frame_id_t frame_id, AccessType access_type) {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= number_pages) {
+    LOG_DEBUG("LRUReplacer::Unpin frame %d out of range", frame_id);
+    return;
+  }
+  // if the frame is already in the list, it's already been unpinned - do nothing
+  if (in_lru_[frame_id]) {
+    return;
+  }
+  if (hot_[frame_id]) {
+    access_type = AccessType::NORMAL;
+  }
+  // otherwise it becomes the most recently unpinned frame
+  switch (access_type) {
+    case AccessType::NORMAL:
+      LinkAfter(frame_id, prev_[LruSentinel()]);
+      break;
+    case AccessType::SCAN:
+      LinkAfter(frame_id, LruSentinel());
+      break;
+    case AccessType::ONCE:
+      LinkAfter(frame_id, prev_[OnceSentinel()]);
+      break;
+  }
+}
 
-    // if the frame found in std::list, it's already been unpinned - do nothing
-    if (list_contains_frame_id) {
-      // do nothing
-      return;
-    }
-    // if the frame not found in std::list, add to your std::list
-    LRU.push_back(frame_id);
-    // list will have 1 2 3 4 5 6 if I call unpin 6 times with the frame_ids
+size_t LRUReplacer::Size() { return size_; }
+
+// A page new to the frame starts out cold; its first normal access makes it hot
+void LRUReplacer::RecordAccess(frame_id_t frame_id, page_id_t page_id, AccessType access_type) {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= number_pages) {
+    return;
+  }
+  if (frame_page_[frame_id] != page_id) {
+    frame_page_[frame_id] = page_id;
+    hot_[frame_id] = false;
+  }
+  if (access_type == AccessType::NORMAL) {
+    hot_[frame_id] = true;
+  }
+}
+
+// Besides its place in the list, LRU only remembers whether the frame's page is hot
+void LRUReplacer::Remove(frame_id_t frame_id) {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= number_pages) {
+    return;
+  }
+  frame_page_[frame_id] = INVALID_PAGE_ID;
+  hot_[frame_id] = false;
+  if (in_lru_[frame_id]) {
+    Unlink(frame_id);
   }
 }
 
-size_t LRUReplacer::Size() {
-  // return the size of the list
-  return LRU.size();
+// Walk the ONCE list, then the LRU list from the least recently unpinned end, the order Victim takes frames in
+void LRUReplacer::PeekVictims(size_t max_frames, std::vector<frame_id_t> *frame_ids) {
+  frame_ids->clear();
+  for (frame_id_t sentinel : {OnceSentinel(), LruSentinel()}) {
+    for (frame_id_t f = next_[sentinel]; f != sentinel && frame_ids->size() < max_frames; f = next_[f]) {
+      frame_ids->push_back(f);
+    }
+  }
 }
 
-// void LRUReplacer::printReplacer(){
-//   LOG_INFO("Jahoon print Replacer");
-//   for (auto v : LRU){
-//     LOG_INFO("Jahoon LRU: %d", v);
-//   }
+void LRUReplacer::Unlink(frame_id_t frame_id) {
+  next_[prev_[frame_id]] = next_[frame_id];
+  prev_[next_[frame_id]] = prev_[frame_id];
+  in_lru_[frame_id] = false;
+  size_--;
+}
 
-// }
+void LRUReplacer::LinkAfter(frame_id_t frame_id, frame_id_t after) {
+  prev_[frame_id] = after;
+  next_[frame_id] = next_[after];
+  prev_[next_[after]] = frame_id;
+  next_[after] = frame_id;
+  in_lru_[frame_id] = true;
+  size_++;
+}
 
 }  // namespace bustub
@@ -0,0 +1,171 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// mmap_buffer_pool_manager.cpp
+//
+// Identification: src/buffer/mmap_buffer_pool_manager.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/mmap_buffer_pool_manager.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+MmapBufferPoolManager::MmapBufferPoolManager(const std::string &db_file) {
+  int fd = open(db_file.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw Exception(ExceptionType::INVALID, "MmapBufferPoolManager: cannot open " + db_file);
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    throw Exception(ExceptionType::INVALID, "MmapBufferPoolManager: cannot stat " + db_file);
+  }
+  num_pages_ = static_cast<size_t>(st.st_size) / PAGE_SIZE;
+  if (num_pages_ > 0) {
+    void *addr = mmap(nullptr, num_pages_ * PAGE_SIZE, PROT_READ, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+      close(fd);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "MmapBufferPoolManager: cannot map " + db_file);
+    }
+    base_ = static_cast<char *>(addr);
+  }
+  // the mapping keeps the file open
+  close(fd);
+
+  // the Pages come one chunk at a time, with the first fetch of a page in it
+  chunks_ = std::vector<std::atomic<Page *>>((num_pages_ + PAGES_PER_CHUNK - 1) / PAGES_PER_CHUNK);
+}
+
+MmapBufferPoolManager::~MmapBufferPoolManager() {
+  for (auto &chunk : chunks_) {
+    delete[] chunk.load(std::memory_order_relaxed);
+  }
+  if (base_ != nullptr) {
+    munmap(base_, num_pages_ * PAGE_SIZE);
+  }
+}
+
+Page *MmapBufferPoolManager::GetPage(page_id_t page_id) {
+  std::atomic<Page *> &chunk = chunks_[page_id / PAGES_PER_CHUNK];
+  Page *pages = chunk.load(std::memory_order_acquire);
+  if (pages == nullptr) {
+    size_t first = page_id - page_id % PAGES_PER_CHUNK;
+    auto *fresh = new Page[PAGES_PER_CHUNK];
+    for (size_t i = 0; i < PAGES_PER_CHUNK && first + i < num_pages_; i++) {
+      fresh[i].data_ = base_ + (first + i) * PAGE_SIZE;
+      fresh[i].page_id_ = static_cast<page_id_t>(first + i);
+    }
+    // another fetch may have filled the chunk in meanwhile; its Pages win and ours are dropped
+    if (chunk.compare_exchange_strong(pages, fresh, std::memory_order_acq_rel, std::memory_order_acquire)) {
+      pages = fresh;
+    } else {
+      delete[] fresh;
+    }
+  }
+  return &pages[page_id % PAGES_PER_CHUNK];
+}
+
+Page *MmapBufferPoolManager::FetchPageImpl(page_id_t page_id, AccessType access_type, partition_id_t partition) {
+  if (!Contains(page_id)) {
+    fetch_failures_.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+  return GetPage(page_id);
+}
+
+bool MmapBufferPoolManager::UnpinPageImpl(page_id_t page_id, bool is_dirty, AccessType access_type) {
+  return Contains(page_id) && !is_dirty;
+}
+
+bool MmapBufferPoolManager::FlushPageImpl(page_id_t page_id) { return Contains(page_id); }
+
+Page *MmapBufferPoolManager::NewPageImpl(page_id_t *page_id, partition_id_t partition) {
+  new_page_failures_.fetch_add(1, std::memory_order_relaxed);
+  *page_id = INVALID_PAGE_ID;
+  return nullptr;
+}
+
+bool MmapBufferPoolManager::DeletePageImpl(page_id_t page_id) { return !Contains(page_id); }
+
+void MmapBufferPoolManager::FlushAllPagesImpl(FlushStats *stats) {
+  if (stats != nullptr) {
+    *stats = FlushStats{};
+  }
+}
+
+bool MmapBufferPoolManager::PrefetchPageImpl(page_id_t page_id, AccessType access_type, partition_id_t partition) {
+  if (Contains(page_id)) {
+    madvise(base_ + static_cast<size_t>(page_id) * PAGE_SIZE, PAGE_SIZE, MADV_WILLNEED);
+  }
+  return false;
+}
+
+void MmapBufferPoolManager::PrefetchPagesImpl(const std::vector<page_id_t> &page_ids, AccessType access_type,
+                                              partition_id_t partition) {
+  for (page_id_t page_id : page_ids) {
+    PrefetchPageImpl(page_id, access_type, partition);
+  }
+}
+
+bool MmapBufferPoolManager::ResizeImpl(size_t pool_size) { return false; }
+
+PageHandle MmapBufferPoolManager::FetchPageHandleImpl(page_id_t page_id, AccessType access_type,
+                                                      partition_id_t partition) {
+  Page *page = FetchPageImpl(page_id, access_type, partition);
+  if (page == nullptr) {
+    return {};
+  }
+  return PageHandle(this, page, static_cast<frame_id_t>(page_id), access_type);
+}
+
+PageHandle MmapBufferPoolManager::NewPageHandleImpl(page_id_t *page_id, partition_id_t partition) {
+  NewPageImpl(page_id, partition);
+  return {};
+}
+
+void MmapBufferPoolManager::UnpinFrameImpl(frame_id_t frame_id, page_id_t page_id, bool is_dirty,
+                                           AccessType access_type) {
+  // rejected like UnpinPage with is_dirty set; the page cannot have changed, as the mapping is read-only
+  if (is_dirty) {
+    LOG_WARN("MmapBufferPoolManager: page %d released dirty, but the pool is read-only", page_id);
+  }
+}
+
+void MmapBufferPoolManager::PinFrameImpl(frame_id_t frame_id, page_id_t page_id, AccessType access_type) {}
+
+Page *MmapBufferPoolManager::PeekPageImpl(page_id_t page_id, uint64_t *version) {
+  if (!Contains(page_id)) {
+    return nullptr;
+  }
+  Page *page = GetPage(page_id);
+  *version = page->GetVersion();
+  return page;
+}
+
+BufferPoolMetrics MmapBufferPoolManager::GetMetricsImpl() {
+  BufferPoolMetrics metrics;
+  metrics.fetch_failures_ = fetch_failures_.load(std::memory_order_relaxed);
+  metrics.new_page_failures_ = new_page_failures_.load(std::memory_order_relaxed);
+  return metrics;
+}
+
+BufferPoolManager *MmapBufferPoolManager::CreatePartitionImpl(const std::string &name, size_t min_frames,
+                                                              size_t max_frames) {
+  return nullptr;
+}
+
+std::vector<BufferPoolPartitionMetrics> MmapBufferPoolManager::GetPartitionMetricsImpl() { return {}; }
+
+}  // namespace bustub
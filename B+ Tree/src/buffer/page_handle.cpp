@@ -0,0 +1,73 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_handle.cpp
+//
+// Identification: src/buffer/page_handle.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_handle.h"
+
+#include "buffer/buffer_pool_manager.h"
+
+namespace bustub {
+
+PageHandle::PageHandle(PageHandle &&other) noexcept
+    : bpm_(other.bpm_),
+      page_(other.page_),
+      page_id_(other.page_id_),
+      frame_id_(other.frame_id_),
+      access_type_(other.access_type_),
+      is_dirty_(other.is_dirty_) {
+  other.Reset();
+}
+
+PageHandle &PageHandle::operator=(PageHandle &&other) noexcept {
+  if (this != &other) {
+    Release();
+    bpm_ = other.bpm_;
+    page_ = other.page_;
+    page_id_ = other.page_id_;
+    frame_id_ = other.frame_id_;
+    access_type_ = other.access_type_;
+    is_dirty_ = other.is_dirty_;
+    other.Reset();
+  }
+  return *this;
+}
+
+PageHandle PageHandle::Repin() const {
+  if (!IsValid()) {
+    return {};
+  }
+  bpm_->PinFrameImpl(frame_id_, page_id_, access_type_);
+  return PageHandle(bpm_, page_, frame_id_, access_type_);
+}
+
+void PageHandle::Release() {
+  if (!IsValid()) {
+    return;
+  }
+  bpm_->UnpinFrameImpl(frame_id_, page_id_, is_dirty_, access_type_);
+  Reset();
+}
+
+Page *PageHandle::Detach() {
+  Page *page = page_;
+  Reset();
+  return page;
+}
+
+void PageHandle::Reset() {
+  bpm_ = nullptr;
+  page_ = nullptr;
+  page_id_ = INVALID_PAGE_ID;
+  frame_id_ = -1;
+  is_dirty_ = false;
+}
+
+}  // namespace bustub
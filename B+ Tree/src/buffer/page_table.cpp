@@ -0,0 +1,114 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.cpp
+//
+// Identification: src/buffer/page_table.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+#include "common/macros.h"
+
+namespace bustub {
+
+PageTable::PageTable(size_t num_frames) {
+  size_t capacity = 2;
+  int bits = 1;
+  while (capacity < 2 * num_frames) {
+    capacity <<= 1;
+    bits++;
+  }
+  slots_.resize(capacity);
+  mask_ = capacity - 1;
+  shift_ = 64 - bits;
+}
+
+size_t PageTable::Home(page_id_t page_id) const {
+  // Fibonacci hashing: page ids are mostly small and dense, the multiply spreads them over the top bits
+  uint64_t key = static_cast<uint32_t>(page_id);
+  return static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> shift_);
+}
+
+bool PageTable::Find(page_id_t page_id, frame_id_t *frame_id) const {
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  for (size_t i = Home(page_id);; i = (i + 1) & mask_) {
+    const Slot &slot = slots_[i];
+    if (slot.page_id_ == page_id) {
+      *frame_id = slot.frame_id_;
+      return true;
+    }
+    if (slot.page_id_ == INVALID_PAGE_ID) {
+      return false;
+    }
+  }
+}
+
+bool PageTable::FindUnlatched(page_id_t page_id, frame_id_t *frame_id) const {
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  // Erase may be shifting the cluster under us: give up after one pass over the table rather than chase it
+  size_t i = Home(page_id);
+  for (size_t probes = 0; probes <= mask_; probes++, i = (i + 1) & mask_) {
+    page_id_t slot_page_id = __atomic_load_n(&slots_[i].page_id_, __ATOMIC_ACQUIRE);
+    if (slot_page_id == page_id) {
+      *frame_id = __atomic_load_n(&slots_[i].frame_id_, __ATOMIC_RELAXED);
+      return true;
+    }
+    if (slot_page_id == INVALID_PAGE_ID) {
+      return false;
+    }
+  }
+  return false;
+}
+
+void PageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+  BUSTUB_ASSERT(page_id != INVALID_PAGE_ID, "cannot insert the invalid page id");
+  BUSTUB_ASSERT(size_ < slots_.size() - 1, "page table is full");
+  size_t i = Home(page_id);
+  while (slots_[i].page_id_ != INVALID_PAGE_ID) {
+    BUSTUB_ASSERT(slots_[i].page_id_ != page_id, "page is already in the page table");
+    i = (i + 1) & mask_;
+  }
+  Store(&slots_[i], page_id, frame_id);
+  size_++;
+}
+
+bool PageTable::Erase(page_id_t page_id) {
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  size_t hole = Home(page_id);
+  while (slots_[hole].page_id_ != page_id) {
+    if (slots_[hole].page_id_ == INVALID_PAGE_ID) {
+      return false;
+    }
+    hole = (hole + 1) & mask_;
+  }
+  // backward shift: walk the rest of the cluster and move back every entry whose home is not in (hole, i]
+  for (size_t i = (hole + 1) & mask_; slots_[i].page_id_ != INVALID_PAGE_ID; i = (i + 1) & mask_) {
+    size_t home = Home(slots_[i].page_id_);
+    if (((i - home) & mask_) >= ((i - hole) & mask_)) {
+      Store(&slots_[hole], slots_[i].page_id_, slots_[i].frame_id_);
+      hole = i;
+    }
+  }
+  Store(&slots_[hole], INVALID_PAGE_ID, -1);
+  size_--;
+  return true;
+}
+
+void PageTable::Store(Slot *slot, page_id_t page_id, frame_id_t frame_id) {
+  // the frame first: a lookup that sees the new page id should not pair it with the slot's old frame
+  __atomic_store_n(&slot->frame_id_, frame_id, __ATOMIC_RELAXED);
+  __atomic_store_n(&slot->page_id_, page_id, __ATOMIC_RELEASE);
+}
+
+}  // namespace bustub
@@ -0,0 +1,260 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.cpp
+//
+// Identification: src/buffer/parallel_buffer_pool_manager.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include <chrono>  // NOLINT
+#include <thread>  // NOLINT
+
+#include "common/macros.h"
+
+namespace bustub {
+
+ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                                                     LogManager *log_manager, const BufferPoolOptions &options)
+    : disk_scheduler_(new DiskScheduler(disk_manager, options.io_queue_depth_, options.db_file_, options.direct_io_)) {
+  BUSTUB_ASSERT(num_instances > 0, "A parallel BPM needs at least one instance");
+  // Allocate and create individual BufferPoolManagerInstances
+  instances_.reserve(num_instances);
+  for (size_t i = 0; i < num_instances; i++) {
+    instances_.push_back(new BufferPoolManagerInstance(pool_size, static_cast<uint32_t>(num_instances),
+                                                       static_cast<uint32_t>(i), disk_manager, log_manager, options,
+                                                       disk_scheduler_));
+  }
+}
+
+// Destroy all BufferPoolManagerInstances and deallocate any associated memory
+ParallelBufferPoolManager::~ParallelBufferPoolManager() {
+  for (auto *instance : instances_) {
+    delete instance;
+  }
+  // after the instances, whose destructors may still write pages
+  delete disk_scheduler_;
+  for (auto *view : partition_views_) {
+    delete view;
+  }
+}
+
+size_t ParallelBufferPoolManager::GetPoolSize() {
+  // Get size of all BufferPoolManagerInstances
+  size_t pool_size = 0;
+  for (auto *instance : instances_) {
+    pool_size += instance->GetPoolSize();
+  }
+  return pool_size;
+}
+
+size_t ParallelBufferPoolManager::SaveWarmSet() {
+  size_t saved = 0;
+  for (auto *instance : instances_) {
+    saved += instance->SaveWarmSet();
+  }
+  return saved;
+}
+
+BufferPoolManagerInstance *ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) {
+  // Get BufferPoolManager responsible for handling given page id. You can use this method in your other methods.
+  return instances_[static_cast<size_t>(page_id) % instances_.size()];
+}
+
+Page *ParallelBufferPoolManager::FetchPageImpl(page_id_t page_id, AccessType access_type, partition_id_t partition) {
+  // Fetch page for page_id from responsible BufferPoolManagerInstance
+  return GetBufferPoolManager(page_id)->FetchPageImpl(page_id, access_type, partition);
+}
+
+bool ParallelBufferPoolManager::UnpinPageImpl(page_id_t page_id, bool is_dirty, AccessType access_type) {
+  // Unpin page_id from responsible BufferPoolManagerInstance
+  return GetBufferPoolManager(page_id)->UnpinPage(page_id, is_dirty, access_type);
+}
+
+bool ParallelBufferPoolManager::FlushPageImpl(page_id_t page_id) {
+  // Flush page_id from responsible BufferPoolManagerInstance
+  return GetBufferPoolManager(page_id)->FlushPage(page_id);
+}
+
+Page *ParallelBufferPoolManager::NewPageImpl(page_id_t *page_id, partition_id_t partition) {
+  // create new page. We will request page allocation in a round robin manner from the underlying
+  // BufferPoolManagerInstances
+  // 1.   From a starting index of the BPMIs, call NewPageImpl until either 1) success and return 2) looped around to
+  // starting index and return nullptr
+  // 2.   Bump the starting index (mod number of instances) to start search at a different BPMI each time this function
+  // is called
+  size_t start = next_instance_.fetch_add(1) % instances_.size();
+  for (size_t i = 0; i < instances_.size(); i++) {
+    Page *page = instances_[(start + i) % instances_.size()]->NewPageImpl(page_id, partition);
+    if (page != nullptr) {
+      return page;
+    }
+  }
+  *page_id = INVALID_PAGE_ID;
+  return nullptr;
+}
+
+bool ParallelBufferPoolManager::DeletePageImpl(page_id_t page_id) {
+  // Delete page_id from responsible BufferPoolManagerInstance
+  return GetBufferPoolManager(page_id)->DeletePage(page_id);
+}
+
+void ParallelBufferPoolManager::FlushAllPagesImpl(FlushStats *stats) {
+  // flush all pages from all BufferPoolManagerInstances, one thread per instance
+  auto start = std::chrono::steady_clock::now();
+  std::vector<FlushStats> instance_stats(instances_.size());
+  std::vector<std::thread> threads;
+  threads.reserve(instances_.size());
+  for (size_t i = 0; i < instances_.size(); i++) {
+    threads.emplace_back([this, &instance_stats, i] { instance_stats[i] = instances_[i]->FlushAllPagesWithStats(); });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  if (stats != nullptr) {
+    *stats = FlushStats();
+    for (const auto &instance : instance_stats) {
+      stats->pages_written_ += instance.pages_written_;
+      stats->bytes_written_ += instance.bytes_written_;
+      stats->write_requests_ += instance.write_requests_;
+    }
+    stats->elapsed_ns_ = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+  }
+}
+
+bool ParallelBufferPoolManager::PrefetchPageImpl(page_id_t page_id, AccessType access_type,
+                                                 partition_id_t partition) {
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  return GetBufferPoolManager(page_id)->PrefetchPageImpl(page_id, access_type, partition);
+}
+
+bool ParallelBufferPoolManager::ResizeImpl(size_t pool_size) {
+  auto share = [this, pool_size](size_t i) {
+    return pool_size / instances_.size() + (i < pool_size % instances_.size() ? 1 : 0);
+  };
+  // no partition is created in between, so every instance still takes its share of the minimums below
+  std::scoped_lock partition_latch{partition_latch_};
+  for (size_t i = 0; i < instances_.size(); i++) {
+    size_t reserved = 0;
+    for (const auto &partition : instances_[i]->GetPartitionMetricsImpl()) {
+      reserved += partition.min_frames_;
+    }
+    if (share(i) == 0 || share(i) > instances_[i]->GetMaxPoolSize() || share(i) < reserved) {
+      return false;
+    }
+  }
+  for (size_t i = 0; i < instances_.size(); i++) {
+    instances_[i]->Resize(share(i));
+  }
+  return true;
+}
+
+void ParallelBufferPoolManager::PrefetchPagesImpl(const std::vector<page_id_t> &page_ids, AccessType access_type,
+                                                  partition_id_t partition) {
+  std::vector<std::vector<page_id_t>> per_instance(instances_.size());
+  for (page_id_t page_id : page_ids) {
+    if (page_id != INVALID_PAGE_ID) {
+      per_instance[static_cast<size_t>(page_id) % instances_.size()].push_back(page_id);
+    }
+  }
+  for (size_t i = 0; i < instances_.size(); i++) {
+    if (!per_instance[i].empty()) {
+      instances_[i]->PrefetchPagesImpl(per_instance[i], access_type, partition);
+    }
+  }
+}
+
+PageHandle ParallelBufferPoolManager::FetchPageHandleImpl(page_id_t page_id, AccessType access_type,
+                                                          partition_id_t partition) {
+  // the handle points at the responsible instance, so it unpins there directly
+  return GetBufferPoolManager(page_id)->FetchPageHandleImpl(page_id, access_type, partition);
+}
+
+PageHandle ParallelBufferPoolManager::NewPageHandleImpl(page_id_t *page_id, partition_id_t partition) {
+  // round robin over the instances, as NewPageImpl
+  size_t start = next_instance_.fetch_add(1) % instances_.size();
+  for (size_t i = 0; i < instances_.size(); i++) {
+    PageHandle handle = instances_[(start + i) % instances_.size()]->NewPageHandleImpl(page_id, partition);
+    if (handle) {
+      return handle;
+    }
+  }
+  *page_id = INVALID_PAGE_ID;
+  return {};
+}
+
+void ParallelBufferPoolManager::UnpinFrameImpl(frame_id_t frame_id, page_id_t page_id, bool is_dirty,
+                                               AccessType access_type) {
+  // handles are made by the instances and unpin there; frame ids mean nothing without the instance
+  GetBufferPoolManager(page_id)->UnpinPage(page_id, is_dirty, access_type);
+}
+
+void ParallelBufferPoolManager::PinFrameImpl(frame_id_t frame_id, page_id_t page_id, AccessType access_type) {
+  GetBufferPoolManager(page_id)->FetchPage(page_id, access_type);
+}
+
+Page *ParallelBufferPoolManager::PeekPageImpl(page_id_t page_id, uint64_t *version) {
+  if (page_id == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+  return GetBufferPoolManager(page_id)->PeekPage(page_id, version);
+}
+
+BufferPoolMetrics ParallelBufferPoolManager::GetMetricsImpl() {
+  BufferPoolMetrics metrics;
+  for (auto *instance : instances_) {
+    metrics += instance->GetMetrics();
+  }
+  // every instance reports the latencies of the shared scheduler; they count once
+  DiskSchedulerStats io = disk_scheduler_->GetStats();
+  metrics.read_latency_ = io.read_latency_;
+  metrics.write_latency_ = io.write_latency_;
+  return metrics;
+}
+
+BufferPoolManager *ParallelBufferPoolManager::CreatePartitionImpl(const std::string &name, size_t min_frames,
+                                                                  size_t max_frames) {
+  auto share = [this](size_t frames, size_t i) {
+    return frames / instances_.size() + (i < frames % instances_.size() ? 1 : 0);
+  };
+  std::scoped_lock partition_latch{partition_latch_};
+  size_t reserved = min_frames;
+  for (const auto &partition : GetPartitionMetricsImpl()) {
+    if (partition.name_ == name) {
+      return nullptr;
+    }
+    reserved += partition.min_frames_;
+  }
+  if (name.empty() || min_frames > max_frames || max_frames < instances_.size() || reserved > GetPoolSize()) {
+    return nullptr;
+  }
+  // the quota was checked as a whole; an instance's share of the minimums may be off by a frame per partition
+  partition_id_t partition_id = DEFAULT_PARTITION;
+  for (size_t i = 0; i < instances_.size(); i++) {
+    std::scoped_lock latch{instances_[i]->latch_};
+    partition_id = instances_[i]->AddPartition(name, share(min_frames, i), share(max_frames, i));
+  }
+  partition_views_.push_back(new BufferPoolPartition(this, partition_id));
+  return partition_views_.back();
+}
+
+std::vector<BufferPoolPartitionMetrics> ParallelBufferPoolManager::GetPartitionMetricsImpl() {
+  std::vector<BufferPoolPartitionMetrics> partitions = instances_[0]->GetPartitionMetricsImpl();
+  for (size_t i = 1; i < instances_.size(); i++) {
+    std::vector<BufferPoolPartitionMetrics> instance_partitions = instances_[i]->GetPartitionMetricsImpl();
+    for (size_t id = 0; id < partitions.size() && id < instance_partitions.size(); id++) {
+      partitions[id] += instance_partitions[id];
+    }
+  }
+  return partitions;
+}
+
+}  // namespace bustub
@@ -0,0 +1,143 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// spill_cache.cpp
+//
+// Identification: src/buffer/spill_cache.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/spill_cache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+namespace bustub {
+
+SpillCache::SpillCache(const std::string &file_name, size_t capacity, size_t queue_depth)
+    : file_name_(file_name),
+      max_writes_(std::max<size_t>(queue_depth, 1) * 8),
+      slots_(capacity),
+      directory_(capacity),
+      disk_manager_(file_name),
+      disk_scheduler_(new DiskScheduler(&disk_manager_, queue_depth, file_name)) {}
+
+SpillCache::~SpillCache() {
+  delete disk_scheduler_;
+  disk_manager_.ShutDown();
+  std::remove(file_name_.c_str());
+}
+
+bool SpillCache::Insert(page_id_t page_id, const char *data) {
+  std::scoped_lock latch{latch_};
+  frame_id_t old_slot;
+  if (directory_.Find(page_id, &old_slot)) {
+    Forget(page_id, old_slot);
+  }
+  size_t slot;
+  if (writing_.size() >= max_writes_ || !TakeSlot(&slot)) {
+    return false;
+  }
+  // the caller's frame is reused as soon as we return, so the write goes out from a copy, which also serves reads of
+  // the page until the write completes
+  auto copy = std::make_shared<std::vector<char>>(data, data + PAGE_SIZE);
+  slots_[slot].page_id_ = page_id;
+  slots_[slot].state_ = SlotState::WRITING;
+  directory_.Insert(page_id, static_cast<frame_id_t>(slot));
+  writing_[slot] = copy;
+  DiskRequest write{true, copy->data(), static_cast<page_id_t>(slot), disk_scheduler_->CreatePromise(),
+                    [this, slot, copy](bool ok, uint64_t) { FinishIO(slot, ok); }, {}, {}};
+  disk_scheduler_->Schedule(std::move(write));
+  return true;
+}
+
+bool SpillCache::Read(page_id_t page_id, char *data, std::promise<bool> *promise,
+                      const std::function<void(std::promise<bool>)> &on_failure) {
+  std::scoped_lock latch{latch_};
+  frame_id_t slot;
+  if (!directory_.Find(page_id, &slot)) {
+    return false;
+  }
+  if (slots_[slot].state_ == SlotState::WRITING) {
+    memcpy(data, writing_[slot]->data(), PAGE_SIZE);
+    Forget(page_id, slot);
+    promise->set_value(true);
+    return true;
+  }
+  directory_.Erase(page_id);
+  slots_[slot].page_id_ = INVALID_PAGE_ID;
+  slots_[slot].state_ = SlotState::READING;
+  // the request's own promise goes unused: on_complete_ completes the reader's, or hands it on
+  auto reader = std::make_shared<std::promise<bool>>(std::move(*promise));
+  DiskRequest read{false, data, static_cast<page_id_t>(slot), disk_scheduler_->CreatePromise(),
+                   [this, slot, reader, on_failure](bool ok, uint64_t) {
+                     FinishIO(slot, ok);
+                     if (ok) {
+                       reader->set_value(true);
+                     } else {
+                       on_failure(std::move(*reader));
+                     }
+                   },
+                   {}, {}};
+  disk_scheduler_->Schedule(std::move(read));
+  return true;
+}
+
+void SpillCache::Erase(page_id_t page_id) {
+  std::scoped_lock latch{latch_};
+  frame_id_t slot;
+  if (directory_.Find(page_id, &slot)) {
+    Forget(page_id, slot);
+  }
+}
+
+size_t SpillCache::Size() {
+  std::scoped_lock latch{latch_};
+  return directory_.Size();
+}
+
+bool SpillCache::TakeSlot(size_t *slot) {
+  for (size_t i = 0; i < slots_.size(); i++) {
+    size_t candidate = hand_;
+    hand_ = (hand_ + 1) % slots_.size();
+    if (slots_[candidate].state_ == SlotState::VALID) {
+      Forget(slots_[candidate].page_id_, candidate);
+    }
+    if (slots_[candidate].state_ == SlotState::FREE) {
+      *slot = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+void SpillCache::Forget(page_id_t page_id, size_t slot) {
+  directory_.Erase(page_id);
+  slots_[slot].page_id_ = INVALID_PAGE_ID;
+  if (slots_[slot].state_ == SlotState::VALID) {
+    slots_[slot].state_ = SlotState::FREE;
+  }
+}
+
+void SpillCache::FinishIO(size_t slot, bool ok) {
+  std::scoped_lock latch{latch_};
+  if (slots_[slot].state_ == SlotState::WRITING) {
+    writing_.erase(slot);
+    if (!ok && slots_[slot].page_id_ != INVALID_PAGE_ID) {
+      // the slot does not hold the page; it is clean, so the database file still has it
+      directory_.Erase(slots_[slot].page_id_);
+      slots_[slot].page_id_ = INVALID_PAGE_ID;
+    }
+    // the page may have been read or erased while it was being written
+    slots_[slot].state_ = slots_[slot].page_id_ == INVALID_PAGE_ID ? SlotState::FREE : SlotState::VALID;
+  } else {
+    slots_[slot].state_ = SlotState::FREE;
+  }
+}
+
+}  // namespace bustub
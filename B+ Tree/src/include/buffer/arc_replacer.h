@@ -0,0 +1,124 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.h
+//
+// Identification: src/include/buffer/arc_replacer.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * ARCReplacer implements Adaptive Replacement Cache (Megiddo & Modha, FAST '03).
+ *
+ * Resident pages live in one of two LRU lists: T1 holds pages referenced once since they entered the pool (recency),
+ * T2 pages referenced at least twice (frequency). Two ghost lists, B1 and B2, remember the ids of pages recently
+ * evicted from T1 and T2. A miss on a ghost page means the corresponding list was too small, so the target size p of
+ * T1 moves towards it: scan-heavy phases grow T1, point-lookup-heavy phases grow T2, without any tuning.
+ *
+ * Ghost hits need page ids, which the replacer learns through RecordAccess. Victim only considers unpinned frames; a
+ * pinned frame keeps its position and is skipped.
+ *
+ * Frames unpinned with a SCAN hint go to the LRU end of T1 if they are on it; a SCAN hit on a T2 page leaves it where
+ * it is. Frames unpinned with a ONCE hint leave T1 / T2 for a list of their own that Victim empties first, and leave
+ * no ghost behind when evicted. Both hints only apply to pages without a NORMAL access since they came into the frame.
+ */
+class ARCReplacer : public Replacer {
+ public:
+  /**
+   * Create a new ARCReplacer.
+   * @param num_pages the maximum number of pages the ARCReplacer will be required to store
+   */
+  explicit ARCReplacer(size_t num_pages);
+
+  /**
+   * Destroys the ARCReplacer.
+   */
+  ~ARCReplacer() override;
+
+  bool VictimIf(frame_id_t *frame_id, const FrameFilter &accept) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id, AccessType access_type = AccessType::NORMAL) override;
+
+  size_t Size() override;
+
+  void RecordAccess(frame_id_t frame_id, page_id_t page_id, AccessType access_type = AccessType::NORMAL) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  void PeekVictims(size_t max_frames, std::vector<frame_id_t> *frame_ids) override;
+
+  /** @return the current target size p of T1; the target size of T2 is num_pages - p */
+  size_t GetTargetSize() const { return target_; }
+
+  /** @return number of resident frames in T1 (recency list) */
+  size_t GetRecencySize() const { return t1_.size(); }
+
+  /** @return number of resident frames in T2 (frequency list) */
+  size_t GetFrequencySize() const { return t2_.size(); }
+
+  /** @return number of page ids in the B1 / B2 ghost lists */
+  size_t GetGhostRecencySize() const { return b1_.size(); }
+  size_t GetGhostFrequencySize() const { return b2_.size(); }
+
+ private:
+  enum class Location { NONE, T1, T2, ONCE };
+
+  /** Ghost list of evicted page ids, most recently evicted at the front. */
+  struct GhostList {
+    std::list<page_id_t> order_;
+    std::unordered_map<page_id_t, std::list<page_id_t>::iterator> index_;
+    size_t size() const { return order_.size(); }
+  };
+
+  /**
+   * Evict the least recently used unpinned frame of list that accept takes, remembering its page in ghost unless
+   * ghost is nullptr.
+   */
+  bool EvictFrom(std::list<frame_id_t> *list, GhostList *ghost, const FrameFilter &accept, frame_id_t *frame_id);
+  void Unlink(frame_id_t frame_id);
+  std::list<frame_id_t> &ListOf(Location location);
+  static bool EraseGhost(GhostList *ghost, page_id_t page_id);
+  static void PushGhost(GhostList *ghost, page_id_t page_id);
+  /** Trim the ghost lists to |T1| + |B1| <= c and |T1| + |T2| + |B1| + |B2| <= 2c. */
+  void TrimGhosts();
+
+  size_t num_pages_;
+  /** Target size of T1, "p" in the paper. */
+  size_t target_;
+  /** Resident lists, most recently used at the front. */
+  std::list<frame_id_t> t1_;
+  std::list<frame_id_t> t2_;
+  /** Frames unpinned with a ONCE hint, in neither T1 nor T2, most recently unpinned at the front. */
+  std::list<frame_id_t> once_;
+  GhostList b1_;
+  GhostList b2_;
+  /**
+   * Per-frame state: which list the frame is on, where, which page it holds, whether that page had a NORMAL access since
+   * it came in, and whether the frame may be evicted.
+   */
+  std::vector<Location> location_;
+  std::vector<std::list<frame_id_t>::iterator> position_;
+  std::vector<page_id_t> page_;
+  std::vector<bool> referenced_;
+  std::vector<bool> evictable_;
+  /** Number of evictable frames. */
+  size_t size_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,108 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// batched_replacer.h
+//
+// Identification: src/include/buffer/batched_replacer.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <functional>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * BatchedReplacer wraps any Replacer so that the hit path does not serialize on the replacer lock, following
+ * BP-Wrapper (Ding, Jiang & Zhang, ICDE '09).
+ *
+ * Pin / Unpin / RecordAccess only append to a small access buffer. Buffers are striped by thread, so threads rarely
+ * share one. A full buffer is committed to the wrapped replacer as one batch, but only if the replacer lock can be
+ * taken without waiting; otherwise the thread keeps buffering, up to a hard limit. Victim, Size and Remove need an
+ * exact view, so they drain every buffer first.
+ *
+ * Batches from different threads may be committed out of order. Recency only needs an approximate order, but the
+ * pinned / unpinned state must be exact, so it is not replayed from the buffer: when a Pin or Unpin entry is
+ * committed, the wrapper asks is_pinned for the frame's current state. Victim also re-checks its answer against
+ * is_pinned, in case a Pin is still sitting in a buffer that another thread is committing.
+ */
+class BatchedReplacer : public Replacer {
+ public:
+  /** Number of access buffers; threads are spread over them round robin. */
+  static constexpr size_t NUM_STRIPES = 16;
+  /** Default number of buffered accesses per stripe before a commit is attempted. */
+  static constexpr size_t DEFAULT_BATCH_SIZE = 64;
+
+  /**
+   * Create a new BatchedReplacer.
+   * @param replacer the replacer to wrap, owned (and deleted) by the BatchedReplacer
+   * @param is_pinned tells whether a frame is currently pinned, i.e. not eligible for replacement; called by whichever
+   * thread commits a batch, without the buffer pool's latch
+   * @param batch_size number of buffered accesses per stripe before a commit is attempted
+   */
+  BatchedReplacer(Replacer *replacer, std::function<bool(frame_id_t)> is_pinned,
+                  size_t batch_size = DEFAULT_BATCH_SIZE);
+
+  /**
+   * Destroys the BatchedReplacer and the replacer it wraps.
+   */
+  ~BatchedReplacer() override;
+
+  bool VictimIf(frame_id_t *frame_id, const FrameFilter &accept) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id, AccessType access_type = AccessType::NORMAL) override;
+
+  size_t Size() override;
+
+  void RecordAccess(frame_id_t frame_id, page_id_t page_id, AccessType access_type = AccessType::NORMAL) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  void PeekVictims(size_t max_frames, std::vector<frame_id_t> *frame_ids) override;
+
+  /** @return the wrapped replacer; only safe to inspect while no other thread uses the buffer pool */
+  Replacer *GetReplacer() { return replacer_; }
+
+ private:
+  enum class AccessKind { ACCESS, PIN, UNPIN };
+
+  struct Access {
+    AccessKind kind_;
+    frame_id_t frame_id_;
+    page_id_t page_id_;
+    AccessType access_type_;
+  };
+
+  /** One access buffer. Aligned to a cache line so stripes used by different cores do not false-share. */
+  struct alignas(64) Stripe {
+    std::mutex latch_;
+    std::vector<Access> buffer_;
+  };
+
+  void Record(const Access &access);
+  /** Apply a batch to the wrapped replacer. Caller holds latch_. */
+  void Commit(const std::vector<Access> &batch);
+  /** Commit every stripe. Caller holds latch_. */
+  void DrainAll();
+
+  Replacer *replacer_;
+  std::function<bool(frame_id_t)> is_pinned_;
+  size_t batch_size_;
+  /** Protects replacer_. */
+  std::mutex latch_;
+  std::array<Stripe, NUM_STRIPES> stripes_;
+};
+
+}  // namespace bustub
@@ -12,37 +12,52 @@
 
 #pragma once
 
-#include <list>
-#include <mutex>  // NOLINT
-#include <unordered_map>
+#include <cstdint>
+#include <string>
+#include <vector>
 
-#include "buffer/lru_replacer.h"
+#include "buffer/buffer_pool_metrics.h"
+#include "buffer/page_handle.h"
+#include "buffer/replacer.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
 
 namespace bustub {
 
+/** Identifies a partition of a buffer pool; see BufferPoolManager::CreatePartition. */
+using partition_id_t = uint32_t;
+/** The partition of the pages brought in through the buffer pool itself rather than through a partition. */
+static constexpr partition_id_t DEFAULT_PARTITION = 0;
+
+/** What a FlushAllPages wrote. */
+struct FlushStats {
+  /** Dirty pages written. */
+  uint64_t pages_written_{0};
+  uint64_t bytes_written_{0};
+  /** Write requests issued; runs of consecutive page ids are written with one request. */
+  uint64_t write_requests_{0};
+  /** Wall clock time of the flush. */
+  uint64_t elapsed_ns_{0};
+};
+
 /**
  * BufferPoolManager reads disk pages to and from its internal buffer pool.
+ *
+ * This is the interface the rest of the system (e.g. BPlusTree) programs against. BufferPoolManagerInstance is a single
+ * buffer pool with its own latch; ParallelBufferPoolManager shards pages over several instances; BufferPoolPartition is
+ * a share of either, handed out by CreatePartition.
  */
 class BufferPoolManager {
  public:
   enum class CallbackType { BEFORE, AFTER };
   using bufferpool_callback_fn = void (*)(enum CallbackType, const page_id_t page_id);
 
-  /**
-   * Creates a new BufferPoolManager.
-   * @param pool_size the size of the buffer pool
-   * @param disk_manager the disk manager
-   * @param log_manager the log manager (for testing only: nullptr = disable logging)
-   */
-  BufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr);
-
+  BufferPoolManager() = default;
   /**
    * Destroys an existing BufferPoolManager.
    */
-  ~BufferPoolManager();
+  virtual ~BufferPoolManager() = default;
 
   /** Grading function. Do not modify! */
   Page *FetchPage(page_id_t page_id, bufferpool_callback_fn callback = nullptr) {
@@ -60,6 +75,54 @@ class BufferPoolManager {
     return result;
   }
 
+  /**
+   * FetchPage with an access hint, e.g. AccessType::SCAN from an index scan so the page does not push the working
+   * set out of the buffer pool.
+   */
+  Page *FetchPage(page_id_t page_id, AccessType access_type, bufferpool_callback_fn callback = nullptr) {
+    GradingCallback(callback, CallbackType::BEFORE, page_id);
+    auto *result = FetchPageImpl(page_id, access_type);
+    GradingCallback(callback, CallbackType::AFTER, page_id);
+    return result;
+  }
+
+  /** UnpinPage with an access hint; SCAN and ONCE put the frame at the cold end of the replacer. */
+  bool UnpinPage(page_id_t page_id, bool is_dirty, AccessType access_type, bufferpool_callback_fn callback = nullptr) {
+    GradingCallback(callback, CallbackType::BEFORE, page_id);
+    auto result = UnpinPageImpl(page_id, is_dirty, access_type);
+    GradingCallback(callback, CallbackType::AFTER, page_id);
+    return result;
+  }
+
+  /**
+   * FetchPage returning a PageHandle, which unpins the page when it goes out of scope and unpins without a page table
+   * lookup.
+   * @param page_id id of the page to fetch
+   * @param access_type hint passed on to the replacer, on the fetch and again when the handle unpins
+   * @return a handle on the pinned page, an empty handle if the page could not be fetched
+   */
+  PageHandle FetchPageHandle(page_id_t page_id, AccessType access_type = AccessType::NORMAL) {
+    return FetchPageHandleImpl(page_id, access_type, DEFAULT_PARTITION);
+  }
+
+  /**
+   * NewPage returning a PageHandle.
+   * @param[out] page_id id of the created page
+   * @return a handle on the pinned page, an empty handle if no page could be created
+   */
+  PageHandle NewPageHandle(page_id_t *page_id) { return NewPageHandleImpl(page_id, DEFAULT_PARTITION); }
+
+  /**
+   * Find a resident page for an optimistic read: without pinning it and without taking any latch, so concurrent
+   * readers do not contend on anything. The page may be written, evicted or replaced by another page at any time; the
+   * caller must treat what it reads as possibly torn, and check with page->ValidateVersion(*version) after reading
+   * that it saw a consistent copy of this page. A page that is only ever peeked at is not seen by the replacer.
+   * @param page_id id of the page
+   * @param[out] version the page version to validate against
+   * @return the page, nullptr if it is not resident or is being written or read in; fall back to FetchPage then
+   */
+  Page *PeekPage(page_id_t page_id, uint64_t *version) { return PeekPageImpl(page_id, version); }
+
   /** Grading function. Do not modify! */
   bool FlushPage(page_id_t page_id, bufferpool_callback_fn callback = nullptr) {
     GradingCallback(callback, CallbackType::BEFORE, page_id);
@@ -87,19 +150,88 @@ class BufferPoolManager {
   /** Grading function. Do not modify! */
   void FlushAllPages(bufferpool_callback_fn callback = nullptr) {
     GradingCallback(callback, CallbackType::BEFORE, INVALID_PAGE_ID);
-    FlushAllPagesImpl();
+    FlushAllPagesImpl(nullptr);
     GradingCallback(callback, CallbackType::AFTER, INVALID_PAGE_ID);
   }
 
-  /** @return pointer to all the pages in the buffer pool */
-  Page *GetPages() { return pages_; }
+  /** FlushAllPages that reports what it wrote, e.g. for a checkpoint or shutdown. */
+  FlushStats FlushAllPagesWithStats() {
+    FlushStats stats;
+    FlushAllPagesImpl(&stats);
+    return stats;
+  }
+
+  /**
+   * Start reading a page into the buffer pool without waiting for it and without pinning it, so that a later
+   * FetchPage finds it resident. Concurrent fetches of the page wait for the read rather than issuing their own.
+   * @param page_id id of the page to prefetch
+   * @param access_type hint passed on to the replacer
+   * @return true if the page is resident and readable already, false if a read was started or no frame was free
+   */
+  bool PrefetchPage(page_id_t page_id, AccessType access_type = AccessType::NORMAL) {
+    return PrefetchPageImpl(page_id, access_type, DEFAULT_PARTITION);
+  }
+
+  /**
+   * PrefetchPage for many pages at once; all the reads are started before any of them completes.
+   * @param page_ids ids of the pages to prefetch
+   * @param access_type hint passed on to the replacer
+   */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids, AccessType access_type = AccessType::NORMAL) {
+    PrefetchPagesImpl(page_ids, access_type, DEFAULT_PARTITION);
+  }
+
+  /**
+   * Change the number of frames of the buffer pool while it is in use. Growing adds free frames. Shrinking writes back
+   * and evicts the pages in the frames being removed and gives their memory back; pages that are pinned stay readable
+   * and are evicted when they are last unpinned.
+   * @param pool_size the new size of the buffer pool
+   * @return false if the size is not supported, e.g. 0, above the maximum the pool was created with, or below the
+   * minimums of its partitions
+   */
+  bool Resize(size_t pool_size) { return ResizeImpl(pool_size); }
 
   /** @return size of the buffer pool */
-  size_t GetPoolSize() { return pool_size_; }
-  // remove it later
-  // Replacer *GetReplacer() { return replacer_;}
-  
+  virtual size_t GetPoolSize() = 0;
+
+  /**
+   * @return true if the pages of the pool must not be written to: NewPage and dirty unpins fail, and writing to a
+   * fetched page's data may crash. Callers that change pages check this first.
+   */
+  virtual bool IsReadOnly() { return false; }
+
+  /** @return a snapshot of what the buffer pool has done since it was created; see BufferPoolMetrics */
+  BufferPoolMetrics GetMetrics() { return GetMetricsImpl(); }
+
+  /**
+   * Create a named partition of the buffer pool with a quota of frames, e.g. one per index, so that a bulk load into
+   * one index cannot push the working sets of the others out of the pool.
+   *
+   * The partition comes as a BufferPoolManager to hand to its user, e.g. a BPlusTree: a page that a fetch, new page
+   * or prefetch through it brings into the pool is charged to the partition for as long as it stays in the pool, and
+   * everything else goes straight to the pool. Pages brought in through the pool itself are charged to the default
+   * partition, which has no quota. When a partition needs a frame:
+   *   - at max_frames, it replaces one of its own pages;
+   *   - below it, it takes a free frame, or else the replacer's victim among its own pages and the pages of the
+   *     partitions over their min_frames. Pages of partitions at or below their minimum are never evicted for another
+   *     partition.
+   * @param name unique name of the partition, e.g. the index name
+   * @param min_frames frames the partition keeps once it has them; the minimums of all partitions must fit in the pool
+   * @param max_frames frames the partition may hold at most, at least min_frames and 1
+   * @return the partition, owned by the buffer pool; nullptr if the name is taken, the quota is not valid or the pool
+   * does not support partitions
+   */
+  BufferPoolManager *CreatePartition(const std::string &name, size_t min_frames, size_t max_frames) {
+    return CreatePartitionImpl(name, min_frames, max_frames);
+  }
+
+  /** @return the quota and usage of every partition, the default partition first; see BufferPoolPartitionMetrics */
+  std::vector<BufferPoolPartitionMetrics> GetPartitionMetrics() { return GetPartitionMetricsImpl(); }
+
  protected:
+  friend class PageHandle;
+  friend class BufferPoolPartition;
+
   /**
    * Grading function. Do not modify!
    * Invokes the callback function if it is not null.
@@ -116,63 +248,131 @@ class BufferPoolManager {
   /**
    * Fetch the requested page from the buffer pool.
    * @param page_id id of page to be fetched
+   * @param access_type hint passed on to the replacer
+   * @param partition the partition to charge the page to if it has to be read in
    * @return the requested page
    */
-  Page *FetchPageImpl(page_id_t page_id);
+  virtual Page *FetchPageImpl(page_id_t page_id, AccessType access_type = AccessType::NORMAL,
+                              partition_id_t partition = DEFAULT_PARTITION) = 0;
 
   /**
    * Unpin the target page from the buffer pool.
    * @param page_id id of page to be unpinned
    * @param is_dirty true if the page should be marked as dirty, false otherwise
+   * @param access_type hint passed on to the replacer
    * @return false if the page pin count is <= 0 before this call, true otherwise
    */
-  bool UnpinPageImpl(page_id_t page_id, bool is_dirty);
+  virtual bool UnpinPageImpl(page_id_t page_id, bool is_dirty, AccessType access_type = AccessType::NORMAL) = 0;
 
   /**
    * Flushes the target page to disk.
    * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
-   * @return false if the page could not be found in the page table, true otherwise
+   * @return false if the page could not be found in the page table or could not be written, true otherwise
    */
-  bool FlushPageImpl(page_id_t page_id);
+  virtual bool FlushPageImpl(page_id_t page_id) = 0;
 
   /**
    * Creates a new page in the buffer pool.
    * @param[out] page_id id of created page
+   * @param partition the partition to charge the page to
    * @return nullptr if no new pages could be created, otherwise pointer to new page
    */
-  Page *NewPageImpl(page_id_t *page_id);
+  virtual Page *NewPageImpl(page_id_t *page_id, partition_id_t partition = DEFAULT_PARTITION) = 0;
 
   /**
    * Deletes a page from the buffer pool.
    * @param page_id id of page to be deleted
    * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
    */
-  bool DeletePageImpl(page_id_t page_id);
-
-  /**
-   * Flushes all the pages in the buffer pool to disk.
-   */
-  void FlushAllPagesImpl();
-
-  /** Number of pages in the buffer pool. */
-  size_t pool_size_;
-  /** Array of buffer pool pages. */
-  Page *pages_;
-  /** Pointer to the disk manager. - read writte pages from disk, given */
-  DiskManager *disk_manager_ __attribute__((__unused__));
-  /** Pointer to the log manager. */
-  LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. - hash table pageid -> frameid */
-  std::unordered_map<page_id_t, frame_id_t> page_table_;
-  /** Replacer to find unpinned pages for replacement. */
-  // BPM needs access to the replace class because it needs to find a page where I can copy a disk page to
-  // this is part A of project 1 (LRU Replacer)
-  Replacer *replacer_;
-  // look here for free pages in BPM, else go to replacer/LRU
-  /** List of free pages. */
-  std::list<frame_id_t> free_list_;
-  // X
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
-  std::mutex latch_;
+  virtual bool DeletePageImpl(page_id_t page_id) = 0;
+
+  /**
+   * Flushes all the dirty pages in the buffer pool to disk.
+   * @param[out] stats if not nullptr, what was written
+   */
+  virtual void FlushAllPagesImpl(FlushStats *stats) = 0;
+
+  /**
+   * Start reading a page into the buffer pool without pinning it.
+   * @param page_id id of the page to prefetch
+   * @param access_type hint passed on to the replacer
+   * @param partition the partition to charge the page to if it has to be read in
+   * @return true if the page is resident and readable already
+   */
+  virtual bool PrefetchPageImpl(page_id_t page_id, AccessType access_type, partition_id_t partition) = 0;
+
+  /**
+   * Start reading many pages into the buffer pool without pinning them.
+   * @param page_ids ids of the pages to prefetch
+   * @param access_type hint passed on to the replacer
+   * @param partition the partition to charge the pages read in to
+   */
+  virtual void PrefetchPagesImpl(const std::vector<page_id_t> &page_ids, AccessType access_type,
+                                 partition_id_t partition) = 0;
+
+  /**
+   * Change the number of frames of the buffer pool.
+   * @param pool_size the new size of the buffer pool
+   * @return false if the size is not supported
+   */
+  virtual bool ResizeImpl(size_t pool_size) = 0;
+
+  /**
+   * Fetch a page and wrap it in a PageHandle.
+   * @param page_id id of the page to fetch
+   * @param access_type hint passed on to the replacer
+   * @param partition the partition to charge the page to if it has to be read in
+   * @return a handle on the pinned page, an empty handle on failure
+   */
+  virtual PageHandle FetchPageHandleImpl(page_id_t page_id, AccessType access_type, partition_id_t partition) = 0;
+
+  /**
+   * Create a page and wrap it in a PageHandle.
+   * @param[out] page_id id of the created page
+   * @param partition the partition to charge the page to
+   * @return a handle on the pinned page, an empty handle on failure
+   */
+  virtual PageHandle NewPageHandleImpl(page_id_t *page_id, partition_id_t partition) = 0;
+
+  /**
+   * Unpin a page by its frame, for PageHandle. The caller holds a pin on the page, so it is still in that frame.
+   * @param frame_id the frame the page is in
+   * @param page_id id of the page
+   * @param is_dirty true if the page should be marked as dirty
+   * @param access_type hint passed on to the replacer
+   */
+  virtual void UnpinFrameImpl(frame_id_t frame_id, page_id_t page_id, bool is_dirty, AccessType access_type) = 0;
+
+  /**
+   * Pin a page once more by its frame, for PageHandle. The caller holds a pin on the page, so it is still in that
+   * frame.
+   * @param frame_id the frame the page is in
+   * @param page_id id of the page
+   * @param access_type hint passed on to the replacer
+   */
+  virtual void PinFrameImpl(frame_id_t frame_id, page_id_t page_id, AccessType access_type) = 0;
+
+  /**
+   * Find a resident page without pinning or latching.
+   * @param page_id id of the page
+   * @param[out] version the page version to validate against
+   * @return the page, nullptr if it is not resident or is being written or read in
+   */
+  virtual Page *PeekPageImpl(page_id_t page_id, uint64_t *version) = 0;
+
+  /** @return a snapshot of the buffer pool's counters and I/O latencies */
+  virtual BufferPoolMetrics GetMetricsImpl() = 0;
+
+  /**
+   * Create a named partition of the buffer pool.
+   * @param name unique name of the partition
+   * @param min_frames frames the partition keeps once it has them
+   * @param max_frames frames the partition may hold at most
+   * @return the partition, owned by the buffer pool; nullptr if it cannot be created
+   */
+  virtual BufferPoolManager *CreatePartitionImpl(const std::string &name, size_t min_frames, size_t max_frames) = 0;
+
+  /** @return the quota and usage of every partition, the default partition first */
+  virtual std::vector<BufferPoolPartitionMetrics> GetPartitionMetricsImpl() = 0;
 };
 }  // namespace bustub
@@ -0,0 +1,651 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_manager_instance.h
+//
+// Identification: src/include/buffer/buffer_pool_manager_instance.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <future>              // NOLINT
+#include <list>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_options.h"
+#include "buffer/buffer_pool_partition.h"
+#include "buffer/compressed_page_cache.h"
+#include "buffer/frame_arena.h"
+#include "buffer/lru_replacer.h"
+#include "buffer/page_table.h"
+#include "buffer/spill_cache.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_scheduler.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * BufferPoolManagerInstance is a single buffer pool: one latch, one page table, one free list and one replacer.
+ * It is used on its own, or as one shard of a ParallelBufferPoolManager.
+ *
+ * Every frame holding a page is charged to a partition, the default one unless the page was brought in through a
+ * BufferPoolPartition. TakeFrame enforces the quotas by handing the replacer a filter of the frames it may victimize.
+ *
+ * Warm restart: with options_.warm_file_ set, the instance saves the ids of its resident pages to the file, see
+ * SaveWarmSet, and the next instance created with the file reads them back in before the constructor returns, see
+ * LoadWarmSet.
+ */
+class BufferPoolManagerInstance : public BufferPoolManager {
+  friend class ParallelBufferPoolManager;
+
+ public:
+  /**
+   * Creates a new BufferPoolManagerInstance.
+   * @param pool_size the size of the buffer pool
+   * @param disk_manager the disk manager
+   * @param log_manager the log manager; a dirty page is written only once the log is on disk up to the page's LSN
+   * (for testing only: nullptr = disable logging)
+   * @param options tuning knobs, e.g. the replacement policy
+   */
+  BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            const BufferPoolOptions &options = BufferPoolOptions());
+
+  /**
+   * Creates a new BufferPoolManagerInstance that is one shard of a parallel buffer pool.
+   * @param pool_size the size of the buffer pool
+   * @param num_instances total number of BPIs in the parallel BPM
+   * @param instance_index index of this BPI in the parallel BPM
+   * @param disk_manager the disk manager
+   * @param log_manager the log manager; a dirty page is written only once the log is on disk up to the page's LSN
+   * (for testing only: nullptr = disable logging)
+   * @param options tuning knobs, e.g. the replacement policy
+   * @param disk_scheduler the disk manager's scheduler, shared with the other BPIs; nullptr = one of this BPI's own
+   */
+  BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                            DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            const BufferPoolOptions &options = BufferPoolOptions(),
+                            DiskScheduler *disk_scheduler = nullptr);
+
+  /**
+   * Destroys an existing BufferPoolManagerInstance.
+   */
+  ~BufferPoolManagerInstance() override;
+
+  /** @return size of the buffer pool */
+  size_t GetPoolSize() override { return pool_size_; }
+
+  /** @return the largest size the buffer pool can be resized to */
+  size_t GetMaxPoolSize() const { return max_pool_size_; }
+
+  /** @return pointer to all the pages in the buffer pool */
+  Page *GetPages() { return pages_; }
+
+  /** @return the replacer, e.g. to watch an adaptive policy such as ARCReplacer adjust itself */
+  Replacer *GetReplacer() { return replacer_; }
+
+  /**
+   * @return the scheduler all of this instance's disk I/O goes through, e.g. for its latency counters; shared by the
+   * instances of a parallel pool
+   */
+  DiskScheduler *GetDiskScheduler() { return disk_scheduler_; }
+
+  /**
+   * Save the ids of the resident pages to options_.warm_file_, hottest first: the pinned pages, then the others from
+   * the replacer's last victim to its next one. The ids are collected under latch_, which is released for the write;
+   * the file is written to a temporary file next to it and renamed over it, so a crash leaves the old one intact.
+   * Called on destruction and by the warm saver thread; does nothing without options_.warm_file_.
+   * @return the number of page ids saved, 0 if the file could not be written
+   */
+  size_t SaveWarmSet();
+
+ protected:
+  /**
+   * Fetch the requested page from the buffer pool.
+   * @param page_id id of page to be fetched
+   * @param access_type hint passed on to the replacer
+   * @param partition the partition to charge the page to if it has to be read in
+   * @return the requested page
+   */
+  Page *FetchPageImpl(page_id_t page_id, AccessType access_type, partition_id_t partition) override;
+
+  /**
+   * Unpin the target page from the buffer pool.
+   * @param page_id id of page to be unpinned
+   * @param is_dirty true if the page should be marked as dirty, false otherwise
+   * @param access_type hint passed on to the replacer
+   * @return false if the page pin count is <= 0 before this call, true otherwise
+   */
+  bool UnpinPageImpl(page_id_t page_id, bool is_dirty, AccessType access_type) override;
+
+  /**
+   * Flushes the target page to disk.
+   * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
+   * @return false if the page could not be found in the page table or could not be written, true otherwise
+   */
+  bool FlushPageImpl(page_id_t page_id) override;
+
+  /**
+   * Creates a new page in the buffer pool.
+   * @param[out] page_id id of created page
+   * @param partition the partition to charge the page to
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPageImpl(page_id_t *page_id, partition_id_t partition) override;
+
+  /**
+   * Deletes a page from the buffer pool.
+   * @param page_id id of page to be deleted
+   * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
+   */
+  bool DeletePageImpl(page_id_t page_id) override;
+
+  /**
+   * Flushes all the dirty pages in the buffer pool to disk. The dirty pages are sorted by page id, runs of consecutive
+   * page ids are coalesced into vectored writes of up to flush_max_run_pages_ pages, and all the writes are handed to
+   * the DiskScheduler at once, so they are carried out io_queue_depth_ at a time. latch_ is held throughout.
+   * @param[out] stats if not nullptr, what was written
+   */
+  void FlushAllPagesImpl(FlushStats *stats) override;
+
+  /**
+   * Start reading a page into a frame without pinning it.
+   * @param page_id id of the page to prefetch
+   * @param access_type hint passed on to the replacer
+   * @param partition the partition to charge the page to if it has to be read in
+   * @return true if the page is resident and readable already
+   */
+  bool PrefetchPageImpl(page_id_t page_id, AccessType access_type, partition_id_t partition) override;
+
+  /**
+   * Start reading many pages into frames without pinning them. latch_ is taken once for the whole batch.
+   * @param page_ids ids of the pages to prefetch
+   * @param access_type hint passed on to the replacer
+   * @param partition the partition to charge the pages read in to
+   */
+  void PrefetchPagesImpl(const std::vector<page_id_t> &page_ids, AccessType access_type,
+                         partition_id_t partition) override;
+
+  /**
+   * Change the number of frames. Frames [pool_size, max_pool_size_) are always reserved, so resizing never moves a
+   * Page. A shrink takes the removed frames out of TakeFrame's reach under latch_, writes their dirty pages back with
+   * WriteBackFrames and then evicts them. Frames at or above pool_size_ that still hold a pinned page are retired by
+   * FreeFrame on their last unpin.
+   * @param pool_size the new size of the buffer pool, 1 to max_pool_size_, and no less than the partitions' minimums
+   * @return false if the size is out of range
+   */
+  bool ResizeImpl(size_t pool_size) override;
+
+  /**
+   * FetchPageImpl, with the frame the page landed in recorded in the handle.
+   * @param page_id id of the page to fetch
+   * @param access_type hint passed on to the replacer
+   * @param partition the partition to charge the page to if it has to be read in
+   * @return a handle on the pinned page, an empty handle on failure
+   */
+  PageHandle FetchPageHandleImpl(page_id_t page_id, AccessType access_type, partition_id_t partition) override;
+
+  /**
+   * NewPageImpl, with the frame of the new page recorded in the handle.
+   * @param[out] page_id id of the created page
+   * @param partition the partition to charge the page to
+   * @return a handle on the pinned page, an empty handle on failure
+   */
+  PageHandle NewPageHandleImpl(page_id_t *page_id, partition_id_t partition) override;
+
+  /**
+   * UnpinPageImpl without the page table lookup.
+   * @param frame_id the frame the page is in
+   * @param page_id id of the page, checked against the frame
+   * @param is_dirty true if the page should be marked as dirty
+   * @param access_type hint passed on to the replacer
+   */
+  void UnpinFrameImpl(frame_id_t frame_id, page_id_t page_id, bool is_dirty, AccessType access_type) override;
+
+  /**
+   * Pin the page in a frame once more, without the page table lookup. The page must be pinned already.
+   * @param frame_id the frame the page is in
+   * @param page_id id of the page, checked against the frame
+   * @param access_type hint passed on to the replacer
+   */
+  void PinFrameImpl(frame_id_t frame_id, page_id_t page_id, AccessType access_type) override;
+
+  /**
+   * Find a resident page without taking latch_ and without pinning it; see BufferPoolManager::PeekPage.
+   * @param page_id id of the page
+   * @param[out] version the page version to validate against
+   * @return the page, nullptr if it is not resident or is being written or read in
+   */
+  Page *PeekPageImpl(page_id_t page_id, uint64_t *version) override;
+
+  /**
+   * @return the counters, taken under latch_, and the latencies of this instance's DiskScheduler, which cover the
+   * other instances sharing it as well
+   */
+  BufferPoolMetrics GetMetricsImpl() override;
+
+  /**
+   * Create a partition; see BufferPoolManager::CreatePartition. The minimums are checked against the current
+   * pool_size_ only: after a shrink, they may add up to more than the pool, and a partition below its minimum may then
+   * find nothing to evict.
+   * @return the partition, nullptr if the name is empty or taken, or the quota is not valid
+   */
+  BufferPoolManager *CreatePartitionImpl(const std::string &name, size_t min_frames, size_t max_frames) override;
+
+  /** @return the partitions' quotas and counters, taken under latch_ */
+  std::vector<BufferPoolPartitionMetrics> GetPartitionMetricsImpl() override;
+
+  /**
+   * Add a partition without checking its quota, for CreatePartitionImpl and for a parallel BPM that checked it across
+   * its instances. Caller must hold latch_.
+   * @return the id of the new partition
+   */
+  partition_id_t AddPartition(const std::string &name, size_t min_frames, size_t max_frames);
+
+  /** Append a frame to free_list_. Caller must hold latch_. */
+  void PushFreeFrame(frame_id_t frame_id);
+
+  /** Take the frame at the front of free_list_, which must not be empty. Caller must hold latch_. */
+  frame_id_t PopFreeFrame();
+
+  /**
+   * Allocate a page on disk. Caller must hold latch_.
+   * Page ids are striped over the instances of a parallel BPM so that page_id % num_instances_ == instance_index_.
+   * @return the id of the allocated page
+   */
+  page_id_t AllocatePage();
+
+  /**
+   * Deallocate a page on disk. Caller must hold latch_.
+   * @param page_id id of the page to deallocate
+   */
+  void DeallocatePage(__attribute__((unused)) page_id_t page_id) {
+    // This is a no-nop right now without a more complex data structure to track deallocated pages
+  }
+
+  /**
+   * @param db_file the database file, which may hold pages already
+   * @return the first page id of this instance past the end of the file, where AllocatePage starts
+   */
+  page_id_t FirstFreePageId(const std::string &db_file) const;
+
+  /**
+   * Validate that the page_id being used is accessible to this BPI. This can be used in all of the functions to
+   * validate input data and ensure that a parallel BPM is routing requests to the correct BPI
+   * @param page_id
+   */
+  void ValidatePageId(page_id_t page_id) const;
+
+  /**
+   * Write the page held by a frame back to disk, clear its dirty flag and count it in metrics_.flushes_. A page still
+   * being read in is not written. Caller must hold latch_.
+   * @param frame_id frame holding the page
+   * @return false if the write failed; the page stays dirty
+   */
+  bool FlushFrame(frame_id_t frame_id);
+
+  /**
+   * Get a frame for a new page, from the free list or else from the replacer. A victim's page is written back if it
+   * is dirty and taken out of the page table. The frame is charged to the partition. A partition at its maximum
+   * replaces one of its own pages even if there are free frames; otherwise the victim is one of its own pages or a
+   * page of a partition over its minimum. A victim whose page cannot be written back is passed over and stays
+   * resident. Caller must hold latch_.
+   * @param[out] frame_id the frame
+   * @param partition the partition the frame is for
+   * @return false if every frame the partition may take is pinned or cannot be written back
+   */
+  bool TakeFrame(frame_id_t *frame_id, partition_id_t partition);
+
+  /**
+   * Write the frame's page back if it is dirty, hand it to the compressed and spill tiers, if any, and take it out of
+   * the page table. The frame must not be pinned. Caller must hold latch_.
+   * @param frame_id the frame
+   * @return false if the page was dirty and could not be written back yet, or at all, or the cleaner is still writing
+   * it; it is then left as it was, resident
+   */
+  bool EvictFrame(frame_id_t frame_id);
+
+  /**
+   * Return a frame whose page is gone to the free list, or, if the pool has shrunk below it, its memory to the
+   * kernel. Caller must hold latch_.
+   */
+  void FreeFrame(frame_id_t frame_id);
+
+  /**
+   * Evict the page of an unpinned frame the pool has shrunk below and FreeFrame it. If the page cannot be written back,
+   * the frame goes to the replacer instead, and TakeFrame retires it once it can evict it. Caller must hold latch_.
+   */
+  void RetireFrame(frame_id_t frame_id);
+
+  /**
+   * Drop one pin of a frame; at the last one, the frame becomes evictable, or is retired if the pool has shrunk below
+   * it. With replacer_unlatched_, latch_ may be released before the replacer hears of it.
+   * @param latch the caller's lock on latch_, which must be held
+   * @param frame_id the frame, which must be pinned
+   * @param is_dirty true if the page should be marked as dirty
+   * @param access_type hint passed on to the replacer
+   */
+  void UnpinFrame(std::unique_lock<std::mutex> *latch, frame_id_t frame_id, bool is_dirty, AccessType access_type);
+
+  /** Recompute the cleaner watermarks from pool_size_. */
+  void SetCleanerWatermarks();
+
+  /**
+   * Schedule the read of the page the frame has been assigned, and mark the frame as I/O in progress. A page in the
+   * compressed tier is taken out of it instead and left for RunTierWork to decompress; a page in the spill tier is
+   * read from there instead of from the database file. The frame must be pinned until FinishRead. Caller must hold
+   * latch_, and must call RunTierWork before it waits for the read or returns.
+   * @param frame_id the frame
+   * @return the read, to be waited on with latch_ released
+   */
+  std::shared_future<bool> StartRead(frame_id_t frame_id);
+
+  /**
+   * Do the compressed tier's work queued under latch_ with the latch released: decompress the pages StartRead took
+   * out of the tier into their frames, and compress the copies EvictFrame made of the pages it evicted. The latter go
+   * into the tier unless the page has been fetched, evicted again or deleted since. Pages that do not compress well
+   * enough, and the ones the tier drops to make room, go on to the spill tier, if any.
+   * @param latch the caller's lock on latch_, held again on return
+   */
+  void RunTierWork(std::unique_lock<std::mutex> *latch);
+
+  /** Hand a clean page that is not in the pool to the spill tier, if there is one. Caller must hold latch_. */
+  void SpillPage(page_id_t page_id, const char *data);
+
+  /**
+   * If the frame's read has completed, clear its I/O in progress flag and drop a prefetch's pin. A failed read takes
+   * the page out of the page table. Does nothing otherwise, so it is safe to call by everyone who waited for the read.
+   * Caller must hold latch_.
+   * @param frame_id the frame
+   */
+  void FinishRead(frame_id_t frame_id);
+
+  /**
+   * Prefetch one page, charged to the partition. Caller must hold latch_.
+   * @return true if the page is resident and readable already
+   */
+  bool StartPrefetch(page_id_t page_id, AccessType access_type, partition_id_t partition);
+
+  /**
+   * Take a frame for a prefetch of the page, charged to the partition, and set it up for the read: in the page table,
+   * pinned by the prefetch and in prefetching_. The page must not be resident. Caller must hold latch_.
+   * @param page_id the page to read in
+   * @param access_type hint passed on to the replacer
+   * @param partition the partition to charge the page to
+   * @param[out] frame_id the frame
+   * @return false if there is no frame to take
+   */
+  bool TakePrefetchFrame(page_id_t page_id, AccessType access_type, partition_id_t partition, frame_id_t *frame_id);
+
+  /** FinishRead every prefetch whose read has completed, so its frame can be evicted again. Caller must hold latch_. */
+  void ReapPrefetches();
+
+  /**
+   * Wait, with latch_ released, until one of the prefetches in progress has completed, and reap it.
+   * @param latch the caller's lock on latch_
+   * @return false if there was no prefetch in progress
+   */
+  bool WaitForPrefetch(std::unique_lock<std::mutex> *latch);
+
+  /**
+   * Wait until the cleaner is done writing the frame's contents. Must be called before a frame's page is written back,
+   * otherwise the cleaner's older copy could land on disk after a newer one. latch_ is released while waiting, so
+   * anything may have happened to the frame by the time this returns true: the caller must look it up again.
+   * @param latch the caller's lock on latch_
+   * @param frame_id the frame
+   * @return true if the cleaner was writing the frame and we waited
+   */
+  bool WaitForCleaner(std::unique_lock<std::mutex> *latch, frame_id_t frame_id);
+
+  /**
+   * Wait until the cleaner settles a write-back batch, for callers that found no victim because EvictFrame skipped the
+   * frames being written. latch_ is released while waiting.
+   * @param latch the caller's lock on latch_
+   * @return false if no batch was in flight
+   */
+  bool WaitForCleanerBatch(std::unique_lock<std::mutex> *latch);
+
+  /**
+   * Settle the last write-back batch once it is on disk: its frames leave cleaner_writing_, and those whose write
+   * failed are marked dirty again. Frames settled already are skipped, so the batch's writer and the next batch may
+   * both call it. Wakes up the threads in WaitForCleaner. Caller must hold latch_, and the batch must be complete: the
+   * caller holds cleaner_io_latch_ or wrote the batch.
+   */
+  void FinishCleanerWrites();
+
+  /**
+   * Write-ahead logging: make sure the log is on disk up to lsn before a page with that LSN is written. Pages that
+   * hold no LSN yield a made-up one, which at worst forces the whole log.
+   * @param lsn the highest LSN of the pages about to be written
+   * @return true if there is a log manager and it had to write the log first
+   */
+  bool ForceLog(lsn_t lsn);
+
+  /** @return true if there is no log manager, or the log is on disk up to lsn already */
+  bool LogIsFlushed(lsn_t lsn);
+
+  /**
+   * ForceLog for a caller that holds latch_, which is released while the log is written. Anything may have happened to
+   * the caller's frames by the time this returns true, so it must look at them again.
+   * @param latch the caller's lock on latch_
+   * @param lsn the highest LSN of the pages about to be written
+   * @return false if the log was on disk up to lsn already, and latch_ was held throughout
+   */
+  bool ForceLog(std::unique_lock<std::mutex> *latch, lsn_t lsn);
+
+  /**
+   * Force the log up to the pages EvictFrame passed over because their LSN was not on disk yet, for callers that found
+   * no other victim. latch_ is released while the log is written.
+   * @param latch the caller's lock on latch_
+   * @return false if no page was passed over for the log
+   */
+  bool ForceEvictionLog(std::unique_lock<std::mutex> *latch);
+
+  /** Body of the cleaner thread: run a CleanRound every cleaner_interval_ms_ until the instance is destroyed. */
+  void CleanerLoop();
+
+  /**
+   * Write back dirty frames that are next in line for eviction, if the free and clean ones are below the low
+   * watermark. The frames are copied and marked clean under latch_, which is released while the copies are written.
+   * @param latch the caller's lock on latch_
+   * @return the number of pages written
+   */
+  size_t CleanRound(std::unique_lock<std::mutex> *latch);
+
+  /**
+   * Write back a batch of dirty, unpinned frames, at most options_.cleaner_max_writes_ of them. The frames are copied
+   * and marked clean under latch_, which is released while the copies are written; a page whose write fails is marked
+   * dirty again. Used by the cleaner and by a shrinking Resize.
+   * @param latch the caller's lock on latch_
+   * @param frames the frames to write back; clean and pinned ones are skipped
+   * @return the number of pages written
+   */
+  size_t WriteBackFrames(std::unique_lock<std::mutex> *latch, const std::vector<frame_id_t> &frames);
+
+  /**
+   * @param file a file name from options_
+   * @return the file of this instance: the name itself, or in a parallel pool, the name with the instance's index
+   * inserted before the extension, e.g. spill.db becomes spill.0.db, spill.1.db, ...
+   */
+  std::string InstanceFile(const std::string &file) const;
+
+  /**
+   * Read back the pages listed in warm_file_ by an earlier instance, as prefetches, before any traffic arrives. The
+   * first pool_size_ ids of this instance, i.e. the hottest, are sorted, and each run of consecutive ids is read with
+   * one vectored read of up to options_.warm_max_run_pages_ pages. All the reads are scheduled at once, so the
+   * scheduler's I/O threads work on them in parallel; fetches of a page still being read wait for its read as for any
+   * prefetch. The pages are charged to the default partition. The replacer ranks them in the order their reads
+   * complete, until use ranks them again. A missing or malformed file is a cold start.
+   */
+  void LoadWarmSet();
+
+  /** Body of the warm saver thread: SaveWarmSet every warm_save_interval_ms_ until the instance is destroyed. */
+  void WarmSaverLoop();
+
+  /** Number of pages in the buffer pool. Changed by Resize under latch_; read without it by GetPoolSize. */
+  std::atomic<size_t> pool_size_;
+  /** Number of frames reserved, i.e. the largest pool_size_. */
+  const size_t max_pool_size_;
+  /** How many instances are in the parallel BPM (if present, otherwise just 1 BPI) */
+  const uint32_t num_instances_ = 1;
+  /** Index of this BPI in the parallel BPM (if present, otherwise just 0) */
+  const uint32_t instance_index_ = 0;
+  /**
+   * Each BPI maintains its own counter for page_ids to hand out, must ensure they mod back to its instance_index_.
+   * Starts past the end of options_.db_file_, if set.
+   */
+  page_id_t next_page_id_ = instance_index_;
+
+  /** Memory of the frames; pages_[i] holds frame i of the arena. */
+  FrameArena arena_;
+  /** Array of buffer pool pages, max_pool_size_ of them; only the first pool_size_ are handed out. */
+  Page *pages_;
+  /** Pointer to the disk manager. - read writte pages from disk, given */
+  DiskManager *disk_manager_ __attribute__((__unused__));
+  /** Pointer to the log manager, nullptr if logging is disabled. */
+  LogManager *log_manager_;
+  /** Carries out all disk reads and writes of this instance. */
+  DiskScheduler *disk_scheduler_;
+  /** disk_scheduler_ is this instance's own, not shared with the other instances of a parallel pool. */
+  bool owns_disk_scheduler_;
+  /** Page table for keeping track of buffer pool pages. - hash table pageid -> frameid, sized from max_pool_size_ */
+  PageTable page_table_;
+  /** Replacer to find unpinned pages for replacement. */
+  // BPM needs access to the replace class because it needs to find a page where I can copy a disk page to
+  // this is part A of project 1 (LRU Replacer)
+  Replacer *replacer_;
+  /**
+   * The replacer is a BatchedReplacer, which tolerates accesses arriving out of order: fetch hits and unpins then call
+   * it after releasing latch_, so that committing a batch does not hold up the buffer pool.
+   */
+  bool replacer_unlatched_{false};
+  // look here for free pages in BPM, else go to replacer/LRU
+  /** List of free pages. */
+  std::list<frame_id_t> free_list_;
+  /** Position of each frame in free_list_, if in_free_list_, so that a shrink takes out its frames in O(1) each. */
+  std::vector<std::list<frame_id_t>::iterator> free_list_pos_;
+  std::vector<bool> in_free_list_;
+  /** Second tier for evicted pages, only if options_.compressed_cache_bytes_ is non-zero. Protected by latch_. */
+  CompressedPageCache *compressed_cache_{nullptr};
+  /** A clean page EvictFrame copied for the compressed tier, compressed by RunTierWork. */
+  struct PendingCompression {
+    page_id_t page_id_;
+    /** Only the page's latest eviction, the one in compress_tickets_, goes into the tier. */
+    uint64_t ticket_;
+    std::string data_;
+    /** data_ compressed, filled in by RunTierWork; data_ is kept for the spill tier in case the tier turns it down. */
+    std::string compressed_;
+  };
+  /** A page StartRead took out of the compressed tier, decompressed into its frame by RunTierWork. */
+  struct PendingDecompression {
+    frame_id_t frame_id_;
+    page_id_t page_id_;
+    std::string compressed_;
+    std::promise<bool> done_;
+  };
+  /** Most evicted pages waiting to be compressed; beyond that, the oldest are left out of the tier. */
+  static constexpr size_t MAX_PENDING_COMPRESSIONS = 64;
+  /** Compressed tier work for RunTierWork. Protected by latch_. */
+  std::vector<PendingCompression> compressions_;
+  std::vector<PendingDecompression> decompressions_;
+  /** compress_tickets_[page_id]: the ticket of the page's pending compression. Protected by latch_. */
+  std::unordered_map<page_id_t, uint64_t> compress_tickets_;
+  uint64_t next_compress_ticket_{0};
+  /** Tier on local storage for evicted pages, only if options_.spill_file_ is set. */
+  SpillCache *spill_cache_{nullptr};
+  /**
+   * Protects page_table_, free_list_, replacer_, next_page_id_ and the book-keeping fields (page id, pin count, dirty
+   * flag) of every page in pages_. Page contents are protected by the page latches, not by this latch.
+   */
+  std::mutex latch_;
+  /** Serializes Resize calls, taken before latch_: a shrink releases latch_ while it writes back. */
+  std::mutex resize_latch_;
+  /** Highest LSN of a page EvictFrame passed over because the log was not on disk up to it. Protected by latch_. */
+  lsn_t evict_log_lsn_{INVALID_LSN};
+
+  /**
+   * io_in_progress_[frame_id]: the frame's page is being read in with latch_ released. The frame is already in the
+   * page table and pinned; other fetches of the page wait on io_reads_[frame_id] instead of reading it a second time.
+   */
+  std::vector<bool> io_in_progress_;
+  /** io_reads_[frame_id]: the read in progress, if any. */
+  std::vector<std::shared_future<bool>> io_reads_;
+  /** io_prefetch_[frame_id]: the read in progress was started by a prefetch, which holds the frame's pin. */
+  std::vector<bool> io_prefetch_;
+  /** Frames with a prefetch read in progress, and possibly some that are finished already; see ReapPrefetches. */
+  std::vector<frame_id_t> prefetching_;
+  /** Counters for GetMetrics, protected by latch_; the latency histograms are kept by disk_scheduler_. */
+  BufferPoolMetrics metrics_;
+  /**
+   * Quota and counters of each partition, indexed by partition id, DEFAULT_PARTITION first. Protected by latch_; only
+   * ever grows, so partition ids stay valid.
+   */
+  std::vector<BufferPoolPartitionMetrics> partitions_;
+  /** frame_partition_[frame_id]: the partition the frame's page is charged to, while it holds one. */
+  std::vector<partition_id_t> frame_partition_;
+  /** The partitions handed out by CreatePartition, owned by the instance; partition_views_[i] is partition i + 1. */
+  std::vector<BufferPoolPartition *> partition_views_;
+
+  /** Background page cleaner, only started if options_.cleaner_interval_ms_ is non-zero. */
+  std::thread cleaner_thread_;
+  /** Wakes the cleaner up early on shutdown; waited on with latch_. */
+  std::condition_variable cleaner_cv_;
+  /** Set under latch_ to stop the cleaner. */
+  bool cleaner_stop_{false};
+  /** Cleaner watermarks converted from fractions of the pool to frame counts. */
+  size_t cleaner_low_frames_{0};
+  size_t cleaner_high_frames_{0};
+  /**
+   * Held by WriteBackFrames, for the cleaner or a shrinking Resize, from the moment it copies a batch of frames until
+   * the copies are on disk. Never waited for with latch_ held: taken by the cleaner and Resize alone, before latch_.
+   */
+  std::mutex cleaner_io_latch_;
+  /** cleaner_writing_[frame_id]: the frame is in the current write-back batch. Protected by latch_. */
+  std::vector<bool> cleaner_writing_;
+  /** Counts the write-back batches, so a batch's writer knows whether the next batch settled it already. */
+  uint64_t cleaner_batch_{0};
+  /** Signalled by FinishCleanerWrites when it settles frames; waited on with latch_. */
+  std::condition_variable cleaner_settled_cv_;
+  /** Frames set in cleaner_writing_, and the number of times FinishCleanerWrites settled any. Protected by latch_. */
+  size_t cleaner_unsettled_{0};
+  uint64_t cleaner_settles_{0};
+  /**
+   * Write-back scratch space: the cleaner's candidates, then the copies and (frame, page) being written, changed only
+   * by the thread holding cleaner_io_latch_. The copies are page aligned like the frames, for direct I/O.
+   * cleaner_writes_ is changed under latch_ only, so FinishCleanerWrites may read it from other threads.
+   */
+  std::vector<frame_id_t> cleaner_candidates_;
+  FrameArena cleaner_buffer_;
+  std::vector<std::pair<frame_id_t, page_id_t>> cleaner_writes_;
+  /**
+   * cleaner_write_ok_[i]: whether cleaner_writes_[i] reached disk. Filled in by the cleaner before it releases
+   * cleaner_io_latch_, read by FinishCleanerWrites.
+   */
+  std::vector<bool> cleaner_write_ok_;
+  /** options_.warm_file_ of this instance, see InstanceFile; empty without warm restart. */
+  std::string warm_file_;
+  /** Serializes the writes of warm_file_; never held with latch_. */
+  std::mutex warm_file_latch_;
+  /** Periodic SaveWarmSet, only started if options_.warm_save_interval_ms_ is non-zero. */
+  std::thread warm_saver_thread_;
+  /** Wakes the warm saver up early on shutdown; waited on with latch_. */
+  std::condition_variable warm_saver_cv_;
+  /** Set under latch_ to stop the warm saver. */
+  bool warm_saver_stop_{false};
+  /** Options the instance was created with. */
+  const BufferPoolOptions options_;
+};
+}  // namespace bustub
@@ -0,0 +1,121 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_metrics.h
+//
+// Identification: src/include/buffer/buffer_pool_metrics.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "storage/disk/latency_histogram.h"
+
+namespace bustub {
+
+/**
+ * What a buffer pool has done since it was created, for sizing pools and for debugging latency. The counters are
+ * kept under the buffer pool latch the operations hold anyway, so they cost no more than an increment each.
+ *
+ * BufferPoolManager::GetMetrics returns a snapshot; the snapshots of a ParallelBufferPoolManager are summed over its
+ * instances.
+ */
+struct BufferPoolMetrics {
+  /** FetchPage calls that found the page resident, or being read in by someone else. */
+  uint64_t fetch_hits_{0};
+  /** FetchPage calls that had to read the page from disk, whether or not the read succeeded. */
+  uint64_t fetch_misses_{0};
+  /** FetchPage calls that returned nullptr: every frame pinned, or the read failed. */
+  uint64_t fetch_failures_{0};
+  /** NewPage calls that created a page. */
+  uint64_t new_pages_{0};
+  /** NewPage calls that returned nullptr because every frame was pinned. */
+  uint64_t new_page_failures_{0};
+  /** Pages evicted that were clean. */
+  uint64_t evictions_clean_{0};
+  /** Pages evicted that had to be written back first, i.e. a write on the path of a fetch or new page. */
+  uint64_t evictions_dirty_{0};
+  /** Pages written by FlushPage and FlushAllPages, one per page however many a vectored write carries. */
+  uint64_t flushes_{0};
+  /** Page write-backs that failed; the pages stay dirty and resident. */
+  uint64_t write_failures_{0};
+  /** Pages written ahead of eviction by the background cleaner. */
+  uint64_t cleaner_writes_{0};
+  /** Pages written back in batches by a Resize that shrank the pool. */
+  uint64_t resize_writes_{0};
+  /** Pages deleted. */
+  uint64_t deletes_{0};
+  /** Prefetch reads started. */
+  uint64_t prefetches_{0};
+  /** Evicted pages kept in the compressed tier. */
+  uint64_t compressed_inserts_{0};
+  /** Fetch misses and prefetches served from the compressed tier instead of disk. */
+  uint64_t compressed_hits_{0};
+  /** Evicted pages written to the spill tier. */
+  uint64_t spill_writes_{0};
+  /** Fetch misses and prefetches served from the spill tier instead of the database file. */
+  uint64_t spill_hits_{0};
+  /** Page writes, or batches of them, that had to wait for the log to reach disk up to the pages' LSN first. */
+  uint64_t log_forces_{0};
+  /** Pages read back in at startup from the warm restart file. */
+  uint64_t warm_loads_{0};
+  /** Latency of the page reads from the database file, from scheduling to completion. */
+  LatencyHistogram read_latency_;
+  /** Latency of the page writes, from scheduling to completion; a coalesced flush run counts once. */
+  LatencyHistogram write_latency_;
+  /** Latency of the page reads from the spill tier, from scheduling to completion. */
+  LatencyHistogram spill_read_latency_;
+
+  /** Add another snapshot to this one, e.g. to sum over the instances of a parallel buffer pool. */
+  BufferPoolMetrics &operator+=(const BufferPoolMetrics &other);
+
+  /** @return fetch hits over all fetches that did not fail, 0 if there were none */
+  double HitRatio() const;
+
+  /** @return one "name value" line per counter and one line per histogram, for logs and consoles */
+  std::string ToString() const;
+
+  /** @return a JSON object with every counter and every histogram */
+  std::string ToJson() const;
+};
+
+/**
+ * The quota and usage of one partition of a buffer pool; see BufferPoolManager::CreatePartition. Kept under the buffer
+ * pool latch like BufferPoolMetrics. The entries of a ParallelBufferPoolManager, quotas included, are summed over its
+ * instances.
+ */
+struct BufferPoolPartitionMetrics {
+  std::string name_;
+  /** Frames below which the partition's pages are not evicted for another partition's. */
+  size_t min_frames_{0};
+  /** Frames above which the partition replaces its own pages instead of taking more. */
+  size_t max_frames_{0};
+  /** Frames holding a page charged to the partition right now. */
+  size_t frames_{0};
+  /** Fetches through the partition that found the page resident, whichever partition it is charged to. */
+  uint64_t fetch_hits_{0};
+  /** Fetches through the partition that had to read the page in. */
+  uint64_t fetch_misses_{0};
+  /** Pages created through the partition. */
+  uint64_t new_pages_{0};
+  /** Fetches and new pages through the partition that returned nullptr. */
+  uint64_t failures_{0};
+  /** Pages of the partition evicted to make room for another page. */
+  uint64_t evictions_{0};
+  /** Of those, the ones evicted to make room for a page of another partition. */
+  uint64_t evictions_by_others_{0};
+
+  /** Add another instance's entry for the same partition to this one. */
+  BufferPoolPartitionMetrics &operator+=(const BufferPoolPartitionMetrics &other);
+
+  /** @return the name followed by "name value" pairs on one line, for logs and consoles */
+  std::string ToString() const;
+};
+
+}  // namespace bustub
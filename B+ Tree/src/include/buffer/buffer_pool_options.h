@@ -0,0 +1,120 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_options.h
+//
+// Identification: src/include/buffer/buffer_pool_options.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "buffer/frame_arena.h"
+#include "buffer/lru_k_replacer.h"
+#include "storage/disk/disk_scheduler.h"
+
+namespace bustub {
+
+/** Page replacement policy used by a BufferPoolManager. */
+enum class ReplacerPolicy { LRU, CLOCK, LRU_K, ARC };
+
+/**
+ * Tuning knobs for a BufferPoolManager. The defaults reproduce the original behavior.
+ */
+struct BufferPoolOptions {
+  /** Which Replacer implementation picks victim frames. */
+  ReplacerPolicy replacer_policy_{ReplacerPolicy::LRU};
+  /** LRU_K only: number of references remembered per frame. */
+  size_t lru_k_{LRUKReplacer::DEFAULT_K};
+  /** LRU_K only: references closer than this many accesses to the previous one count as one. */
+  uint64_t lru_k_correlated_window_{LRUKReplacer::DEFAULT_CORRELATED_WINDOW};
+  /**
+   * If non-zero, the replacer is wrapped in a BatchedReplacer that buffers this many accesses per thread before
+   * committing them, and fetch hits and unpins reach it after the buffer pool latch is released, so concurrent hits
+   * do not serialize on the replacer lock. 0 = every access goes straight in, under the buffer pool latch.
+   */
+  size_t replacer_batch_size_{0};
+
+  /**
+   * Largest size the pool can be Resized to, in frames, 0 = the size it is created with. Address space and page
+   * book-keeping are reserved for this many frames up front; memory is only used for the frames actually in the pool.
+   */
+  size_t max_pool_size_{0};
+
+  /** Huge pages for the frame arena. Pools smaller than one huge page always use regular pages. */
+  HugePagePolicy huge_pages_{HugePagePolicy::TRANSPARENT};
+  /** Number of threads pre-faulting the frame arena at startup, 0 = one per hardware thread. */
+  size_t prefault_threads_{0};
+
+  /**
+   * The DiskManager's database file. If it holds pages already, i.e. when a database is reopened, new page ids start
+   * past its end instead of at 0, so NewPage never hands out the id of a page on disk. Empty = a new database.
+   */
+  std::string db_file_;
+
+  /** Number of disk requests the buffer pool's DiskScheduler carries out at the same time. */
+  size_t io_queue_depth_{DiskScheduler::DEFAULT_QUEUE_DEPTH};
+  /**
+   * Read and write db_file_ with O_DIRECT, so its pages are not cached by the OS as well (see DiskScheduler). Pages are
+   * cached once, in the pool, which should be sized to take the memory the OS page cache would otherwise have used.
+   * Needs db_file_; otherwise, or if the file system refuses O_DIRECT, I/O is buffered through the DiskManager.
+   */
+  bool direct_io_{false};
+  /** FlushAllPages: most pages with consecutive ids written by one vectored write. */
+  size_t flush_max_run_pages_{64};
+
+  /**
+   * If non-zero, evicted pages are kept compressed in a CompressedPageCache of this many bytes, per instance of a
+   * parallel pool, and fetching them again reads them from there instead of from disk. 0 = no compressed tier.
+   */
+  size_t compressed_cache_bytes_{0};
+  /**
+   * If set, evicted pages are also written to a SpillCache in this file, meant to be on local storage faster than the
+   * database file's, and misses read them from there. With a compressed tier too, only the pages it turns down or
+   * drops are. Like the database file, it is a DiskManager file, so it needs an extension and a name of its own up to
+   * it, e.g. spill.db. Instances of a parallel pool insert their index before the extension: spill.0.db, spill.1.db,
+   * ...
+   */
+  std::string spill_file_;
+  /** Spill cache: number of pages the file holds, per instance of a parallel pool. 0 = no spill cache. */
+  size_t spill_capacity_pages_{0};
+
+  /**
+   * If non-zero, a background cleaner thread wakes up this often and writes back dirty frames that are next in line
+   * for eviction, so that FetchPage / NewPage find a clean victim instead of writing one out first. 0 = no cleaner.
+   */
+  uint32_t cleaner_interval_ms_{0};
+  /**
+   * Cleaner: a round only writes if fewer than this fraction of the frames can be evicted without a write, counting
+   * the free frames and the clean frames next in line up to the first dirty one.
+   */
+  double cleaner_low_watermark_{0.05};
+  /** Cleaner: a round writes back the dirty frames among the coldest this fraction of the frames. */
+  double cleaner_high_watermark_{0.10};
+  /**
+   * Cleaner: at most this many writes per round, i.e. per cleaner_interval_ms_. Caps the cleaner's I/O rate. Also the
+   * batch size in which a shrinking Resize writes back the pages it evicts, with at least 1.
+   */
+  size_t cleaner_max_writes_{32};
+
+  /**
+   * If set, the ids of the resident pages are saved to this file, hottest first, when the pool is destroyed, and a
+   * pool created with the file reads those pages back in right away, so that it does not have to warm up one miss at
+   * a time. Instances of a parallel pool insert their index before the extension, as with spill_file_: warm.0.ids,
+   * warm.1.ids, ... A restart reopens the database, so set db_file_ as well. Empty = no warm restart.
+   */
+  std::string warm_file_;
+  /** Warm restart: if non-zero, the resident pages are also saved this often, for a restart after a crash. */
+  uint32_t warm_save_interval_ms_{0};
+  /** Warm restart: most pages with consecutive ids read back by one vectored read. */
+  size_t warm_max_run_pages_{64};
+};
+
+}  // namespace bustub
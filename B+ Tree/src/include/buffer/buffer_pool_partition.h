@@ -0,0 +1,91 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_partition.h
+//
+// Identification: src/include/buffer/buffer_pool_partition.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+
+namespace bustub {
+
+/**
+ * BufferPoolPartition is a partition of a buffer pool, as handed out by BufferPoolManager::CreatePartition.
+ *
+ * It holds no pages of its own: every call goes to the pool, with the fetches, new pages and prefetches charged to the
+ * partition. Everything else, e.g. FlushAllPages, GetMetrics and Resize, acts on the whole pool. Handles it returns
+ * unpin in the pool directly.
+ */
+class BufferPoolPartition : public BufferPoolManager {
+ public:
+  /**
+   * @param pool the buffer pool, which owns the partition
+   * @param partition_id the partition in the pool
+   */
+  BufferPoolPartition(BufferPoolManager *pool, partition_id_t partition_id)
+      : pool_(pool), partition_id_(partition_id) {}
+
+  /** @return size of the whole buffer pool */
+  size_t GetPoolSize() override { return pool_->GetPoolSize(); }
+
+  /** @return the partition in the pool */
+  partition_id_t GetPartitionId() const { return partition_id_; }
+
+ protected:
+  /** Fetch through the pool; the partition argument is ignored in favor of this partition. */
+  Page *FetchPageImpl(page_id_t page_id, AccessType access_type = AccessType::NORMAL,
+                      partition_id_t partition = DEFAULT_PARTITION) override;
+
+  bool UnpinPageImpl(page_id_t page_id, bool is_dirty, AccessType access_type = AccessType::NORMAL) override;
+
+  bool FlushPageImpl(page_id_t page_id) override;
+
+  /** Create a page through the pool, charged to this partition. */
+  Page *NewPageImpl(page_id_t *page_id, partition_id_t partition = DEFAULT_PARTITION) override;
+
+  bool DeletePageImpl(page_id_t page_id) override;
+
+  void FlushAllPagesImpl(FlushStats *stats) override;
+
+  bool PrefetchPageImpl(page_id_t page_id, AccessType access_type, partition_id_t partition) override;
+
+  void PrefetchPagesImpl(const std::vector<page_id_t> &page_ids, AccessType access_type,
+                         partition_id_t partition) override;
+
+  bool ResizeImpl(size_t pool_size) override;
+
+  PageHandle FetchPageHandleImpl(page_id_t page_id, AccessType access_type, partition_id_t partition) override;
+
+  PageHandle NewPageHandleImpl(page_id_t *page_id, partition_id_t partition) override;
+
+  /** Never called: the handles are the pool's. */
+  void UnpinFrameImpl(frame_id_t frame_id, page_id_t page_id, bool is_dirty, AccessType access_type) override;
+
+  /** Never called: the handles are the pool's. */
+  void PinFrameImpl(frame_id_t frame_id, page_id_t page_id, AccessType access_type) override;
+
+  Page *PeekPageImpl(page_id_t page_id, uint64_t *version) override;
+
+  BufferPoolMetrics GetMetricsImpl() override;
+
+  /** Create a sibling partition in the pool. */
+  BufferPoolManager *CreatePartitionImpl(const std::string &name, size_t min_frames, size_t max_frames) override;
+
+  std::vector<BufferPoolPartitionMetrics> GetPartitionMetricsImpl() override;
+
+ private:
+  BufferPoolManager *pool_;
+  partition_id_t partition_id_;
+};
+
+}  // namespace bustub
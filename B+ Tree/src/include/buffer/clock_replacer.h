@@ -0,0 +1,88 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// clock_replacer.h
+//
+// Identification: src/include/buffer/clock_replacer.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * ClockReplacer implements the clock (second-chance) replacement policy, which approximates the Least Recently Used
+ * policy. All state lives in one flat byte array indexed by frame_id, so Pin and Unpin are a single store and Victim
+ * is a sequential sweep.
+ *
+ * Frames unpinned with a SCAN or ONCE hint are also queued on a small ring that Victim drains before moving the hand,
+ * so a scan recycles its own frames instead of waiting for the hand to clear the working set's reference bits. ONCE
+ * frames are queued at the head of the ring and SCAN frames at its tail. The hints only apply to pages that have had no
+ * NORMAL access since they came into their frame, as told by RecordAccess; a hot page keeps its second chance.
+ */
+class ClockReplacer : public Replacer {
+ public:
+  /**
+   * Create a new ClockReplacer.
+   * @param num_pages the maximum number of pages the ClockReplacer will be required to store
+   */
+  explicit ClockReplacer(size_t num_pages);
+
+  /**
+   * Destroys the ClockReplacer.
+   */
+  ~ClockReplacer() override;
+
+  bool VictimIf(frame_id_t *frame_id, const FrameFilter &accept) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id, AccessType access_type = AccessType::NORMAL) override;
+
+  size_t Size() override;
+
+  void RecordAccess(frame_id_t frame_id, page_id_t page_id, AccessType access_type = AccessType::NORMAL) override;
+
+  void PeekVictims(size_t max_frames, std::vector<frame_id_t> *frame_ids) override;
+
+ private:
+  /** frames_[i] is eligible to be replaced */
+  static constexpr uint8_t IN_CLOCK = 0x1;
+  /** frame_[i] was referenced since the clock hand last passed it */
+  static constexpr uint8_t REF_BIT = 0x2;
+  /** frames_[i] was unpinned with a SCAN / ONCE hint */
+  static constexpr uint8_t COLD_BIT = 0x4;
+  /** frames_[i] has an entry in cold_ring_ (which may be stale) */
+  static constexpr uint8_t QUEUED_BIT = 0x8;
+  /** frames_[i] holds a page that had a NORMAL access since it came into the frame */
+  static constexpr uint8_t HOT_BIT = 0x10;
+
+  /** Per-frame IN_CLOCK / REF_BIT / COLD_BIT / QUEUED_BIT / HOT_BIT flags. */
+  std::vector<uint8_t> frames_;
+  /** The page RecordAccess last saw in each frame. */
+  std::vector<page_id_t> frame_page_;
+  /**
+   * Cold frames, drained from cold_head_: SCAN frames are appended, ONCE frames pushed in front. Each frame is queued
+   * at most once, so num_pages slots are enough; a frame re-unpinned while its entry is still queued keeps that entry.
+   */
+  std::vector<frame_id_t> cold_ring_;
+  size_t cold_head_;
+  size_t cold_count_;
+  /** Position of the clock hand. */
+  size_t hand_;
+  /** Number of frames with IN_CLOCK set. */
+  size_t size_;
+  size_t num_pages_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,130 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache.h
+//
+// Identification: src/include/buffer/compressed_page_cache.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * CompressedPageCache is a second tier below a buffer pool: it keeps pages evicted from the pool in compressed form,
+ * so that fetching one of them again costs a decompression instead of a disk read.
+ *
+ * The cache only holds pages that are clean, i.e. that match their copy on disk; the buffer pool writes a dirty page
+ * back before it hands it over. It is exclusive: Take removes the page, which from then on lives in the buffer pool
+ * again. The compressed pages take at most capacity bytes; when a new page does not fit, the least recently inserted
+ * pages are dropped, which costs nothing as they are on disk. Pages that do not compress to at most
+ * MAX_COMPRESSED_SIZE are not kept at all.
+ *
+ * The compressor is a byte-oriented LZ77 in the spirit of LZ4: a 4096-entry hash table of 4-byte sequences finds
+ * earlier occurrences, and a page is stored as literal runs and back-references with varint lengths. B+ tree pages
+ * compress well with it: the free space of a page is zeros, and sorted keys and record ids repeat their high bytes
+ * (mostly zeros as well) from one entry to the next.
+ *
+ * Not thread safe; the buffer pool latch protects it.
+ */
+class CompressedPageCache {
+ public:
+  /** Pages that compress to more than this are not worth keeping. */
+  static constexpr size_t MAX_COMPRESSED_SIZE = PAGE_SIZE * 3 / 4;
+
+  /** A page dropped to make room for another, still compressed. */
+  using DroppedPage = std::pair<page_id_t, std::string>;
+
+  /**
+   * Create a new CompressedPageCache.
+   * @param capacity the most bytes of compressed pages to keep
+   */
+  explicit CompressedPageCache(size_t capacity);
+
+  /**
+   * Keep a clean page, replacing an older copy of it, if any.
+   * @param page_id the page
+   * @param data the page's PAGE_SIZE bytes
+   * @return true if the page was kept, false if it did not compress well enough
+   */
+  bool Insert(page_id_t page_id, const char *data);
+
+  /**
+   * Keep a page compressed by Compress, e.g. without the caller's latch, replacing an older copy of it, if any.
+   * @param page_id the page
+   * @param compressed the compressed page
+   * @param[out] dropped if not nullptr, gets the pages dropped to make room, e.g. to pass them on to another tier
+   * @return true if the page was kept, false if it did not compress well enough
+   */
+  bool Insert(page_id_t page_id, std::string compressed, std::vector<DroppedPage> *dropped = nullptr);
+
+  /**
+   * Move a page out of the cache.
+   * @param page_id the page
+   * @param[out] data PAGE_SIZE bytes to decompress the page into
+   * @return true if the page was in the cache; it no longer is either way
+   */
+  bool Take(page_id_t page_id, char *data);
+
+  /**
+   * Move a page out of the cache without decompressing it, e.g. to decompress it without the caller's latch.
+   * @param page_id the page
+   * @param[out] compressed the compressed page, for Decompress
+   * @return true if the page was in the cache; it no longer is either way
+   */
+  bool Take(page_id_t page_id, std::string *compressed);
+
+  /** Forget a page, e.g. because it was deleted. */
+  void Erase(page_id_t page_id);
+
+  /** @return the number of pages kept */
+  size_t Size() const { return entries_.size(); }
+
+  /** @return the bytes of compressed pages kept */
+  size_t Bytes() const { return bytes_; }
+
+  /**
+   * Compress a page.
+   * @param data the page's PAGE_SIZE bytes
+   * @return the compressed page
+   */
+  static std::string Compress(const char *data);
+
+  /**
+   * Decompress a page compressed by Compress.
+   * @param compressed the compressed page
+   * @param[out] data PAGE_SIZE bytes to decompress into
+   * @return false if compressed is not a well-formed compressed page
+   */
+  static bool Decompress(const std::string &compressed, char *data);
+
+ private:
+  struct Entry {
+    page_id_t page_id_;
+    std::string compressed_;
+  };
+
+  /** Drop the oldest pages until bytes_ is at most target, into dropped if it is not nullptr. */
+  void Shrink(size_t target, std::vector<DroppedPage> *dropped = nullptr);
+
+  const size_t capacity_;
+  /** Bytes of compressed_ over all entries. */
+  size_t bytes_{0};
+  /** The pages kept, oldest first. */
+  std::list<Entry> entries_;
+  std::unordered_map<page_id_t, std::list<Entry>::iterator> index_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,110 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.h
+//
+// Identification: src/include/buffer/frame_arena.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/** How a FrameArena asks the kernel for huge pages. */
+enum class HugePagePolicy {
+  /** Regular pages only. */
+  NONE,
+  /** A huge page aligned mapping with madvise(MADV_HUGEPAGE); the kernel backs it with huge pages as it can. */
+  TRANSPARENT,
+  /** MAP_HUGETLB from the reserved huge page pool, falling back to TRANSPARENT if the pool is too small. */
+  EXPLICIT,
+};
+
+/**
+ * FrameArena is the memory behind the frames of a buffer pool: one anonymous mapping holding max_frames page buffers
+ * back to back. Every frame starts on a PAGE_SIZE boundary, which O_DIRECT needs, and the whole arena can be backed
+ * by 2MB huge pages so that walking a large pool does not miss the TLB on every frame.
+ *
+ * The arena is pre-faulted at construction, by several threads for large arenas, so that the first access to a frame
+ * does not take a page fault and the memory is first touched by the threads of the constructing process rather than
+ * by whichever query happens to come first. The memory starts out zeroed.
+ *
+ * The mapping covers max_frames frames, of which only the first num_frames are faulted in. A buffer pool that grows
+ * Populates more of them; one that shrinks Releases frames back to the kernel. Without explicit huge pages, frames
+ * that were never populated cost address space only.
+ */
+class FrameArena {
+ public:
+  /** Size of a huge page on x86-64. */
+  static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+  /**
+   * Map a new arena.
+   * @param max_frames the number of page buffers mapped
+   * @param num_frames the number of page buffers pre-faulted, at most max_frames
+   * @param huge_pages whether to back the arena with huge pages; ignored for arenas smaller than one huge page
+   * @param prefault_threads the number of threads that pre-fault the arena, 0 = one per hardware thread
+   * @throws Exception OUT_OF_MEMORY if the mapping fails
+   */
+  FrameArena(size_t max_frames, size_t num_frames, HugePagePolicy huge_pages, size_t prefault_threads);
+
+  /** Unmap the arena. */
+  ~FrameArena();
+
+  DISALLOW_COPY_AND_MOVE(FrameArena);
+
+  /**
+   * @param frame_id a frame
+   * @return the frame's page buffer, PAGE_SIZE bytes aligned to PAGE_SIZE
+   */
+  char *GetFrame(frame_id_t frame_id) const { return base_ + static_cast<size_t>(frame_id) * PAGE_SIZE; }
+
+  /**
+   * Fault in frames [begin, end), e.g. when the buffer pool grows.
+   * @param begin first frame
+   * @param end one past the last frame
+   */
+  void Populate(frame_id_t begin, frame_id_t end);
+
+  /**
+   * Give the memory of frames [begin, end) back to the kernel, e.g. when the buffer pool shrinks. They read as zeroes
+   * afterwards. A no-op with explicit huge pages, which can only be released a whole huge page at a time.
+   * @param begin first frame
+   * @param end one past the last frame
+   */
+  void Release(frame_id_t begin, frame_id_t end);
+
+  /** @return the size of the mapping in bytes, a multiple of the page size it is backed by */
+  size_t GetSize() const { return size_; }
+
+  /** @return the huge page policy the arena ended up with, after fallbacks */
+  HugePagePolicy GetHugePagePolicy() const { return huge_pages_; }
+
+ private:
+  /** Map size_ bytes with the given policy. @return nullptr on failure */
+  char *Map(HugePagePolicy huge_pages);
+
+  /**
+   * Touch every page [begin, end) overlaps, huge pages it only partly covers included, split over up to
+   * prefault_threads_ threads.
+   */
+  void Prefault(char *begin, char *end);
+
+  /** Start of the mapping. */
+  char *base_{nullptr};
+  /** Length of the mapping. */
+  size_t size_;
+  HugePagePolicy huge_pages_;
+  size_t prefault_threads_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,153 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.h
+//
+// Identification: src/include/buffer/lru_k_replacer.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <set>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy (O'Neil, O'Neil & Weikum, SIGMOD '93).
+ *
+ * The replacer keeps the timestamps of the last K uncorrelated references of every frame and evicts the frame whose
+ * backward K-distance (now - timestamp of its K-th most recent reference) is the largest. Frames with fewer than K
+ * references have an infinite backward K-distance and are evicted first, oldest reference first. A page touched once
+ * by a sequential scan therefore goes out before any page that was referenced K times, which keeps hot index pages
+ * resident while large range scans run.
+ *
+ * References are recorded by RecordAccess. Those that fall within the correlated reference window of the previous one
+ * (e.g. the fetch / unpin / re-fetch bursts of a single B+ tree operation) are collapsed into one reference, and a
+ * frame is not evicted while its last reference is that recent unless every candidate is. Time is measured in
+ * accesses, i.e. in calls to RecordAccess. SCAN and ONCE accesses are not references and do not advance the clock;
+ * frames unpinned with one of those hints are evicted before any other, ONCE frames first, unless their page has a
+ * reference history: a page the scan did not bring in keeps its rank.
+ *
+ * The history of an evicted page is retained, keyed by page id, for the next num_pages evictions (the paper's
+ * retained information period, counted in evictions rather than time): a page that comes back within that period
+ * picks up its K references where it left off instead of starting over as a never-seen page.
+ */
+class LRUKReplacer : public Replacer {
+ public:
+  /** Default K: LRU-2 gives most of the benefit at the lowest bookkeeping cost. */
+  static constexpr size_t DEFAULT_K = 2;
+  /** Default correlated reference window, in accesses. 0 disables correlation detection. */
+  static constexpr uint64_t DEFAULT_CORRELATED_WINDOW = 0;
+
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the maximum number of pages the LRUKReplacer will be required to store
+   * @param k number of references remembered per frame, must be >= 1 (K = 1 is plain LRU)
+   * @param correlated_window references closer than this many accesses to the previous one are correlated
+   */
+  explicit LRUKReplacer(size_t num_pages, size_t k = DEFAULT_K,
+                        uint64_t correlated_window = DEFAULT_CORRELATED_WINDOW);
+
+  /**
+   * Destroys the LRUKReplacer.
+   */
+  ~LRUKReplacer() override;
+
+  /** The evicted frame's history is retained under its page id. */
+  bool VictimIf(frame_id_t *frame_id, const FrameFilter &accept) override;
+
+  /** Removes the frame from the set of eviction candidates. */
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id, AccessType access_type = AccessType::NORMAL) override;
+
+  size_t Size() override;
+
+  /**
+   * Records a reference to the page, unless the access is a SCAN or ONCE one; a page new to the frame brings along
+   * its retained history, if any.
+   */
+  void RecordAccess(frame_id_t frame_id, page_id_t page_id, AccessType access_type = AccessType::NORMAL) override;
+
+  /** Drops the frame and its reference history. */
+  void Remove(frame_id_t frame_id) override;
+
+  void PeekVictims(size_t max_frames, std::vector<frame_id_t> *frame_ids) override;
+
+ private:
+  /** Eviction class of an unpinned frame, the first one goes first. */
+  enum class Rank : uint8_t { ONCE, SCAN, FEWER_THAN_K, K };
+
+  /**
+   * Eviction order of an unpinned frame: (rank, timestamp, frame_id). Frames with fewer than K references sort by their
+   * oldest reference, those with K by their K-th most recent reference, and ONCE / SCAN frames by the time they were
+   * unpinned. In in_window_ the key is (FEWER_THAN_K, last reference, frame_id) instead, so the frames leave the
+   * window from begin().
+   */
+  using EvictionKey = std::tuple<Rank, uint64_t, frame_id_t>;
+  using KeySet = std::set<EvictionKey>;
+
+  /** Where a frame's node is. */
+  enum class Place : uint8_t { PINNED, IN_WINDOW, EVICTABLE };
+
+  /** History of an evicted page, kept for the retained information period. */
+  struct RetainedHistory {
+    page_id_t page_id_{INVALID_PAGE_ID};
+    size_t size_{0};
+    uint64_t last_reference_{0};
+  };
+
+  EvictionKey MakeKey(frame_id_t frame_id) const;
+  /** Move the frames whose last reference has left the correlated window from in_window_ to evictable_. */
+  void ExpireWindow();
+  /** Take the frame's node out of its set, if it is in one. */
+  void MakePinned(frame_id_t frame_id);
+  /** Keep the history of the frame's page for when the page comes back, then clear it. */
+  void RetainHistory(frame_id_t frame_id);
+  void ClearHistory(frame_id_t frame_id);
+
+  size_t num_pages_;
+  size_t k_;
+  uint64_t correlated_window_;
+  /** Logical clock, advanced on every reference. */
+  uint64_t current_timestamp_{0};
+  /** history_[frame_id * k_ + i] is the (i+1)-th most recent uncorrelated reference of frame_id. */
+  std::vector<uint64_t> history_;
+  /** Number of valid entries in each frame's history. */
+  std::vector<size_t> history_size_;
+  /** Time of the last reference, correlated or not. */
+  std::vector<uint64_t> last_reference_;
+  /** The page each frame's history belongs to, INVALID_PAGE_ID if none. */
+  std::vector<page_id_t> frame_page_;
+  /** Eviction candidates, ordered so that begin() is the preferred victim. */
+  KeySet evictable_;
+  /** Unpinned frames still within the correlated window of their last reference, oldest reference first. */
+  KeySet in_window_;
+  /**
+   * Every frame owns one set node, made up front: it sits in evictable_ or in_window_ while the frame is unpinned and
+   * in nodes_ while it is pinned, so Pin and Unpin never allocate.
+   */
+  std::vector<KeySet::node_type> nodes_;
+  /** The key each unpinned frame's node carries. */
+  std::vector<EvictionKey> node_key_;
+  std::vector<Place> place_;
+  /** Ring of the histories of the last num_pages_ evicted pages; retained_history_[slot * k_ + i] as in history_. */
+  std::vector<RetainedHistory> retained_;
+  std::vector<uint64_t> retained_history_;
+  size_t next_retained_{0};
+  /** Slot in retained_ of each page whose history is retained. */
+  std::unordered_map<page_id_t, size_t> retained_index_;
+};
+
+}  // namespace bustub
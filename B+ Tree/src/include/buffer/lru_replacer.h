@@ -12,7 +12,6 @@
 
 #pragma once
 
-#include <list>
 #include <mutex>  // NOLINT
 #include <vector>
 
@@ -39,31 +38,51 @@ class LRUReplacer : public Replacer {
    */
   ~LRUReplacer() override;
 
-  // remove
-  // void printReplacer() override;
-
   // frame_id_t and page_id_t are simply aliases for 32-bit integer
-  bool Victim(frame_id_t *frame_id) override;
+  bool VictimIf(frame_id_t *frame_id, const FrameFilter &accept) override;
 
   //
   void Pin(frame_id_t frame_id) override;
 
   // unpin passes frame_id
-  void Unpin(frame_id_t frame_id) override;
+  void Unpin(frame_id_t frame_id, AccessType access_type = AccessType::NORMAL) override;
 
   size_t Size() override;
 
- private:
-  // TODO(student): implement me!
+  // remembers whether the frame's page was accessed normally, which makes Unpin ignore SCAN / ONCE hints
+  void RecordAccess(frame_id_t frame_id, page_id_t page_id, AccessType access_type = AccessType::NORMAL) override;
 
-  // You need a data structure that supports FIFO.. keeps track of frames that are eligible to be replaced
-  // will store the least recently unpinned frame
-  // I advise you use an std::list -> #include<list>
-  // std::list<frame_id_t> - initially empty
-  std::list<frame_id_t> LRU;
+  // the frame's page was deleted: take it off the list without making it a victim
+  void Remove(frame_id_t frame_id) override;
+
+  void PeekVictims(size_t max_frames, std::vector<frame_id_t> *frame_ids) override;
+
+ private:
+  // The LRU order is an intrusive doubly linked list threaded through two arrays indexed by frame_id, so
+  // Pin / Unpin / Victim are all O(1) and never allocate after construction.
+  // Slot number_pages is the sentinel: next_[sentinel] is the least recently unpinned frame (the victim),
+  // prev_[sentinel] is the most recently unpinned one.
+  // Frames unpinned with a ONCE hint sit on a second list through the same arrays, sentinel number_pages + 1,
+  // in unpin order; Victim takes them before anything on the LRU list.
+  std::vector<frame_id_t> prev_;
+  std::vector<frame_id_t> next_;
+  // in_lru_[frame_id] is true when the frame is currently eligible to be replaced
+  std::vector<bool> in_lru_;
+  // the page RecordAccess last saw in each frame, and whether it has had a NORMAL access since it came in
+  std::vector<page_id_t> frame_page_;
+  std::vector<bool> hot_;
+  // number of frames in the list
+  size_t size_;
 
   // I need a replacer variable - size varaible - num_pages 7 for test - line 33
   size_t number_pages;
+
+  frame_id_t LruSentinel() const { return static_cast<frame_id_t>(number_pages); }
+  frame_id_t OnceSentinel() const { return static_cast<frame_id_t>(number_pages + 1); }
+
+  // unlink / insert right after another frame or a sentinel; the caller checks in_lru_ first
+  void Unlink(frame_id_t frame_id);
+  void LinkAfter(frame_id_t frame_id, frame_id_t after);
 };
 
 }  // namespace bustub
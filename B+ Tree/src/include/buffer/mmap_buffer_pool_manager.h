@@ -0,0 +1,138 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// mmap_buffer_pool_manager.h
+//
+// Identification: src/include/buffer/mmap_buffer_pool_manager.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * MmapBufferPoolManager is a read-only buffer pool over a database file that does not change while it is open, e.g. a
+ * copy of an index on an analytics replica.
+ *
+ * The whole file is mapped read-only, and every page of it gets a Page whose data points straight into the mapping.
+ * FetchPage just returns that Page: there are no frames, no copies out of the file, no page table and no replacer;
+ * the kernel's page cache does the caching. Pins are not tracked, as a page never goes away while the pool exists.
+ *
+ * Everything that would change the file is rejected: IsReadOnly returns true, NewPage returns nullptr, DeletePage and
+ * Resize return false, and so do UnpinPage with is_dirty set; a PageHandle released dirty only logs a warning. Writing
+ * to a page's data faults, as the mapping is read-only, so BPlusTree::Insert and Remove check IsReadOnly and throw
+ * instead. There are no frames to partition either, so CreatePartition returns nullptr. Readers can still latch pages
+ * as usual, so BPlusTree::GetValue and IndexIterator work unchanged.
+ *
+ * The Pages take about 100 bytes per page of the file. They are allocated PAGES_PER_CHUNK at a time, by the first
+ * fetch of a page in the chunk, so a large file that is only partly read costs little more than its mapping.
+ */
+class MmapBufferPoolManager : public BufferPoolManager {
+ public:
+  /** Number of Pages allocated together, about 100 KB of them. */
+  static constexpr size_t PAGES_PER_CHUNK = 1024;
+
+  /**
+   * Map a database file.
+   * @param db_file the file, as passed to the DiskManager that wrote it
+   * @throws Exception if the file cannot be opened or mapped
+   */
+  explicit MmapBufferPoolManager(const std::string &db_file);
+
+  /** Unmaps the file. */
+  ~MmapBufferPoolManager() override;
+
+  /** @return the number of pages in the file */
+  size_t GetPoolSize() override { return num_pages_; }
+
+  /** @return true, the file is mapped read-only */
+  bool IsReadOnly() override { return true; }
+
+ protected:
+  /** @return the page, nullptr if the file has no such page */
+  Page *FetchPageImpl(page_id_t page_id, AccessType access_type = AccessType::NORMAL,
+                      partition_id_t partition = DEFAULT_PARTITION) override;
+
+  /** @return true if the page exists and is_dirty is not set */
+  bool UnpinPageImpl(page_id_t page_id, bool is_dirty, AccessType access_type = AccessType::NORMAL) override;
+
+  /** @return true if the page exists; there is never anything to write */
+  bool FlushPageImpl(page_id_t page_id) override;
+
+  /** @return nullptr, pages cannot be created */
+  Page *NewPageImpl(page_id_t *page_id, partition_id_t partition = DEFAULT_PARTITION) override;
+
+  /** @return false if the page exists, as it cannot be deleted */
+  bool DeletePageImpl(page_id_t page_id) override;
+
+  /** Nothing is ever dirty, so this writes nothing. */
+  void FlushAllPagesImpl(FlushStats *stats) override;
+
+  /**
+   * Ask the kernel to start reading the page in (madvise MADV_WILLNEED).
+   * @return false, as there is no telling whether the page is in memory yet
+   */
+  bool PrefetchPageImpl(page_id_t page_id, AccessType access_type, partition_id_t partition) override;
+
+  void PrefetchPagesImpl(const std::vector<page_id_t> &page_ids, AccessType access_type,
+                         partition_id_t partition) override;
+
+  /** @return false, the pool is the file */
+  bool ResizeImpl(size_t pool_size) override;
+
+  PageHandle FetchPageHandleImpl(page_id_t page_id, AccessType access_type, partition_id_t partition) override;
+
+  /** @return an empty handle, pages cannot be created */
+  PageHandle NewPageHandleImpl(page_id_t *page_id, partition_id_t partition) override;
+
+  /** Nothing to do; the frame of a page is its page id. */
+  void UnpinFrameImpl(frame_id_t frame_id, page_id_t page_id, bool is_dirty, AccessType access_type) override;
+
+  /** Nothing to do. */
+  void PinFrameImpl(frame_id_t frame_id, page_id_t page_id, AccessType access_type) override;
+
+  /** @return the page, which is always resident and never written */
+  Page *PeekPageImpl(page_id_t page_id, uint64_t *version) override;
+
+  /** @return the failed fetches and new pages; successful fetches do no work worth counting */
+  BufferPoolMetrics GetMetricsImpl() override;
+
+  /** @return nullptr, there are no frames to partition */
+  BufferPoolManager *CreatePartitionImpl(const std::string &name, size_t min_frames, size_t max_frames) override;
+
+  /** @return nothing, as there are no partitions */
+  std::vector<BufferPoolPartitionMetrics> GetPartitionMetricsImpl() override;
+
+ private:
+  /** @return true if the file has the page */
+  bool Contains(page_id_t page_id) const { return page_id >= 0 && static_cast<size_t>(page_id) < num_pages_; }
+
+  /**
+   * @param page_id a page of the file
+   * @return the page's Page, allocating its chunk on first use
+   */
+  Page *GetPage(page_id_t page_id);
+
+  /** The mapping of the file, nullptr if the file is empty. */
+  char *base_{nullptr};
+  /** Number of whole pages in the file; a partial page at the end is left out. */
+  size_t num_pages_{0};
+  /** chunks_[i] holds the Pages of pages [i * PAGES_PER_CHUNK, (i + 1) * PAGES_PER_CHUNK), nullptr until first used. */
+  std::vector<std::atomic<Page *>> chunks_;
+  /** Requests rejected; atomic as the pool has no latch. */
+  std::atomic<uint64_t> fetch_failures_{0};
+  std::atomic<uint64_t> new_page_failures_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,109 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_handle.h
+//
+// Identification: src/include/buffer/page_handle.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+class BufferPoolManager;
+
+/**
+ * PageHandle owns one pin on a page in the buffer pool and unpins it when it goes out of scope, so that no code path,
+ * early returns and exceptions included, can leave a frame pinned for good.
+ *
+ * The handle remembers the frame the page is in. Unpinning and pinning again go straight to that frame instead of
+ * looking the page up in the page table; the page cannot move while the handle holds its pin. MarkDirty only sets a
+ * flag on the handle, which is passed on when the pin is released.
+ *
+ * A handle is movable but not copyable; Repin makes a second handle with a pin of its own.
+ */
+class PageHandle {
+  friend class BufferPoolManagerInstance;
+  friend class MmapBufferPoolManager;
+
+ public:
+  /** An empty handle, holding no pin. */
+  PageHandle() = default;
+
+  /** Unpin the page, if the handle holds a pin. */
+  ~PageHandle() { Release(); }
+
+  PageHandle(const PageHandle &) = delete;
+  PageHandle &operator=(const PageHandle &) = delete;
+
+  PageHandle(PageHandle &&other) noexcept;
+  PageHandle &operator=(PageHandle &&other) noexcept;
+
+  /** @return true if the handle holds a pin, i.e. the fetch or new page succeeded and the pin was not released yet */
+  bool IsValid() const { return page_ != nullptr; }
+  explicit operator bool() const { return IsValid(); }
+
+  /** @return the pinned page, nullptr for an empty handle */
+  Page *GetPage() const { return page_; }
+  Page *operator->() const { return page_; }
+
+  /** @return the data of the pinned page */
+  char *GetData() const { return page_->GetData(); }
+
+  /** @return the id of the pinned page, INVALID_PAGE_ID for an empty handle */
+  page_id_t GetPageId() const { return page_id_; }
+
+  /** @return the frame the page is in, -1 for an empty handle */
+  frame_id_t GetFrameId() const { return frame_id_; }
+
+  /** Mark the page dirty; it is written back before its frame is reused. */
+  void MarkDirty() { is_dirty_ = true; }
+
+  /** @return true if MarkDirty was called on this handle */
+  bool IsDirty() const { return is_dirty_; }
+
+  /** Set the hint passed on to the replacer when the pin is released, e.g. SCAN once a page turns out to be a leaf. */
+  void SetAccessType(AccessType access_type) { access_type_ = access_type; }
+
+  /**
+   * Pin the page a second time without looking it up in the page table.
+   * @return a handle holding the new pin, an empty handle if this one is empty
+   */
+  PageHandle Repin() const;
+
+  /** Unpin the page now rather than when the handle is destroyed; the handle is empty afterwards. */
+  void Release();
+
+  /**
+   * Give up ownership of the pin without releasing it, for callers that still unpin with UnpinPage. The handle is
+   * empty afterwards.
+   * @return the page, which stays pinned
+   */
+  Page *Detach();
+
+ private:
+  PageHandle(BufferPoolManager *bpm, Page *page, frame_id_t frame_id, AccessType access_type)
+      : bpm_(bpm), page_(page), page_id_(page->GetPageId()), frame_id_(frame_id), access_type_(access_type) {}
+
+  /** Forget the pin without releasing it. */
+  void Reset();
+
+  /** The buffer pool that holds the page; for a ParallelBufferPoolManager, the instance the page belongs to. */
+  BufferPoolManager *bpm_{nullptr};
+  Page *page_{nullptr};
+  page_id_t page_id_{INVALID_PAGE_ID};
+  frame_id_t frame_id_{-1};
+  /** Passed to the replacer when the pin is released. */
+  AccessType access_type_{AccessType::NORMAL};
+  bool is_dirty_{false};
+};
+
+}  // namespace bustub
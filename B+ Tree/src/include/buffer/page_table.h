@@ -0,0 +1,98 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.h
+//
+// Identification: src/include/buffer/page_table.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * PageTable maps the page ids resident in a buffer pool to their frames.
+ *
+ * It is a flat open-addressing hash table with linear probing. All slots are allocated up front: a buffer pool never
+ * holds more pages than it has frames, so the capacity is the smallest power of two at least twice the number of
+ * frames, which keeps the load factor at or below 0.5 and the probe sequences short. A slot is 8 bytes, so a probe
+ * sequence usually stays within one cache line. Erase shifts the following entries back instead of leaving
+ * tombstones, so lookups never slow down as pages come and go.
+ *
+ * Not thread safe; the buffer pool latch protects it. The one exception is FindUnlatched, for optimistic readers:
+ * slots are read and written with atomic loads and stores, so a lookup racing with Insert and Erase never reads a
+ * torn slot, though it may miss the page or pair it with a stale frame.
+ */
+class PageTable {
+ public:
+  /**
+   * Create a new PageTable.
+   * @param num_frames the maximum number of entries, i.e. the size of the buffer pool
+   */
+  explicit PageTable(size_t num_frames);
+
+  /**
+   * Look up a page.
+   * @param page_id the page to look up
+   * @param[out] frame_id the frame holding the page, if found
+   * @return true if the page is in the table
+   */
+  bool Find(page_id_t page_id, frame_id_t *frame_id) const;
+
+  /**
+   * Look up a page without holding the buffer pool latch. The result is only a hint: the page may have moved or left
+   * since, so the caller must check that the frame holds the page.
+   * @param page_id the page to look up
+   * @param[out] frame_id the frame that held the page, if found
+   * @return true if the page was found
+   */
+  bool FindUnlatched(page_id_t page_id, frame_id_t *frame_id) const;
+
+  /**
+   * Insert a page that is not in the table yet.
+   * @param page_id the page to insert, cannot be INVALID_PAGE_ID
+   * @param frame_id the frame holding the page
+   */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * Remove a page.
+   * @param page_id the page to remove
+   * @return true if the page was in the table
+   */
+  bool Erase(page_id_t page_id);
+
+  /** @return the number of pages in the table */
+  size_t Size() const { return size_; }
+
+ private:
+  struct Slot {
+    page_id_t page_id_{INVALID_PAGE_ID};
+    frame_id_t frame_id_{-1};
+  };
+
+  /** @return the home slot of a page id */
+  size_t Home(page_id_t page_id) const;
+
+  /** Write a slot with atomic stores, for FindUnlatched. */
+  static void Store(Slot *slot, page_id_t page_id, frame_id_t frame_id);
+
+  /** Slots; an empty slot holds INVALID_PAGE_ID. */
+  std::vector<Slot> slots_;
+  /** Capacity - 1, the capacity being a power of two. */
+  size_t mask_;
+  /** Number of bits of the hash that index a slot. */
+  int shift_;
+  /** Number of pages in the table. */
+  size_t size_{0};
+};
+
+}  // namespace bustub
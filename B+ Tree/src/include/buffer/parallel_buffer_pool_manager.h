@@ -0,0 +1,212 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.h
+//
+// Identification: src/include/buffer/parallel_buffer_pool_manager.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/buffer_pool_options.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * ParallelBufferPoolManager shards pages over several BufferPoolManagerInstances, each with its own latch, page table,
+ * free list and replacer. A page lives in instance page_id % num_instances, so threads working on different pages
+ * mostly take different latches.
+ *
+ * A partition is created in every instance, under the same id, with an equal share of its quota. Partitions must be
+ * created through the parallel BPM rather than on the instances, or the ids would not line up.
+ */
+class ParallelBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * Creates a new ParallelBufferPoolManager.
+   * @param num_instances the number of individual BufferPoolManagerInstances to store
+   * @param pool_size the pool size of each BufferPoolManagerInstance
+   * @param disk_manager the disk manager
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param options tuning knobs, applied to every instance
+   */
+  ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                            LogManager *log_manager = nullptr, const BufferPoolOptions &options = BufferPoolOptions());
+
+  /**
+   * Destroys an existing ParallelBufferPoolManager.
+   */
+  ~ParallelBufferPoolManager() override;
+
+  /** @return size of the buffer pool, summed over all instances */
+  size_t GetPoolSize() override;
+
+  /** @return the number of instances */
+  size_t GetNumInstances() { return instances_.size(); }
+
+  /**
+   * @param page_id id of page
+   * @return the BufferPoolManagerInstance responsible for handling the given page id
+   */
+  BufferPoolManagerInstance *GetBufferPoolManager(page_id_t page_id);
+
+  /**
+   * @param instance_index index of the instance
+   * @return the instance at that index
+   */
+  BufferPoolManagerInstance *GetInstance(size_t instance_index) { return instances_[instance_index]; }
+
+  /**
+   * BufferPoolManagerInstance::SaveWarmSet on every instance, each to its own file.
+   * @return the number of page ids saved, summed over all instances
+   */
+  size_t SaveWarmSet();
+
+ protected:
+  /**
+   * Fetch the requested page from the responsible BufferPoolManagerInstance.
+   * @param page_id id of page to be fetched
+   * @param access_type hint passed on to the replacer
+   * @param partition the partition to charge the page to if it has to be read in
+   * @return the requested page
+   */
+  Page *FetchPageImpl(page_id_t page_id, AccessType access_type, partition_id_t partition) override;
+
+  /**
+   * Unpin the target page from the responsible BufferPoolManagerInstance.
+   * @param page_id id of page to be unpinned
+   * @param is_dirty true if the page should be marked as dirty, false otherwise
+   * @param access_type hint passed on to the replacer
+   * @return false if the page pin count is <= 0 before this call, true otherwise
+   */
+  bool UnpinPageImpl(page_id_t page_id, bool is_dirty, AccessType access_type) override;
+
+  /**
+   * Flushes the target page to disk.
+   * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
+   * @return false if the page could not be found in the page table, true otherwise
+   */
+  bool FlushPageImpl(page_id_t page_id) override;
+
+  /**
+   * Creates a new page. Instances are tried round robin, starting one further on each call, until one of them has a
+   * frame to spare.
+   * @param[out] page_id id of created page
+   * @param partition the partition to charge the page to
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPageImpl(page_id_t *page_id, partition_id_t partition) override;
+
+  /**
+   * Deletes a page from the responsible BufferPoolManagerInstance.
+   * @param page_id id of page to be deleted
+   * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
+   */
+  bool DeletePageImpl(page_id_t page_id) override;
+
+  /**
+   * Flushes all the dirty pages in all the instances to disk. The instances flush at the same time, through the
+   * shared DiskScheduler.
+   * @param[out] stats if not nullptr, what was written, summed over the instances
+   */
+  void FlushAllPagesImpl(FlushStats *stats) override;
+
+  /**
+   * Prefetch a page into the responsible BufferPoolManagerInstance.
+   * @param page_id id of the page to prefetch
+   * @param access_type hint passed on to the replacer
+   * @param partition the partition to charge the page to if it has to be read in
+   * @return true if the page is resident and readable already
+   */
+  bool PrefetchPageImpl(page_id_t page_id, AccessType access_type, partition_id_t partition) override;
+
+  /**
+   * Prefetch many pages, each into its responsible BufferPoolManagerInstance. Every instance gets its share of the
+   * pages in one batch.
+   * @param page_ids ids of the pages to prefetch
+   * @param access_type hint passed on to the replacer
+   * @param partition the partition to charge the pages read in to
+   */
+  void PrefetchPagesImpl(const std::vector<page_id_t> &page_ids, AccessType access_type,
+                         partition_id_t partition) override;
+
+  /**
+   * Resize every instance to an equal share of the new size; the first pool_size % num_instances instances get one
+   * frame more. Nothing is resized if any share is out of range for its instance, e.g. below its partitions' minimums.
+   * @param pool_size the new size of the buffer pool, summed over all instances
+   * @return false if the size is out of range
+   */
+  bool ResizeImpl(size_t pool_size) override;
+
+  /**
+   * Fetch a page from its responsible BufferPoolManagerInstance; the handle unpins there.
+   * @param page_id id of the page to fetch
+   * @param access_type hint passed on to the replacer
+   * @param partition the partition to charge the page to if it has to be read in
+   * @return a handle on the pinned page, an empty handle on failure
+   */
+  PageHandle FetchPageHandleImpl(page_id_t page_id, AccessType access_type, partition_id_t partition) override;
+
+  /**
+   * Create a page in the instances round robin, as NewPageImpl; the handle unpins in the instance that created it.
+   * @param[out] page_id id of the created page
+   * @param partition the partition to charge the page to
+   * @return a handle on the pinned page, an empty handle on failure
+   */
+  PageHandle NewPageHandleImpl(page_id_t *page_id, partition_id_t partition) override;
+
+  /** Not reached by handles, which belong to an instance; falls back to UnpinPage on the responsible instance. */
+  void UnpinFrameImpl(frame_id_t frame_id, page_id_t page_id, bool is_dirty, AccessType access_type) override;
+
+  /** Not reached by handles, which belong to an instance; falls back to FetchPage on the responsible instance. */
+  void PinFrameImpl(frame_id_t frame_id, page_id_t page_id, AccessType access_type) override;
+
+  /**
+   * Peek at a page in its responsible BufferPoolManagerInstance.
+   * @param page_id id of the page
+   * @param[out] version the page version to validate against
+   * @return the page, nullptr if it is not resident or is being written or read in
+   */
+  Page *PeekPageImpl(page_id_t page_id, uint64_t *version) override;
+
+  /** @return the metrics of all the instances, summed, with the latencies of the shared DiskScheduler */
+  BufferPoolMetrics GetMetricsImpl() override;
+
+  /**
+   * Create a partition in every instance. Instance i gets min_frames / num_instances of the minimum and as much of the
+   * maximum, plus one frame of each if i < the remainder, as Resize splits the pool.
+   * @return the partition, nullptr if the name is empty or taken, the minimums of all partitions add up to more than
+   * the pool, min_frames > max_frames or max_frames < the number of instances
+   */
+  BufferPoolManager *CreatePartitionImpl(const std::string &name, size_t min_frames, size_t max_frames) override;
+
+  /** @return the partitions of all the instances, summed per partition */
+  std::vector<BufferPoolPartitionMetrics> GetPartitionMetricsImpl() override;
+
+ private:
+  /** The disk manager's scheduler, shared by the instances, so the database file has one set of I/O threads. */
+  DiskScheduler *disk_scheduler_;
+  /** The instances; instances_[i] owns the page ids congruent to i modulo instances_.size(). */
+  std::vector<BufferPoolManagerInstance *> instances_;
+  /** Instance NewPage starts at on its next call. */
+  std::atomic<size_t> next_instance_{0};
+  /** Serializes CreatePartition, so that a partition gets the same id in every instance, and Resize. */
+  std::mutex partition_latch_;
+  /** The partitions handed out by CreatePartition, owned by the parallel BPM. */
+  std::vector<BufferPoolPartition *> partition_views_;
+};
+}  // namespace bustub
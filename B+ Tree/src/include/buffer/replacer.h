@@ -0,0 +1,106 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// replacer.h
+//
+// Identification: src/include/buffer/replacer.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * What the caller intends to do with a page, passed down from FetchPage / UnpinPage to the replacer.
+ * NORMAL: regular access, the page is ranked by the replacement policy as usual.
+ * SCAN: part of a sequential scan; the page is needed again only for the rest of the scan step.
+ * ONCE: the page will not be needed again at all.
+ * SCAN and ONCE pages go to the cold end of the replacer, so a large scan keeps recycling its own few frames (like
+ * PostgreSQL's buffer rings) instead of pushing out the working set. ONCE frames are victimized before SCAN frames,
+ * and neither kind of access counts as a reference in the policies that keep a reference history. The hints only
+ * demote pages that had no NORMAL access since they came into their frame, typically the ones the scan brought in: a
+ * hot page the scan passes over keeps its place.
+ */
+enum class AccessType { NORMAL, SCAN, ONCE };
+
+/**
+ * Replacer is an abstract class that tracks page usage.
+ */
+class Replacer {
+ public:
+  Replacer() = default;
+  virtual ~Replacer() = default;
+
+  /** Tells whether a frame may be victimized; see VictimIf. */
+  using FrameFilter = std::function<bool(frame_id_t)>;
+
+  /**
+   * Remove the victim frame as defined by the replacement policy.
+   * @param[out] frame_id id of frame that was removed, nullptr if no victim was found
+   * @return true if a victim frame was found, false otherwise
+   */
+  virtual bool Victim(frame_id_t *frame_id) { return VictimIf(frame_id, {}); }
+
+  /**
+   * Victim restricted to the frames accept returns true for, e.g. the frames of the buffer pool partitions that are
+   * over their minimum. The victim is the first accepted frame in the order Victim goes in; the frames passed over keep
+   * their place in that order, as if they had not been looked at.
+   * @param[out] frame_id id of frame that was removed
+   * @param accept the frames that may be victimized; an empty filter accepts every frame
+   * @return true if an accepted victim frame was found, false otherwise
+   */
+  virtual bool VictimIf(frame_id_t *frame_id, const FrameFilter &accept) = 0;
+
+  /**
+   * Pins a frame, indicating that it should not be victimized until it is unpinned.
+   * @param frame_id the id of the frame to pin
+   */
+  virtual void Pin(frame_id_t frame_id) = 0;
+
+  /**
+   * Unpins a frame, indicating that it can now be victimized.
+   * @param frame_id the id of the frame to unpin
+   * @param access_type SCAN or ONCE place the frame at the cold end, i.e. it is victimized first, ONCE before SCAN
+   */
+  virtual void Unpin(frame_id_t frame_id, AccessType access_type = AccessType::NORMAL) = 0;
+
+  /** @return the number of elements in the replacer that can be victimized */
+  virtual size_t Size() = 0;
+
+  /**
+   * Tells the replacer which page a frame holds. The buffer pool manager calls this right before Pin on every
+   * fetch and new page, so a policy that remembers pages after they were evicted can tell a re-reference from a
+   * page it has never seen. Policies that only look at frames ignore it.
+   * @param frame_id the frame being accessed
+   * @param page_id the page that frame holds
+   * @param access_type SCAN or ONCE accesses should not make the page look hotter than it is
+   */
+  virtual void RecordAccess(frame_id_t frame_id, page_id_t page_id, AccessType access_type = AccessType::NORMAL) {}
+
+  /**
+   * Forgets a frame whose page was deleted. Unlike Victim, the page is gone for good, so nothing about it should be
+   * remembered. The default just makes the frame ineligible for replacement.
+   * @param frame_id the id of the frame to remove
+   */
+  virtual void Remove(frame_id_t frame_id) { Pin(frame_id); }
+
+  /**
+   * Lists the frames that would be victimized next, without victimizing them or changing their order: the first entry
+   * is the frame Victim would return right now. The page cleaner uses this to write dirty frames back before they
+   * are evicted. The default lists nothing, which leaves the cleaner idle.
+   * @param max_frames the maximum number of frames to list
+   * @param[out] frame_ids the frames, coldest first
+   */
+  virtual void PeekVictims(size_t max_frames, std::vector<frame_id_t> *frame_ids) { frame_ids->clear(); }
+};
+
+}  // namespace bustub
@@ -0,0 +1,133 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// spill_cache.h
+//
+// Identification: src/include/buffer/spill_cache.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <functional>
+#include <future>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/page_table.h"
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_scheduler.h"
+
+namespace bustub {
+
+/**
+ * SpillCache is a tier between a buffer pool and its database file, meant for a file on fast local storage in front
+ * of a database file on slow (e.g. network attached) storage. Pages evicted from the pool are written to the cache
+ * file in the background, and misses of the pool read them from there instead of from the database file.
+ *
+ * The cache file holds capacity slots of one page each; slot s is "page" s of the file. A PageTable maps the cached
+ * pages to their slots, 8 bytes per slot. A hand sweeping the slots in order picks the slot a new page goes to,
+ * passing over slots with I/O in flight. That makes the cache FIFO, which is all recency can tell here: a page is only
+ * ever read once before it leaves the cache.
+ *
+ * Like CompressedPageCache, it only holds clean pages and is exclusive: Read takes the page out of the cache. A page
+ * whose write is still in flight is read from the copy being written. The slot directory lives in memory only, so the
+ * cache starts out empty every time; the file is deleted when the cache is destroyed.
+ *
+ * Thread safe: Insert, Read and Erase are called under the buffer pool latch, but completions come in on the I/O
+ * threads, so the cache has its own latch.
+ */
+class SpillCache {
+ public:
+  /**
+   * Create a new SpillCache.
+   * @param file_name the cache file, created if it does not exist; whatever it holds is ignored
+   * @param capacity number of pages the cache file holds
+   * @param queue_depth number of cache file reads and writes carried out at the same time
+   */
+  SpillCache(const std::string &file_name, size_t capacity, size_t queue_depth);
+
+  /** Waits for the I/O in flight, then deletes the cache file. */
+  ~SpillCache();
+
+  /**
+   * Copy a clean page and write it to the cache file in the background, replacing an older copy of it, if any.
+   * @param page_id the page
+   * @param data the page's PAGE_SIZE bytes; may be reused as soon as Insert returns
+   * @return true if the page is being written, false if it was dropped because all slots have I/O in flight or too
+   * many writes are queued up already
+   */
+  bool Insert(page_id_t page_id, const char *data);
+
+  /**
+   * Move a page out of the cache: read it into data in the background and complete promise when it is in. If the read
+   * of the cache file fails, the page is dropped from the cache and promise goes to on_failure instead, on the I/O
+   * thread, e.g. to read the page from the database file.
+   * @param page_id the page
+   * @param data PAGE_SIZE bytes to read the page into, untouched until promise is completed
+   * @param[in,out] promise taken and completed if the page is in the cache, left alone otherwise
+   * @param on_failure completes promise after a failed read
+   * @return true if the page is in the cache
+   */
+  bool Read(page_id_t page_id, char *data, std::promise<bool> *promise,
+            const std::function<void(std::promise<bool>)> &on_failure);
+
+  /** Forget a page, e.g. because it was deleted. */
+  void Erase(page_id_t page_id);
+
+  /** @return the number of pages cached */
+  size_t Size();
+
+  /** @return the counters and latencies of the cache file I/O */
+  DiskSchedulerStats GetIOStats() { return disk_scheduler_->GetStats(); }
+
+ private:
+  enum class SlotState { FREE, WRITING, VALID, READING };
+
+  struct Slot {
+    /** The page cached, INVALID_PAGE_ID if none; a WRITING slot loses its page if it is read or erased. */
+    page_id_t page_id_{INVALID_PAGE_ID};
+    SlotState state_{SlotState::FREE};
+  };
+
+  /**
+   * Pick the slot for a new page with the hand and empty it. Caller must hold latch_.
+   * @param[out] slot the slot
+   * @return false if every slot has I/O in flight
+   */
+  bool TakeSlot(size_t *slot);
+
+  /** Take a page out of the directory; its slot frees up now, or once its I/O completes. Caller must hold latch_. */
+  void Forget(page_id_t page_id, size_t slot);
+
+  /**
+   * Called on an I/O thread when the write or read of a slot completes. A failed write drops the page from the cache
+   * and frees its slot; a read took the page out of the cache already, so its slot just frees up.
+   */
+  void FinishIO(size_t slot, bool ok);
+
+  const std::string file_name_;
+  /** Most writes in flight; beyond that, Insert drops pages rather than piling up copies. */
+  const size_t max_writes_;
+  /** Protects everything below but disk_manager_ and disk_scheduler_. */
+  std::mutex latch_;
+  std::vector<Slot> slots_;
+  /** Cached page -> slot, for the WRITING and VALID slots that still hold their page. */
+  PageTable directory_;
+  /** Next slot the hand looks at. */
+  size_t hand_{0};
+  /** Copies of the pages being written, by slot. */
+  std::unordered_map<size_t, std::shared_ptr<std::vector<char>>> writing_;
+  DiskManager disk_manager_;
+  /** Carries out the cache file I/O; deleted first thing on destruction, which finishes the I/O in flight. */
+  DiskScheduler *disk_scheduler_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,120 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_manager.h
+//
+// Identification: src/include/recovery/log_manager.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <future>              // NOLINT
+#include <mutex>               // NOLINT
+#include <thread>              // NOLINT
+
+#include "recovery/log_record.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * LogManager maintains a separate thread that is awakened whenever the log buffer is full or whenever a timeout
+ * happens. When the thread is awakened, the log buffer's content is written into the disk log file.
+ *
+ * Appends go into log_buffer_ while the previous batch is written out of flush_buffer_, so writing the log never holds
+ * up appending to it. This gives group commit: every thread waiting in Flush while a write is under way is served by
+ * the next single write, however many records they appended meanwhile, instead of each forcing the log on its own.
+ */
+class LogManager {
+ public:
+  explicit LogManager(DiskManager *disk_manager)
+      : next_lsn_(0), persistent_lsn_(INVALID_LSN), disk_manager_(disk_manager) {
+    log_buffer_ = new char[LOG_BUFFER_SIZE];
+    flush_buffer_ = new char[LOG_BUFFER_SIZE];
+  }
+
+  ~LogManager() {
+    StopFlushThread();
+    delete[] log_buffer_;
+    delete[] flush_buffer_;
+    log_buffer_ = nullptr;
+    flush_buffer_ = nullptr;
+  }
+
+  /** Start the background flush thread and turn on enable_logging. */
+  void RunFlushThread();
+
+  /** Write out what is still buffered, stop the background flush thread and turn off enable_logging. */
+  void StopFlushThread();
+
+  /**
+   * Assign the record its LSN and copy it into the log buffer. If the buffer is full, wait until it has been swapped
+   * out for writing.
+   * @return the LSN of the record
+   */
+  lsn_t AppendLogRecord(LogRecord *log_record);
+
+  /**
+   * Block until every record up to lsn is on disk, e.g. before writing a page whose LSN is lsn, or to commit. The
+   * background thread is woken to write right away; without it, the caller writes the log itself.
+   *
+   * An lsn past the last record appended is taken to be the last record appended, so a page that holds no LSN, like
+   * the header page, can only cost a write of the log, never a wait for a record that does not exist.
+   * @return true if the call had to wait for a write, false if the records were on disk already
+   */
+  bool Flush(lsn_t lsn);
+
+  inline lsn_t GetNextLSN() { return next_lsn_; }
+  inline lsn_t GetPersistentLSN() { return persistent_lsn_; }
+  inline void SetPersistentLSN(lsn_t lsn) { persistent_lsn_ = lsn; }
+  inline char *GetLogBuffer() { return log_buffer_; }
+
+ private:
+  /** The background thread: write a batch whenever someone waits in Flush or for space, or log_timeout passes. */
+  void FlushLoop();
+
+  /**
+   * Swap the buffers and write out what was appended, with latch_ released during the write. Only one write is under
+   * way at a time: if another one is, this waits for it before touching the buffers.
+   * @param latch the held lock on latch_
+   */
+  void WriteBuffer(std::unique_lock<std::mutex> *latch);
+
+  /**
+   * Get the records up to lsn one write closer to disk: hand them to the flush thread and wait for its next write, or
+   * without the thread, write them or wait for the write under way.
+   * @param latch the held lock on latch_
+   */
+  void AwaitWrite(std::unique_lock<std::mutex> *latch, lsn_t lsn);
+
+  std::atomic<lsn_t> next_lsn_;
+  /** The LSN of the last record on disk. */
+  std::atomic<lsn_t> persistent_lsn_;
+  /** Records are appended here, */
+  char *log_buffer_;
+  /** and written out from here. */
+  char *flush_buffer_;
+  /** Bytes appended to log_buffer_ since it was last swapped out. */
+  size_t log_buffer_size_{0};
+  /** The highest LSN anyone waits in Flush for. */
+  lsn_t flush_requested_lsn_{INVALID_LSN};
+  /** True while WriteBuffer writes flush_buffer_. */
+  bool writing_{false};
+  bool stop_flush_thread_{false};
+  std::mutex latch_;
+  std::thread *flush_thread_{nullptr};
+  /** Wakes the flush thread. */
+  std::condition_variable cv_;
+  /** Wakes the threads waiting in Flush or for space in log_buffer_ after each write. */
+  std::condition_variable flushed_cv_;
+  DiskManager *disk_manager_;
+};
+
+}  // namespace bustub
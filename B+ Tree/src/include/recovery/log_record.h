@@ -0,0 +1,212 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_record.h
+//
+// Identification: src/include/recovery/log_record.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cassert>
+#include <sstream>
+#include <string>
+
+#include "common/config.h"
+#include "common/rid.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+/** The type of the log record. */
+enum class LogRecordType {
+  INVALID = 0,
+  INSERT,
+  MARKDELETE,
+  APPLYDELETE,
+  ROLLBACKDELETE,
+  UPDATE,
+  BEGIN,
+  COMMIT,
+  ABORT,
+  /** Creating a new page in the table heap. */
+  NEWPAGE,
+  /** Inserting a key into a B+ tree index. */
+  INDEXINSERT,
+  /** Removing a key from a B+ tree index. */
+  INDEXDELETE,
+};
+
+/**
+ * For every write operation on the table page, you should write ahead a corresponding log record.
+ *
+ * For EACH log record, HEADER is like (5 fields in common, 20 bytes in total).
+ *---------------------------------------------
+ * | size | LSN | transID | prevLSN | LogType |
+ *---------------------------------------------
+ * For insert type log record
+ *---------------------------------------------------------------
+ * | HEADER | tuple_rid | tuple_size | tuple_data(char[] array) |
+ *---------------------------------------------------------------
+ * For delete type (including markdelete, rollbackdelete, applydelete)
+ *----------------------------------------------------------------
+ * | HEADER | tuple_rid | tuple_size | tuple_data(char[] array) |
+ *---------------------------------------------------------------
+ * For update type log record
+ *-----------------------------------------------------------------------------------
+ * | HEADER | tuple_rid | tuple_size | old_tuple_data | tuple_size | new_tuple_data |
+ *-----------------------------------------------------------------------------------
+ * For new page type log record
+ *--------------------------
+ * | HEADER | prev_page_id |
+ *--------------------------
+ * For index insert and index delete type log record; the rid of an index delete is unused
+ *------------------------------------------------------------------------------
+ * | HEADER | rid | name_size | index_name(char[] array) | key_size | key_data |
+ *------------------------------------------------------------------------------
+ * An index record describes the whole operation on the tree, splits included; every page the operation changes
+ * carries the record's LSN.
+ */
+class LogRecord {
+  friend class LogManager;
+  friend class LogRecovery;
+
+ public:
+  LogRecord() = default;
+
+  // constructor for Transaction type(BEGIN/COMMIT/ABORT)
+  LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type)
+      : size_(HEADER_SIZE), txn_id_(txn_id), prev_lsn_(prev_lsn), log_record_type_(log_record_type) {}
+
+  // constructor for INSERT/DELETE type
+  LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type, const RID &rid, const Tuple &tuple)
+      : txn_id_(txn_id), prev_lsn_(prev_lsn), log_record_type_(log_record_type) {
+    if (log_record_type == LogRecordType::INSERT) {
+      insert_rid_ = rid;
+      insert_tuple_ = tuple;
+    } else {
+      assert(log_record_type == LogRecordType::APPLYDELETE || log_record_type == LogRecordType::MARKDELETE ||
+             log_record_type == LogRecordType::ROLLBACKDELETE);
+      delete_rid_ = rid;
+      delete_tuple_ = tuple;
+    }
+    // calculate log record size
+    size_ = HEADER_SIZE + sizeof(RID) + sizeof(int32_t) + tuple.GetLength();
+  }
+
+  // constructor for UPDATE type
+  LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type, const RID &update_rid,
+            const Tuple &old_tuple, const Tuple &new_tuple)
+      : txn_id_(txn_id),
+        prev_lsn_(prev_lsn),
+        log_record_type_(log_record_type),
+        update_rid_(update_rid),
+        old_tuple_(old_tuple),
+        new_tuple_(new_tuple) {
+    // calculate log record size
+    size_ = HEADER_SIZE + sizeof(RID) + old_tuple.GetLength() + new_tuple.GetLength() + 2 * sizeof(int32_t);
+  }
+
+  // constructor for NEWPAGE type
+  LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type, page_id_t page_id)
+      : size_(HEADER_SIZE),
+        txn_id_(txn_id),
+        prev_lsn_(prev_lsn),
+        log_record_type_(log_record_type),
+        prev_page_id_(page_id) {
+    // calculate log record size
+    size_ = HEADER_SIZE + sizeof(page_id_t);
+  }
+
+  // constructor for INDEXINSERT/INDEXDELETE type
+  LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type, const std::string &index_name,
+            const char *key, int32_t key_size, const RID &rid)
+      : txn_id_(txn_id),
+        prev_lsn_(prev_lsn),
+        log_record_type_(log_record_type),
+        index_rid_(rid),
+        index_name_(index_name),
+        index_key_(key, key_size) {
+    assert(log_record_type == LogRecordType::INDEXINSERT || log_record_type == LogRecordType::INDEXDELETE);
+    // calculate log record size
+    size_ = HEADER_SIZE + sizeof(RID) + 2 * sizeof(int32_t) + index_name_.size() + index_key_.size();
+  }
+
+  ~LogRecord() = default;
+
+  inline RID &GetDeleteRID() { return delete_rid_; }
+
+  inline Tuple &GetInserteTuple() { return insert_tuple_; }
+
+  inline RID &GetInsertRID() { return insert_rid_; }
+
+  inline page_id_t GetNewPageRecord() { return prev_page_id_; }
+
+  inline const std::string &GetIndexName() { return index_name_; }
+
+  /** @return the raw bytes of the key of an index record */
+  inline const std::string &GetIndexKey() { return index_key_; }
+
+  inline RID &GetIndexRID() { return index_rid_; }
+
+  inline int32_t GetSize() { return size_; }
+
+  inline lsn_t GetLSN() { return lsn_; }
+
+  inline txn_id_t GetTxnId() { return txn_id_; }
+
+  inline lsn_t GetPrevLSN() { return prev_lsn_; }
+
+  inline LogRecordType &GetLogRecordType() { return log_record_type_; }
+
+  // For debug purpose
+  inline std::string ToString() const {
+    std::ostringstream os;
+    os << "Log["
+       << "size:" << size_ << ", "
+       << "LSN:" << lsn_ << ", "
+       << "transID:" << txn_id_ << ", "
+       << "prevLSN:" << prev_lsn_ << ", "
+       << "LogType:" << static_cast<int>(log_record_type_) << "]";
+
+    return os.str();
+  }
+
+ private:
+  // the length of log record(for serialization, in bytes)
+  int32_t size_{0};
+  // must have fields
+  lsn_t lsn_{INVALID_LSN};
+  txn_id_t txn_id_{INVALID_TXN_ID};
+  lsn_t prev_lsn_{INVALID_LSN};
+  LogRecordType log_record_type_{LogRecordType::INVALID};
+
+  // case1: for delete operation, delete_tuple_ for UNDO operation
+  RID delete_rid_;
+  Tuple delete_tuple_;
+
+  // case2: for insert operation
+  RID insert_rid_;
+  Tuple insert_tuple_;
+
+  // case3: for update operation
+  RID update_rid_;
+  Tuple old_tuple_;
+  Tuple new_tuple_;
+
+  // case4: for new page operation
+  page_id_t prev_page_id_{INVALID_PAGE_ID};
+  page_id_t page_id_{INVALID_PAGE_ID};
+
+  // case5: for index operation
+  RID index_rid_;
+  std::string index_name_;
+  std::string index_key_;
+
+  static const int HEADER_SIZE = 20;
+};  // namespace bustub
+
+}  // namespace bustub
@@ -0,0 +1,189 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler.h
+//
+// Identification: src/include/storage/disk/disk_scheduler.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>  // NOLINT
+#include <mutex>   // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/disk/latency_histogram.h"
+
+namespace bustub {
+
+/** A page read or write for a DiskScheduler to carry out. */
+struct DiskRequest {
+  /** True for a write, false for a read. */
+  bool is_write_;
+
+  /** The page's buffer, PAGE_SIZE bytes: filled by a read, written out by a write. */
+  char *data_;
+
+  /** The page read or written; the first one if iov_ is set. */
+  page_id_t page_id_;
+
+  /** Set once the request has been carried out, to false if it failed. */
+  std::promise<bool> callback_;
+
+  /**
+   * Optional, runs on the I/O thread right before callback_ is set.
+   * Gets whether the request succeeded and its latency (from Schedule to completion) in nanoseconds.
+   */
+  std::function<void(bool, uint64_t)> on_complete_;
+
+  /** Set by Schedule. */
+  std::chrono::steady_clock::time_point submit_time_;
+
+  /**
+   * Vectored read or write: if not empty, pages page_id_, page_id_ + 1, ... are read into or written from these
+   * buffers in one request, and data_ is ignored.
+   */
+  std::vector<char *> iov_;
+};
+
+/** Counters over all the requests a DiskScheduler has completed. Latencies run from Schedule to completion. */
+struct DiskSchedulerStats {
+  uint64_t reads_{0};
+  uint64_t writes_{0};
+  /** Pages written; more than writes_ when writes are vectored. */
+  uint64_t pages_written_{0};
+  /** Pages read; more than reads_ when reads are vectored. */
+  uint64_t pages_read_{0};
+  uint64_t total_read_ns_{0};
+  uint64_t total_write_ns_{0};
+  uint64_t max_read_ns_{0};
+  uint64_t max_write_ns_{0};
+  /** Requests scheduled but not completed yet. */
+  uint64_t in_flight_{0};
+  /** Distribution of the read latencies, one per request however many pages it reads. */
+  LatencyHistogram read_latency_;
+  /** Distribution of the write latencies, one per request however many pages it writes. */
+  LatencyHistogram write_latency_;
+};
+
+/**
+ * DiskScheduler carries out page reads and writes on queue_depth I/O threads, so up to queue_depth of them are in
+ * flight at the same time while the callers go on with other work. Schedule queues a request and returns; completion
+ * is signalled through the request's promise (and, if set, its on_complete_ hook).
+ *
+ * Given the DiskManager's database file, the scheduler opens it and reads and writes the pages itself, with preadv and
+ * pwritev, which report every I/O error to the request. Otherwise the I/O threads call the DiskManager, which must
+ * be safe to call from several threads at once; it logs its I/O errors rather than returning them, so those requests
+ * always succeed. A database file shared by several buffer pools, e.g. the instances of a parallel one, should have
+ * a single scheduler, so it is opened once and its I/O threads are shared too.
+ *
+ * Direct I/O: the file is opened with O_DIRECT, so the pages bypass the OS page cache instead of being cached there as
+ * well as in the buffer pool. O_DIRECT needs buffers aligned to the device's logical block size; the buffer pool's
+ * frames are page aligned, which is enough for any device with blocks of at most PAGE_SIZE. Other buffers go through
+ * an aligned bounce buffer. If the file system refuses O_DIRECT (e.g. tmpfs), the file is opened for buffered I/O.
+ */
+class DiskScheduler {
+ public:
+  /** Default number of requests carried out at the same time. */
+  static constexpr size_t DEFAULT_QUEUE_DEPTH = 4;
+  /** Alignment of the buffers, offsets and lengths of direct I/O. */
+  static constexpr size_t DIRECT_IO_ALIGNMENT = PAGE_SIZE;
+
+  /**
+   * Create a new DiskScheduler.
+   * @param disk_manager the disk manager carrying out the requests if db_file cannot be opened
+   * @param queue_depth maximum number of requests carried out at the same time, i.e. number of I/O threads
+   * @param db_file if not empty, the disk manager's database file, which the scheduler then reads and writes itself
+   * @param direct_io open db_file with O_DIRECT
+   */
+  explicit DiskScheduler(DiskManager *disk_manager, size_t queue_depth = DEFAULT_QUEUE_DEPTH,
+                         const std::string &db_file = "", bool direct_io = false);
+
+  /**
+   * Destroys the DiskScheduler. Requests that are already scheduled are carried out first.
+   */
+  ~DiskScheduler();
+
+  /**
+   * Queue a request for the I/O threads. Returns right away.
+   * @param r the request
+   */
+  void Schedule(DiskRequest r);
+
+  /** @return a promise for the callback_ of a request */
+  auto CreatePromise() -> std::promise<bool> { return {}; };
+
+  /**
+   * Read a page and wait for it.
+   * @param page_id the page to read
+   * @param[out] page_data where the page goes
+   * @return true if the read succeeded
+   */
+  bool ReadPage(page_id_t page_id, char *page_data);
+
+  /**
+   * Write a page and wait for it.
+   * @param page_id the page to write
+   * @param page_data the page contents
+   * @return true if the write succeeded
+   */
+  bool WritePage(page_id_t page_id, char *page_data);
+
+  /** @return counters over the requests completed so far */
+  DiskSchedulerStats GetStats();
+
+  /** @return the number of requests carried out at the same time */
+  size_t GetQueueDepth() const { return workers_.size(); }
+
+  /** @return true if pages are read and written with O_DIRECT */
+  bool IsDirectIO() const { return direct_io_; }
+
+ private:
+  /** Body of each I/O thread: take requests off the queue until the scheduler is destroyed. */
+  void WorkerLoop();
+
+  /** Carry out one request and complete it. */
+  void Execute(DiskRequest *r);
+
+  /**
+   * Read pages page_id, page_id + 1, ... from fd_, in as few preadv calls as IOV_MAX allows. Pages past the end of the
+   * file read as zeros, as with DiskManager::ReadPage.
+   * @return false on an I/O error, or if the file ends in the middle of a page
+   */
+  bool ReadFile(page_id_t page_id, char *const *pages, size_t count);
+
+  /**
+   * Write pages page_id, page_id + 1, ... to fd_, in as few pwritev calls as IOV_MAX allows.
+   * @return false on an I/O error
+   */
+  bool WriteFile(page_id_t page_id, char *const *pages, size_t count);
+
+  DiskManager *disk_manager_;
+  /** The database file, -1 if the DiskManager does the I/O. */
+  int fd_{-1};
+  /** fd_ is open with O_DIRECT. */
+  bool direct_io_{false};
+  /** Protects queue_, stop_ and stats_. */
+  std::mutex latch_;
+  std::condition_variable cv_;
+  /** Scheduled requests not picked up by an I/O thread yet, in FIFO order. */
+  std::deque<DiskRequest> queue_;
+  bool stop_{false};
+  DiskSchedulerStats stats_;
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace bustub
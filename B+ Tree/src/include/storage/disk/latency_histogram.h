@@ -0,0 +1,60 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// latency_histogram.h
+//
+// Identification: src/include/storage/disk/latency_histogram.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace bustub {
+
+/**
+ * LatencyHistogram counts latencies in log-scale buckets: bucket 0 holds 0ns, bucket i > 0 holds [2^(i-1), 2^i) ns,
+ * and the last bucket everything from about 4.6 minutes up. Recording is a handful of instructions and the histogram
+ * is a fixed size, so it can stay on in production; percentiles are exact to within a factor of two.
+ *
+ * Not thread safe: the owner records and copies it under its own latch.
+ */
+struct LatencyHistogram {
+  static constexpr size_t NUM_BUCKETS = 40;
+
+  uint64_t buckets_[NUM_BUCKETS]{};
+  /** Number of latencies recorded. */
+  uint64_t count_{0};
+  uint64_t sum_ns_{0};
+  uint64_t max_ns_{0};
+
+  /** Count one latency. */
+  void Record(uint64_t ns);
+
+  /** Add the counts of another histogram to this one. */
+  void Merge(const LatencyHistogram &other);
+
+  /**
+   * @param percentile between 0 and 100
+   * @return an upper bound on the given percentile of the recorded latencies: the upper end of the bucket it falls
+   * in, but at most the largest latency recorded; 0 if nothing was recorded
+   */
+  uint64_t Percentile(double percentile) const;
+
+  /** @return the mean latency, 0 if nothing was recorded */
+  uint64_t MeanNs() const { return count_ == 0 ? 0 : sum_ns_ / count_; }
+
+  /** @return e.g. "count=12 mean_us=80.1 p50_us=65.5 p99_us=262.1 max_us=240.7" */
+  std::string ToString() const;
+
+  /** @return a JSON object with the count, sum, max, p50, p99 and p999 in ns, and the bucket counts */
+  std::string ToJson() const;
+};
+
+}  // namespace bustub
@@ -10,11 +10,13 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <atomic>
 #include <queue>
 #include <string>
 #include <vector>
 
 #include "concurrency/transaction.h"
+#include "recovery/log_manager.h"
 #include "storage/index/index_iterator.h"
 #include "storage/page/b_plus_tree_internal_page.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
@@ -39,16 +41,20 @@ class BPlusTree {
   using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
 
  public:
+  // With a log manager and enable_logging on, every Insert and Remove appends a log record, whose LSN every page it
+  // changes takes and the transaction, if any, takes as its previous LSN. Flushing the log up to that LSN makes the
+  // operation durable, without writing any of the pages.
   explicit BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE);
+                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE,
+                     LogManager *log_manager = nullptr);
 
   // Returns true if this B+ tree has no keys and values.
   bool IsEmpty() const;
 
-  // Insert a key-value pair into this B+ tree.
+  // Insert a key-value pair into this B+ tree. Throws if the buffer pool is read-only.
   bool Insert(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
 
-  // Remove a key and its value from this B+ tree.
+  // Remove a key and its value from this B+ tree. Throws if the buffer pool is read-only.
   void Remove(const KeyType &key, Transaction *transaction = nullptr);
 
   // return the value associated with a given key
@@ -59,6 +65,10 @@ class BPlusTree {
   INDEXITERATOR_TYPE Begin(const KeyType &key);
   INDEXITERATOR_TYPE end();
 
+  // Pick up the root of an index built earlier from the header page, e.g. to read a copy of it through a
+  // MmapBufferPoolManager. Returns false if the header page has no record of this index.
+  bool LoadRootPageId();
+
   void Print(BufferPoolManager *bpm) {
     ToString(reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(root_page_id_)->GetData()), bpm);
   }
@@ -80,15 +90,19 @@ class BPlusTree {
   Page *FindLeafPage(const KeyType &key, bool leftMost = false);
 
  private:
-  void StartNewTree(const KeyType &key, const ValueType &value);
+  void StartNewTree(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
 
   bool InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
 
   void InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
                         Transaction *transaction = nullptr);
 
+  PageHandle FindLeaf(const KeyType &key, bool leftMost, AccessType access_type = AccessType::NORMAL);
+
+  PageHandle FindLeafOptimistic(const KeyType &key, bool leftMost);
+
   template <typename N>
-  N *Split(N *node);
+  PageHandle Split(N *node, page_id_t latched_child = INVALID_PAGE_ID);
 
   template <typename N>
   bool CoalesceOrRedistribute(N *node, Transaction *transaction = nullptr);
@@ -104,18 +118,27 @@ class BPlusTree {
 
   void UpdateRootPageId(int insert_record = 0);
 
+  // Append the log record of an insert or remove of key, if logging is on. Returns its LSN, INVALID_LSN if nothing
+  // was logged.
+  lsn_t LogOperation(LogRecordType type, const KeyType &key, const ValueType &value, Transaction *transaction);
+
   /* Debug Routines for FREE!! */
   void ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstream &out) const;
 
   void ToString(BPlusTreePage *page, BufferPoolManager *bpm) const;
 
+  // optimistic descents that fail validation before FindLeaf pins its way down instead
+  static constexpr int OPTIMISTIC_ATTEMPTS = 8;
+
   // member variable
   std::string index_name_;
-  page_id_t root_page_id_;
+  // published with a release store once the root page is initialized, for the latch-free descent to load with acquire
+  std::atomic<page_id_t> root_page_id_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
   int leaf_max_size_;
   int internal_max_size_;
+  LogManager *log_manager_;
 };
 
 }  // namespace bustub
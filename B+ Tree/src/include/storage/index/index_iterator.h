@@ -13,6 +13,8 @@
  * For range scan of b+ tree
  */
 #pragma once
+#include <deque>
+
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 namespace bustub {
@@ -22,7 +24,31 @@ namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
  public:
-  IndexIterator(BufferPoolManager *bpm, page_id_t page_id, int i);
+  /** Default number of leaves read ahead of the one the iterator is on. */
+  static constexpr size_t DEFAULT_READ_AHEAD = 4;
+
+  /**
+   * @param bpm the buffer pool holding the tree
+   * @param page_id the leaf the iterator starts on, INVALID_PAGE_ID for end()
+   * @param i the index in that leaf
+   * @param read_ahead how many of the following leaves to prefetch, 0 to turn read-ahead off
+   */
+  IndexIterator(BufferPoolManager *bpm, page_id_t page_id, int i, size_t read_ahead = DEFAULT_READ_AHEAD);
+
+  /**
+   * @param bpm the buffer pool holding the tree
+   * @param leaf a handle on the leaf the iterator starts on, e.g. from the search that found it; the iterator takes
+   * over its pin
+   * @param i the index in that leaf
+   * @param read_ahead how many of the following leaves to prefetch, 0 to turn read-ahead off
+   */
+  IndexIterator(BufferPoolManager *bpm, PageHandle leaf, int i, size_t read_ahead = DEFAULT_READ_AHEAD);
+
+  /** A copy pins the current leaf once more. */
+  IndexIterator(const IndexIterator &other);
+  IndexIterator &operator=(const IndexIterator &other);
+  IndexIterator(IndexIterator &&other) = default;
+  IndexIterator &operator=(IndexIterator &&other) = default;
   ~IndexIterator() = default;
 
   bool isEnd();
@@ -36,9 +62,22 @@ class IndexIterator {
   bool operator!=(const IndexIterator &itr) const;
 
  private:
+  /**
+   * Keep up to read_ahead_ leaves after the current one prefetched. Called whenever the iterator moves onto a leaf.
+   * Leaf ids are only known from the previous leaf's next page id, so the window grows one leaf at a time, and only
+   * through leaves that are loaded already: the scan never waits for a read it did not need yet. Those leaves are read
+   * with PeekPage rather than pinned, so they keep the rank their prefetch gave them until the iterator gets to them.
+   */
+  void ReadAhead();
+
   page_id_t current_page_id_;
+  /** Pin on the current leaf, held until the iterator moves off it, so that stepping within a leaf is free. */
+  PageHandle current_page_;
   BufferPoolManager *buffer_pool_manager_;
   int index_;
+  size_t read_ahead_;
+  /** Leaves after the current one that have been prefetched, in chain order. */
+  std::deque<page_id_t> ahead_;
 };
 
 }  // namespace bustub
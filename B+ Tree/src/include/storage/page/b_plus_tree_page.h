@@ -60,12 +60,13 @@ class BPlusTreePage {
   page_id_t GetPageId() const;
   void SetPageId(page_id_t page_id);
 
+  lsn_t GetLSN() const;
   void SetLSN(lsn_t lsn = INVALID_LSN);
 
  private:
   // member variable, attributes that both internal and leaf page share
   IndexPageType page_type_ __attribute__((__unused__));
-  lsn_t lsn_ __attribute__((__unused__)); // not used in this project
+  lsn_t lsn_; // LSN of the last log record whose change is in this page
   int size_ __attribute__((__unused__)); // Number of Key & Value pairs in page.
   int max_size_ __attribute__((__unused__)); // Max number of Key & Value pairs in page
   page_id_t parent_page_id_ __attribute__((__unused__)); // Parent Page Id - id of the parent node’s page
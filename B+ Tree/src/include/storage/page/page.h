@@ -0,0 +1,134 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page.h
+//
+// Identification: src/include/storage/page/page.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+#include "common/config.h"
+#include "common/rwlatch.h"
+
+namespace bustub {
+
+/**
+ * Page is the basic unit of storage within the database system. Page provides a wrapper for actual data pages being
+ * held in main memory. Page also contains book-keeping information that is used by the buffer pool manager, e.g.
+ * pin count, dirty flag, page id, etc.
+ *
+ * Every page also has a version, which works like a seqlock: it is odd while the page is being written, i.e. between
+ * WLatch and WUnlatch, or while the buffer pool moves a different page into the frame, and it changes with every such
+ * write. A reader that neither pins nor latches the page can take the version with GetVersion, read the page, and
+ * then ask ValidateVersion whether what it read is consistent. Until that returns true, anything read from the page
+ * may be torn and must only be used in ways that stay within the page.
+ */
+class Page {
+  // There is book-keeping information inside the page that should only be relevant to the buffer pool manager.
+  friend class BufferPoolManagerInstance;
+  friend class MmapBufferPoolManager;
+
+ public:
+  /** Constructor. The page has no data until the buffer pool manager attaches a frame to it. */
+  Page() = default;
+
+  /** Default destructor. */
+  ~Page() = default;
+
+  /** @return the actual data contained within this page */
+  inline char *GetData() { return data_; }
+
+  /** @return the page id of this page */
+  inline page_id_t GetPageId() { return page_id_; }
+
+  /** @return the pin count of this page */
+  inline int GetPinCount() { return pin_count_; }
+
+  /** @return true if the page in memory has been modified from the page on disk, false otherwise */
+  inline bool IsDirty() { return is_dirty_; }
+
+  /** Acquire the page write latch. Optimistic readers of the page fail to validate until WUnlatch. */
+  inline void WLatch() {
+    rwlatch_.WLock();
+    BeginWrite();
+  }
+
+  /** Release the page write latch. */
+  inline void WUnlatch() {
+    EndWrite();
+    rwlatch_.WUnlock();
+  }
+
+  /** Acquire the page read latch. */
+  inline void RLatch() { rwlatch_.RLock(); }
+
+  /** Release the page read latch. */
+  inline void RUnlatch() { rwlatch_.RUnlock(); }
+
+  /** @return the page LSN. */
+  inline lsn_t GetLSN() { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
+
+  /** Sets the page LSN. */
+  inline void SetLSN(lsn_t lsn) { memcpy(GetData() + OFFSET_LSN, &lsn, sizeof(lsn_t)); }
+
+  /** @return the page version, to be checked with ValidateVersion after reading the page; odd during a write */
+  inline uint64_t GetVersion() const { return version_.load(std::memory_order_acquire); }
+
+  /**
+   * @param version what GetVersion returned before the page was read
+   * @return true if no write was in progress at GetVersion and none has started since, i.e. the reads in between saw
+   * a consistent page
+   */
+  inline bool ValidateVersion(uint64_t version) const {
+    // orders the reads of the page before the reload of the version
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return (version & 1) == 0 && version_.load(std::memory_order_relaxed) == version;
+  }
+
+ protected:
+  static_assert(sizeof(page_id_t) == 4);
+  static_assert(sizeof(lsn_t) == 4);
+
+  static constexpr size_t SIZE_PAGE_HEADER = 8;
+  static constexpr size_t OFFSET_PAGE_START = 0;
+  static constexpr size_t OFFSET_LSN = 4;
+
+ private:
+  /** Make the version odd: optimistic readers fail from here until EndWrite. */
+  inline void BeginWrite() {
+    version_.fetch_add(1, std::memory_order_relaxed);
+    // orders the version change before the writes that follow
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+  /** Make the version even again, publishing the writes since BeginWrite. */
+  inline void EndWrite() { version_.fetch_add(1, std::memory_order_release); }
+
+  /** Zeroes out the data that is held within the page. */
+  inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }
+
+  /** The actual data that is stored within a page: PAGE_SIZE bytes in the buffer pool's FrameArena. */
+  char *data_{nullptr};
+  /** The ID of this page. */
+  page_id_t page_id_ = INVALID_PAGE_ID;
+  /** The pin count of this page. Changed under the buffer pool latch; atomic so a BatchedReplacer may read it without. */
+  std::atomic<int> pin_count_{0};
+  /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
+  bool is_dirty_ = false;
+  /** Page latch. */
+  ReaderWriterLatch rwlatch_;
+  /** Seqlock version; odd while a write is in progress. */
+  std::atomic<uint64_t> version_{0};
+};
+
+}  // namespace bustub
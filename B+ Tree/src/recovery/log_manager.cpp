@@ -0,0 +1,183 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_manager.cpp
+//
+// Identification: src/recovery/log_manager.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "recovery/log_manager.h"
+
+#include <cstring>
+#include <utility>
+
+#include "common/macros.h"
+
+namespace bustub {
+/*
+ * set enable_logging = true
+ * Start a separate thread to execute flush to disk operation periodically
+ * The flush can be triggered when timeout or the log buffer is full or buffer
+ * pool manager wants to force flush (it only happens when the flushed page has
+ * a larger LSN than persistent LSN)
+ *
+ * This thread runs forever until system shutdown/StopFlushThread
+ */
+void LogManager::RunFlushThread() {
+  std::scoped_lock latch{latch_};
+  if (flush_thread_ != nullptr) {
+    return;
+  }
+  enable_logging = true;
+  stop_flush_thread_ = false;
+  flush_thread_ = new std::thread(&LogManager::FlushLoop, this);
+}
+
+/*
+ * Stop and join the flush thread, set enable_logging = false
+ */
+void LogManager::StopFlushThread() {
+  std::thread *flush_thread;
+  {
+    std::scoped_lock latch{latch_};
+    if (flush_thread_ == nullptr || stop_flush_thread_) {
+      return;
+    }
+    enable_logging = false;
+    stop_flush_thread_ = true;
+    flush_thread = flush_thread_;
+  }
+  cv_.notify_one();
+  flush_thread->join();
+  delete flush_thread;
+  std::scoped_lock latch{latch_};
+  flush_thread_ = nullptr;
+}
+
+/*
+ * append a log record into log buffer
+ * you MUST set the log record's lsn within this method
+ * @return: lsn that is assigned to this log record
+ */
+lsn_t LogManager::AppendLogRecord(LogRecord *log_record) {
+  BUSTUB_ASSERT(log_record->size_ <= LOG_BUFFER_SIZE, "log record does not fit into the log buffer");
+  std::unique_lock latch{latch_};
+  while (log_buffer_size_ + log_record->size_ > LOG_BUFFER_SIZE) {
+    AwaitWrite(&latch, next_lsn_ - 1);
+  }
+
+  // First, serialize the must have fields(20 bytes in total)
+  log_record->lsn_ = next_lsn_++;
+  char *pos = log_buffer_ + log_buffer_size_;
+  memcpy(pos, log_record, LogRecord::HEADER_SIZE);
+  pos += LogRecord::HEADER_SIZE;
+
+  switch (log_record->log_record_type_) {
+    case LogRecordType::INSERT:
+      memcpy(pos, &log_record->insert_rid_, sizeof(RID));
+      pos += sizeof(RID);
+      // we have provided serialize function for tuple class
+      log_record->insert_tuple_.SerializeTo(pos);
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      memcpy(pos, &log_record->delete_rid_, sizeof(RID));
+      pos += sizeof(RID);
+      log_record->delete_tuple_.SerializeTo(pos);
+      break;
+    case LogRecordType::UPDATE:
+      memcpy(pos, &log_record->update_rid_, sizeof(RID));
+      pos += sizeof(RID);
+      log_record->old_tuple_.SerializeTo(pos);
+      pos += sizeof(int32_t) + log_record->old_tuple_.GetLength();
+      log_record->new_tuple_.SerializeTo(pos);
+      break;
+    case LogRecordType::NEWPAGE:
+      memcpy(pos, &log_record->prev_page_id_, sizeof(page_id_t));
+      break;
+    case LogRecordType::INDEXINSERT:
+    case LogRecordType::INDEXDELETE: {
+      memcpy(pos, &log_record->index_rid_, sizeof(RID));
+      pos += sizeof(RID);
+      for (const std::string *bytes : {&log_record->index_name_, &log_record->index_key_}) {
+        auto size = static_cast<int32_t>(bytes->size());
+        memcpy(pos, &size, sizeof(int32_t));
+        memcpy(pos + sizeof(int32_t), bytes->data(), size);
+        pos += sizeof(int32_t) + size;
+      }
+      break;
+    }
+    default:
+      break;
+  }
+  log_buffer_size_ += log_record->size_;
+  return log_record->lsn_;
+}
+
+bool LogManager::Flush(lsn_t lsn) {
+  if (lsn <= persistent_lsn_) {
+    return false;
+  }
+  std::unique_lock latch{latch_};
+  lsn = std::min<lsn_t>(lsn, next_lsn_ - 1);
+  if (lsn <= persistent_lsn_) {
+    return false;
+  }
+  while (lsn > persistent_lsn_) {
+    AwaitWrite(&latch, lsn);
+  }
+  return true;
+}
+
+void LogManager::FlushLoop() {
+  std::unique_lock latch{latch_};
+  while (!stop_flush_thread_) {
+    // a batch is whatever was appended while the last one was being written
+    cv_.wait_for(latch, log_timeout, [this] { return stop_flush_thread_ || flush_requested_lsn_ > persistent_lsn_; });
+    WriteBuffer(&latch);
+  }
+  // what is still buffered goes out before the thread stops; once stop_flush_thread_ is set, Flush writes on its own
+  WriteBuffer(&latch);
+}
+
+void LogManager::WriteBuffer(std::unique_lock<std::mutex> *latch) {
+  // flush_buffer_ may still be being written by a Flush that ran without the thread, e.g. before RunFlushThread
+  while (writing_) {
+    flushed_cv_.wait(*latch);
+  }
+  if (log_buffer_size_ == 0) {
+    return;
+  }
+  // appends go on into the other buffer during the write; the records are appended in LSN order, so the last one
+  // written is the last one appended
+  std::swap(log_buffer_, flush_buffer_);
+  auto size = static_cast<int>(log_buffer_size_);
+  lsn_t last_lsn = next_lsn_ - 1;
+  log_buffer_size_ = 0;
+  writing_ = true;
+  latch->unlock();
+  disk_manager_->WriteLog(flush_buffer_, size);
+  latch->lock();
+  writing_ = false;
+  persistent_lsn_ = last_lsn;
+  flushed_cv_.notify_all();
+}
+
+void LogManager::AwaitWrite(std::unique_lock<std::mutex> *latch, lsn_t lsn) {
+  if (flush_thread_ != nullptr && !stop_flush_thread_) {
+    flush_requested_lsn_ = std::max(flush_requested_lsn_, lsn);
+    cv_.notify_one();
+    flushed_cv_.wait(*latch);
+  } else if (writing_) {
+    flushed_cv_.wait(*latch);
+  } else {
+    WriteBuffer(latch);
+  }
+}
+
+}  // namespace bustub
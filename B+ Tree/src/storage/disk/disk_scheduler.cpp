@@ -0,0 +1,278 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler.cpp
+//
+// Identification: src/storage/disk/disk_scheduler.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_scheduler.h"
+
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <utility>
+
+#include "common/logger.h"
+
+namespace bustub {
+
+namespace {
+bool IsAligned(const char *data) { return reinterpret_cast<uintptr_t>(data) % DiskScheduler::DIRECT_IO_ALIGNMENT == 0; }
+
+/** PAGE_SIZE bytes aligned for direct I/O, freed when they go out of scope; null if out of memory. */
+std::unique_ptr<char, decltype(&std::free)> AlignedPage() {
+  return {static_cast<char *>(std::aligned_alloc(DiskScheduler::DIRECT_IO_ALIGNMENT, PAGE_SIZE)), &std::free};
+}
+}  // namespace
+
+DiskScheduler::DiskScheduler(DiskManager *disk_manager, size_t queue_depth, const std::string &db_file, bool direct_io)
+    : disk_manager_(disk_manager) {
+  if (!db_file.empty() && direct_io) {
+#ifdef O_DIRECT
+    fd_ = open(db_file.c_str(), O_RDWR | O_CREAT | O_DIRECT, 0644);
+    direct_io_ = fd_ >= 0;
+    if (fd_ < 0) {
+      LOG_WARN("DiskScheduler: cannot open %s with O_DIRECT (%s), using buffered I/O", db_file.c_str(),
+               strerror(errno));
+    }
+#else
+    LOG_WARN("DiskScheduler: O_DIRECT is not supported on this platform, using buffered I/O");
+#endif
+  }
+  if (!db_file.empty() && fd_ < 0) {
+    fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ < 0) {
+      LOG_WARN("DiskScheduler: cannot open %s (%s), leaving the I/O to the DiskManager", db_file.c_str(),
+               strerror(errno));
+    }
+  }
+  // io_uring would let a single thread keep queue_depth requests in flight; without it, each in-flight request
+  // occupies one I/O thread.
+  queue_depth = std::max<size_t>(queue_depth, 1);
+  workers_.reserve(queue_depth);
+  for (size_t i = 0; i < queue_depth; i++) {
+    workers_.emplace_back(&DiskScheduler::WorkerLoop, this);
+  }
+}
+
+DiskScheduler::~DiskScheduler() {
+  {
+    std::scoped_lock latch{latch_};
+    stop_ = true;
+  }
+  cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+}
+
+void DiskScheduler::Schedule(DiskRequest r) {
+  r.submit_time_ = std::chrono::steady_clock::now();
+  {
+    std::scoped_lock latch{latch_};
+    queue_.push_back(std::move(r));
+    stats_.in_flight_++;
+  }
+  cv_.notify_one();
+}
+
+bool DiskScheduler::ReadPage(page_id_t page_id, char *page_data) {
+  auto promise = CreatePromise();
+  auto future = promise.get_future();
+  Schedule({false, page_data, page_id, std::move(promise), nullptr, {}, {}});
+  return future.get();
+}
+
+bool DiskScheduler::WritePage(page_id_t page_id, char *page_data) {
+  auto promise = CreatePromise();
+  auto future = promise.get_future();
+  Schedule({true, page_data, page_id, std::move(promise), nullptr, {}, {}});
+  return future.get();
+}
+
+DiskSchedulerStats DiskScheduler::GetStats() {
+  std::scoped_lock latch{latch_};
+  return stats_;
+}
+
+void DiskScheduler::WorkerLoop() {
+  std::unique_lock latch{latch_};
+  while (true) {
+    cv_.wait(latch, [this] { return stop_ || !queue_.empty(); });
+    if (queue_.empty()) {
+      // stop_ is set and everything scheduled before it has been picked up
+      return;
+    }
+    DiskRequest r = std::move(queue_.front());
+    queue_.pop_front();
+    latch.unlock();
+    Execute(&r);
+    latch.lock();
+  }
+}
+
+void DiskScheduler::Execute(DiskRequest *r) {
+  bool ok = true;
+  if (fd_ >= 0) {
+    if (r->is_write_) {
+      ok = r->iov_.empty() ? WriteFile(r->page_id_, &r->data_, 1)
+                           : WriteFile(r->page_id_, r->iov_.data(), r->iov_.size());
+    } else {
+      ok = r->iov_.empty() ? ReadFile(r->page_id_, &r->data_, 1)
+                           : ReadFile(r->page_id_, r->iov_.data(), r->iov_.size());
+    }
+  } else if (!r->iov_.empty()) {
+    // DiskManager reads and writes one page at a time, so a run still costs a call per page, but only one trip through
+    // the queue; with the file open, the whole run goes to preadv / pwritev
+    for (size_t i = 0; i < r->iov_.size(); i++) {
+      auto page_id = r->page_id_ + static_cast<page_id_t>(i);
+      if (r->is_write_) {
+        disk_manager_->WritePage(page_id, r->iov_[i]);
+      } else {
+        disk_manager_->ReadPage(page_id, r->iov_[i]);
+      }
+    }
+  } else if (r->is_write_) {
+    disk_manager_->WritePage(r->page_id_, r->data_);
+  } else {
+    disk_manager_->ReadPage(r->page_id_, r->data_);
+  }
+  auto latency = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - r->submit_time_).count());
+  {
+    std::scoped_lock latch{latch_};
+    if (r->is_write_) {
+      stats_.writes_++;
+      stats_.pages_written_ += std::max<size_t>(r->iov_.size(), 1);
+      stats_.total_write_ns_ += latency;
+      stats_.max_write_ns_ = std::max(stats_.max_write_ns_, latency);
+      stats_.write_latency_.Record(latency);
+    } else {
+      stats_.reads_++;
+      stats_.pages_read_ += std::max<size_t>(r->iov_.size(), 1);
+      stats_.total_read_ns_ += latency;
+      stats_.max_read_ns_ = std::max(stats_.max_read_ns_, latency);
+      stats_.read_latency_.Record(latency);
+    }
+    stats_.in_flight_--;
+  }
+  // DiskManager reports I/O errors through its log rather than to the caller, so its requests always count as done;
+  // errors on fd_ are passed on
+  if (r->on_complete_) {
+    r->on_complete_(ok, latency);
+  }
+  r->callback_.set_value(ok);
+}
+
+bool DiskScheduler::ReadFile(page_id_t page_id, char *const *pages, size_t count) {
+  // with O_DIRECT, unaligned pages are read into bounce buffers and copied out at the end
+  std::vector<std::unique_ptr<char, decltype(&std::free)>> bounces;
+  std::vector<iovec> iov(count);
+  for (size_t i = 0; i < count; i++) {
+    char *buffer = pages[i];
+    if (direct_io_ && !IsAligned(buffer)) {
+      bounces.push_back(AlignedPage());
+      if (bounces.back() == nullptr) {
+        LOG_WARN("DiskScheduler: no memory for a bounce buffer reading page %d", page_id + static_cast<page_id_t>(i));
+        return false;
+      }
+      buffer = bounces.back().get();
+    }
+    iov[i] = {buffer, PAGE_SIZE};
+  }
+  auto offset = static_cast<off_t>(page_id) * static_cast<off_t>(PAGE_SIZE);
+  size_t next = 0;
+  while (next < count) {
+    auto batch = static_cast<int>(std::min<size_t>(count - next, IOV_MAX));
+    ssize_t n = preadv(fd_, &iov[next], batch, offset + static_cast<off_t>(next * PAGE_SIZE));
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0) {
+      LOG_WARN("DiskScheduler: reading pages %d..%d: %s", page_id + static_cast<page_id_t>(next),
+               page_id + static_cast<page_id_t>(next) + batch - 1, strerror(errno));
+      return false;
+    }
+    if (n == 0) {
+      // past the end of the file
+      for (size_t i = next; i < count; i++) {
+        memset(iov[i].iov_base, 0, PAGE_SIZE);
+      }
+      break;
+    }
+    next += static_cast<size_t>(n) / PAGE_SIZE;
+    if (static_cast<size_t>(n) % PAGE_SIZE != 0) {
+      // pages are written whole, so the file was cut short in the middle of this one
+      LOG_WARN("DiskScheduler: short read of page %d", page_id + static_cast<page_id_t>(next));
+      return false;
+    }
+  }
+  for (size_t i = 0, b = 0; i < count; i++) {
+    if (direct_io_ && !IsAligned(pages[i])) {
+      memcpy(pages[i], bounces[b++].get(), PAGE_SIZE);
+    }
+  }
+  return true;
+}
+
+bool DiskScheduler::WriteFile(page_id_t page_id, char *const *pages, size_t count) {
+  std::vector<std::unique_ptr<char, decltype(&std::free)>> bounces;
+  std::vector<iovec> iov(count);
+  for (size_t i = 0; i < count; i++) {
+    char *buffer = pages[i];
+    if (direct_io_ && !IsAligned(buffer)) {
+      bounces.push_back(AlignedPage());
+      if (bounces.back() == nullptr) {
+        LOG_WARN("DiskScheduler: no memory for a bounce buffer writing page %d", page_id + static_cast<page_id_t>(i));
+        return false;
+      }
+      memcpy(bounces.back().get(), buffer, PAGE_SIZE);
+      buffer = bounces.back().get();
+    }
+    iov[i] = {buffer, PAGE_SIZE};
+  }
+  auto offset = static_cast<off_t>(page_id) * static_cast<off_t>(PAGE_SIZE);
+  size_t next = 0;
+  while (next < count) {
+    auto batch = static_cast<int>(std::min<size_t>(count - next, IOV_MAX));
+    ssize_t n = pwritev(fd_, &iov[next], batch, offset);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      LOG_WARN("DiskScheduler: writing pages %d..%d: %s", page_id + static_cast<page_id_t>(next),
+               page_id + static_cast<page_id_t>(next) + batch - 1, n < 0 ? strerror(errno) : "nothing written");
+      return false;
+    }
+    // a short write goes on from where it stopped: a block boundary with O_DIRECT, anywhere otherwise
+    offset += n;
+    auto written = static_cast<size_t>(n);
+    while (next < count && written >= iov[next].iov_len) {
+      written -= iov[next].iov_len;
+      next++;
+    }
+    if (written > 0) {
+      iov[next].iov_base = static_cast<char *>(iov[next].iov_base) + written;
+      iov[next].iov_len -= written;
+    }
+  }
+  return true;
+}
+
+}  // namespace bustub
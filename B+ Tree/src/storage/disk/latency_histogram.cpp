@@ -0,0 +1,87 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// latency_histogram.cpp
+//
+// Identification: src/storage/disk/latency_histogram.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/latency_histogram.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace bustub {
+
+namespace {
+/** @return the bucket of a latency: its bit width, capped at the last bucket */
+size_t BucketOf(uint64_t ns) {
+  size_t width = ns == 0 ? 0 : 64 - static_cast<size_t>(__builtin_clzll(ns));
+  return std::min(width, LatencyHistogram::NUM_BUCKETS - 1);
+}
+}  // namespace
+
+void LatencyHistogram::Record(uint64_t ns) {
+  buckets_[BucketOf(ns)]++;
+  count_++;
+  sum_ns_ += ns;
+  max_ns_ = std::max(max_ns_, ns);
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram &other) {
+  for (size_t i = 0; i < NUM_BUCKETS; i++) {
+    buckets_[i] += other.buckets_[i];
+  }
+  count_ += other.count_;
+  sum_ns_ += other.sum_ns_;
+  max_ns_ = std::max(max_ns_, other.max_ns_);
+}
+
+uint64_t LatencyHistogram::Percentile(double percentile) const {
+  if (count_ == 0) {
+    return 0;
+  }
+  // rank of the latency we are after, 1-based
+  auto rank = static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(count_) + 0.5);
+  rank = std::clamp<uint64_t>(rank, 1, count_);
+  uint64_t seen = 0;
+  for (size_t i = 0; i < NUM_BUCKETS; i++) {
+    seen += buckets_[i];
+    if (seen >= rank) {
+      // the upper end of bucket i is 2^i - 1
+      return std::min((uint64_t{1} << i) - 1, max_ns_);
+    }
+  }
+  return max_ns_;
+}
+
+std::string LatencyHistogram::ToString() const {
+  char buf[160];
+  snprintf(buf, sizeof(buf), "count=%llu mean_us=%.1f p50_us=%.1f p99_us=%.1f max_us=%.1f",
+           static_cast<unsigned long long>(count_), static_cast<double>(MeanNs()) / 1e3,  // NOLINT
+           static_cast<double>(Percentile(50)) / 1e3, static_cast<double>(Percentile(99)) / 1e3,
+           static_cast<double>(max_ns_) / 1e3);
+  return buf;
+}
+
+std::string LatencyHistogram::ToJson() const {
+  auto u64 = [](uint64_t value) { return std::to_string(value); };
+  std::string json = "{\"count\":" + u64(count_) + ",\"sum_ns\":" + u64(sum_ns_) + ",\"max_ns\":" + u64(max_ns_) +
+                     ",\"p50_ns\":" + u64(Percentile(50)) + ",\"p99_ns\":" + u64(Percentile(99)) +
+                     ",\"p999_ns\":" + u64(Percentile(99.9)) + ",\"buckets\":[";
+  // trailing empty buckets carry no information
+  size_t used = NUM_BUCKETS;
+  while (used > 0 && buckets_[used - 1] == 0) {
+    used--;
+  }
+  for (size_t i = 0; i < used; i++) {
+    json += (i == 0 ? "" : ",") + u64(buckets_[i]);
+  }
+  return json + "]}";
+}
+
+}  // namespace bustub
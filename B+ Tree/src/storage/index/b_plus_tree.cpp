@@ -9,8 +9,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <string>
 #include <iostream>
+#include <utility>
 
 #include "common/exception.h"
 #include "common/rid.h"
@@ -21,20 +23,21 @@ using namespace std;
 namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                          int leaf_max_size, int internal_max_size)
+                          int leaf_max_size, int internal_max_size, LogManager *log_manager)
     : index_name_(std::move(name)),
       root_page_id_(INVALID_PAGE_ID),
       buffer_pool_manager_(buffer_pool_manager),
       comparator_(comparator),
       leaf_max_size_(leaf_max_size),
-      internal_max_size_(internal_max_size) {}
+      internal_max_size_(internal_max_size),
+      log_manager_(log_manager) {}
 
 /*
  * Helper function to decide whether current b+tree is empty
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::IsEmpty() const { 
-  if (root_page_id_ == INVALID_PAGE_ID){
+  if (root_page_id_.load(std::memory_order_acquire) == INVALID_PAGE_ID){
     return true;
     }
   return false;
@@ -49,10 +52,12 @@ bool BPLUSTREE_TYPE::IsEmpty() const {
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) {
-  //Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
-  Page *page = FindLeafPage(key, false);
-  BPlusTreePage *bppage = reinterpret_cast<BPlusTreePage *>(page->GetData());
-  LeafPage *leaf = reinterpret_cast<LeafPage *>(bppage);
+  // the handle unpins the leaf on both returns
+  PageHandle page = FindLeaf(key, false);
+  if (!page) {
+    return false;
+  }
+  LeafPage *leaf = reinterpret_cast<LeafPage *>(page.GetData());
   ValueType value;
 
   if(leaf->Lookup(key, &value, comparator_)){
@@ -74,8 +79,13 @@ bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) {   
+  // the pages of a read-only pool cannot be written to at all, so don't even start
+  if (buffer_pool_manager_->IsReadOnly()) {
+    throw Exception(ExceptionType::INVALID,
+                    "BPlusTree: cannot insert into " + index_name_ + ", the buffer pool is read-only");
+  }
   if (IsEmpty()){
-    StartNewTree(key, value);
+    StartNewTree(key, value, transaction);
     return true;
     }
   bool status = InsertIntoLeaf(key, value, transaction);
@@ -88,17 +98,22 @@ bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
  * tree's root page id and insert entry directly into leaf page.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
-  Page* page = buffer_pool_manager_->NewPage(&root_page_id_);
-  if (page == nullptr){
+void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  // the root only becomes visible to readers once it is initialized
+  page_id_t root_page_id;
+  PageHandle page = buffer_pool_manager_->NewPageHandle(&root_page_id);
+  if (!page){
     throw "out of memory"; 
   }
-  BPlusTreePage *bppage = reinterpret_cast<BPlusTreePage *>(page->GetData());
-  LeafPage *root = reinterpret_cast<LeafPage *>(bppage);
-  root->Init(root_page_id_, INVALID_PAGE_ID, leaf_max_size_);
-  UpdateRootPageId(true);
+  LeafPage *root = reinterpret_cast<LeafPage *>(page.GetData());
+  page->WLatch();
+  root->Init(root_page_id, INVALID_PAGE_ID, leaf_max_size_);
+  root->SetLSN(LogOperation(LogRecordType::INDEXINSERT, key, value, transaction));
   root->Insert(key, value, comparator_);
-  buffer_pool_manager_->UnpinPage(root_page_id_, true);
+  page->WUnlatch();
+  root_page_id_.store(root_page_id, std::memory_order_release);
+  UpdateRootPageId(true);
+  page.MarkDirty();
 }
 
 /*
@@ -111,21 +126,26 @@ void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction) {
-  Page *page = FindLeafPage(key, false);
-  BPlusTreePage *bppage = reinterpret_cast<BPlusTreePage *>(page->GetData());
-  LeafPage * leaf_page = reinterpret_cast<LeafPage *> (bppage);
+  PageHandle page = FindLeaf(key, false);
+  LeafPage * leaf_page = reinterpret_cast<LeafPage *> (page.GetData());
   ValueType dummy;
   bool status = leaf_page->Lookup(key, &dummy, comparator_);
   if (status){
-    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
     return false;
   }
+  // the write latch also makes optimistic readers of the leaf retry
+  page->WLatch();
+  // logged under the latch, so the leaf's changes are in LSN order
+  lsn_t lsn = LogOperation(LogRecordType::INDEXINSERT, key, value, transaction);
+  leaf_page->SetLSN(std::max(leaf_page->GetLSN(), lsn));
   leaf_page->Insert(key, value, comparator_);
+  page.MarkDirty();
   if (leaf_page->GetSize() > leaf_page->GetMaxSize()){
-    LeafPage *new_page = Split(leaf_page);
-    InsertIntoParent(leaf_page, new_page->KeyAt(0), new_page, transaction);
+    PageHandle new_page = Split(leaf_page);
+    LeafPage *new_leaf_page = reinterpret_cast<LeafPage *>(new_page.GetData());
+    InsertIntoParent(leaf_page, new_leaf_page->KeyAt(0), new_leaf_page, transaction);
   }
-  buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);
+  page->WUnlatch();
   return true;
 }
 
@@ -136,33 +156,36 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
  * an "out of memory" exception if returned value is nullptr), then move half
  * of key & value pairs from input page to newly created page
+ * @return: the handle on the newly created page, which is marked dirty
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-N *BPLUSTREE_TYPE::Split(N *node) {
+PageHandle BPLUSTREE_TYPE::Split(N *node, page_id_t latched_child) {
   // gg
   page_id_t new_page_id;
-  Page* page = buffer_pool_manager_->NewPage(&new_page_id);
-  if (page == nullptr){
+  PageHandle page = buffer_pool_manager_->NewPageHandle(&new_page_id);
+  if (!page){
     throw "out of memory"; 
   }
+  page.MarkDirty();
 
-  BPlusTreePage *bppage = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  BPlusTreePage *bppage = reinterpret_cast<BPlusTreePage *>(page.GetData());
+  // the new page is part of the operation that changed node; an internal node's children moving here take this LSN
+  bppage->SetLSN(node->GetLSN());
   
   if(node->IsLeafPage()){
     LeafPage *old = reinterpret_cast<LeafPage *>(node);
     LeafPage *new_leaf_page = reinterpret_cast<LeafPage *>(bppage);
     new_leaf_page->Init(new_page_id, old->GetParentPageId(), leaf_max_size_);
     old->MoveHalfTo(new_leaf_page);
-    return reinterpret_cast<N *>(new_leaf_page);
   }
   else{
     InternalPage *old = reinterpret_cast<InternalPage *>(node);
     InternalPage *new_internal_page = reinterpret_cast<InternalPage *>(bppage);
     new_internal_page->Init(new_page_id, old->GetParentPageId(), internal_max_size_);
-    old->MoveHalfTo(new_internal_page, buffer_pool_manager_);
-    return reinterpret_cast<N *>(new_internal_page);
+    old->MoveHalfTo(new_internal_page, buffer_pool_manager_, latched_child);
   }
+  return page;
 }
 
 /*
@@ -173,37 +196,47 @@ N *BPLUSTREE_TYPE::Split(N *node) {
  * User needs to first find the parent page of old_node, parent node must be
  * adjusted to take info of new_node into account. Remember to deal with split
  * recursively if necessary.
+ * Both nodes stay pinned by the caller, who marks them dirty.
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node, Transaction *transaction) {
   if (old_node->IsRootPage()){
-    Page* new_page = buffer_pool_manager_->NewPage(&root_page_id_);
-    BPlusTreePage *bppage = reinterpret_cast<BPlusTreePage *>(new_page->GetData());
-    InternalPage *new_root_page = reinterpret_cast<InternalPage *>(bppage);
-    new_root_page->Init(root_page_id_, INVALID_PAGE_ID, internal_max_size_);
-    UpdateRootPageId(false);
+    // as in StartNewTree, the new root is published only once it is initialized
+    page_id_t root_page_id;
+    PageHandle new_page = buffer_pool_manager_->NewPageHandle(&root_page_id);
+    if (!new_page){
+      throw "out of memory"; 
+    }
+    InternalPage *new_root_page = reinterpret_cast<InternalPage *>(new_page.GetData());
+    new_page->WLatch();
+    new_root_page->Init(root_page_id, INVALID_PAGE_ID, internal_max_size_);
+    new_root_page->SetLSN(old_node->GetLSN());
     new_root_page->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
-    old_node->SetParentPageId(root_page_id_);
-    new_node->SetParentPageId(root_page_id_);
-    buffer_pool_manager_->UnpinPage(new_root_page->GetPageId(), true);
+    new_page->WUnlatch();
+    old_node->SetParentPageId(root_page_id);
+    new_node->SetParentPageId(root_page_id);
+    root_page_id_.store(root_page_id, std::memory_order_release);
+    UpdateRootPageId(false);
+    new_page.MarkDirty();
   }
   else{
-    Page *parent = buffer_pool_manager_->FetchPage(old_node->GetParentPageId());
-    BPlusTreePage *bppage = reinterpret_cast<BPlusTreePage *>(parent->GetData());
-    InternalPage *parent_page = reinterpret_cast<InternalPage *>(bppage);
+    PageHandle parent = buffer_pool_manager_->FetchPageHandle(old_node->GetParentPageId());
+    InternalPage *parent_page = reinterpret_cast<InternalPage *>(parent.GetData());
+    parent->WLatch();
     // If, after insertion, the parent’s size is above its max size, it should split and make
     // a recursive call to InsertIntoParent
     parent_page->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
+    parent_page->SetLSN(std::max(parent_page->GetLSN(), old_node->GetLSN()));
     new_node->SetParentPageId(parent_page->GetPageId()); 
+    parent.MarkDirty();
     if (parent_page->GetSize() > parent_page->GetMaxSize()){
-      InternalPage *new_page = Split(parent_page);
-      InsertIntoParent(parent_page, new_page->KeyAt(0), new_page, transaction);
-      buffer_pool_manager_->UnpinPage(new_page->GetPageId(), true);
+      // old_node is one of the children the split moves, and its write latch is ours already
+      PageHandle new_page = Split(parent_page, old_node->GetPageId());
+      InternalPage *new_internal_page = reinterpret_cast<InternalPage *>(new_page.GetData());
+      InsertIntoParent(parent_page, new_internal_page->KeyAt(0), new_internal_page, transaction);
     }
-    buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
+    parent->WUnlatch();
   }
-  buffer_pool_manager_->UnpinPage(new_node->GetPageId(), true);
-  
 }
 
 /*****************************************************************************
@@ -218,16 +251,28 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
+  if (buffer_pool_manager_->IsReadOnly()) {
+    throw Exception(ExceptionType::INVALID,
+                    "BPlusTree: cannot remove from " + index_name_ + ", the buffer pool is read-only");
+  }
   if(IsEmpty()){
     return;
   }
-  Page *page = FindLeafPage(key, false);
-  BPlusTreePage *bppage = reinterpret_cast<BPlusTreePage *>(page->GetData());
-  LeafPage *leaf_page = reinterpret_cast<LeafPage *>(bppage);
+  PageHandle page = FindLeaf(key, false);
+  LeafPage *leaf_page = reinterpret_cast<LeafPage *>(page.GetData());
 
+  page->WLatch();
+  // nothing to log, and the page stays clean, if the key is not there; otherwise the record carries the value removed
+  ValueType value;
+  if (!leaf_page->Lookup(key, &value, comparator_)) {
+    page->WUnlatch();
+    return;
+  }
+  lsn_t lsn = LogOperation(LogRecordType::INDEXDELETE, key, value, transaction);
+  leaf_page->SetLSN(std::max(leaf_page->GetLSN(), lsn));
   leaf_page->RemoveAndDeleteRecord(key, comparator_);
-
-  buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);
+  page->WUnlatch();
+  page.MarkDirty();
 
 }
 
@@ -299,9 +344,13 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) { return false; }
  */
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::begin() {
-  KeyType dummy;
-  Page *page = FindLeafPage(dummy, true);
-  return INDEXITERATOR_TYPE(buffer_pool_manager_, page->GetPageId(), 0);
+  KeyType dummy{};
+  // this is the start of a scan; the iterator takes over the pin on the leaf
+  PageHandle page = FindLeaf(dummy, true, AccessType::SCAN);
+  if (!page) {
+    return end();
+  }
+  return INDEXITERATOR_TYPE(buffer_pool_manager_, std::move(page), 0);
 }
 
 /*
@@ -311,9 +360,13 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::begin() {
  */
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
-  Page *page = FindLeafPage(key);
-  LeafPage *leaf = reinterpret_cast<LeafPage *>(page->GetData());
-  return INDEXITERATOR_TYPE(buffer_pool_manager_, page->GetPageId(), leaf->KeyIndex(key, comparator_));
+  PageHandle page = FindLeaf(key, false, AccessType::SCAN);
+  if (!page) {
+    return end();
+  }
+  LeafPage *leaf = reinterpret_cast<LeafPage *>(page.GetData());
+  int index = leaf->KeyIndex(key, comparator_);
+  return INDEXITERATOR_TYPE(buffer_pool_manager_, std::move(page), index);
 }
 
 /*
@@ -334,28 +387,109 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::end() { return INDEXITERATOR_TYPE(buffer_pool
 
 INDEX_TEMPLATE_ARGUMENTS
 Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) {
+  // the caller unpins the leaf
+  return FindLeaf(key, leftMost).Detach();
+}
+
+/*
+ * FindLeafPage returning a handle on the leaf. The descent is optimistic
+ * first; if that keeps failing, or runs into a page that is not resident, the
+ * internal pages are pinned on the way down instead and unpinned as soon as
+ * the search moves past them.
+ * @param access_type hint passed on when the leaf is unpinned, e.g. SCAN at the
+ * start of a range scan
+ */
+INDEX_TEMPLATE_ARGUMENTS
+PageHandle BPLUSTREE_TYPE::FindLeaf(const KeyType &key, bool leftMost, AccessType access_type) {
   if (IsEmpty()){
-    return nullptr;
+    return {};
+  }
+  PageHandle page = FindLeafOptimistic(key, leftMost);
+  if (page){
+    page.SetAccessType(access_type);
+    return page;
+  }
+  page = buffer_pool_manager_->FetchPageHandle(root_page_id_.load(std::memory_order_acquire));
+  if (!page){
+    throw "no child found";
   }
-  Page *root = buffer_pool_manager_->FetchPage(root_page_id_);
-  BPlusTreePage *bppage = reinterpret_cast<BPlusTreePage *>(root->GetData());
-  InternalPage *internal_page = reinterpret_cast<InternalPage *>(bppage);
-  page_id_t child_page_id = root_page_id_; 
+  InternalPage *internal_page = reinterpret_cast<InternalPage *>(page.GetData());
   while(!internal_page->IsLeafPage())
   {
-    if (internal_page == nullptr){
-      throw "no child found";
-    }
-    page_id_t parent_page_id = child_page_id;
+    page_id_t child_page_id;
     if (leftMost){
       child_page_id = internal_page->ValueAt(0);
     } else{
       child_page_id = internal_page->Lookup(key, comparator_);
     }
-    buffer_pool_manager_->UnpinPage(parent_page_id, false);
-    internal_page = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(child_page_id)->GetData());
+    PageHandle child = buffer_pool_manager_->FetchPageHandle(child_page_id);
+    if (!child){
+      throw "no child found";
+    }
+    // unpins the parent
+    page = std::move(child);
+    internal_page = reinterpret_cast<InternalPage *>(page.GetData());
+  }
+  page.SetAccessType(access_type);
+  return page;
+}
+
+/*
+ * Descend to the leaf without pinning or latching the internal pages: each one
+ * is found with PeekPage and read optimistically, and its version is validated
+ * before the search moves on. The parent is validated again after the child's
+ * version is taken, so the child is known to be the one the parent pointed to
+ * at that time. Only the leaf is pinned, and its version is validated once
+ * more after the pin, so no concurrent write went unnoticed on the way down.
+ * @return: the pinned leaf, an empty handle if the caller should fall back to
+ * the pessimistic descent
+ */
+INDEX_TEMPLATE_ARGUMENTS
+PageHandle BPLUSTREE_TYPE::FindLeafOptimistic(const KeyType &key, bool leftMost) {
+  for (int attempt = 0; attempt < OPTIMISTIC_ATTEMPTS; attempt++) {
+    page_id_t page_id = root_page_id_.load(std::memory_order_acquire);
+    uint64_t version;
+    Page *page = buffer_pool_manager_->PeekPage(page_id, &version);
+    while (page != nullptr) {
+      BPlusTreePage *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+      bool is_leaf = node->IsLeafPage();
+      page_id_t child_page_id = INVALID_PAGE_ID;
+      if (!is_leaf){
+        InternalPage *internal_page = reinterpret_cast<InternalPage *>(node);
+        if (leftMost){
+          child_page_id = internal_page->ValueAt(0);
+        } else if (!internal_page->LookupOptimistic(key, comparator_, &child_page_id)){
+          break;
+        }
+      }
+      if (!page->ValidateVersion(version)){
+        break;
+      }
+      if (is_leaf){
+        PageHandle leaf = buffer_pool_manager_->FetchPageHandle(page_id);
+        if (leaf && leaf.GetPage() == page && page->ValidateVersion(version)){
+          return leaf;
+        }
+        break;
+      }
+      uint64_t child_version;
+      Page *child = buffer_pool_manager_->PeekPage(child_page_id, &child_version);
+      if (child == nullptr){
+        // not resident or being read in: only the pessimistic descent loads it
+        return {};
+      }
+      if (!page->ValidateVersion(version)){
+        break;
+      }
+      page = child;
+      page_id = child_page_id;
+      version = child_version;
+    }
+    if (page == nullptr){
+      return {};
+    }
   }
-  return reinterpret_cast<Page *>(internal_page);
+  return {};
 }
 
 /*
@@ -368,7 +502,8 @@ Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
-  HeaderPage *header_page = static_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
+  PageHandle header = buffer_pool_manager_->FetchPageHandle(HEADER_PAGE_ID);
+  HeaderPage *header_page = static_cast<HeaderPage *>(header.GetPage());
   if (insert_record != 0) {
     // create a new record<index_name + root_page_id> in header_page
     header_page->InsertRecord(index_name_, root_page_id_);
@@ -376,7 +511,52 @@ void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
     // update root_page_id in header_page
     header_page->UpdateRecord(index_name_, root_page_id_);
   }
-  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
+  header.MarkDirty();
+  // the header page has no room for an LSN, so the buffer pool cannot hold its write back for the log; the log goes to
+  // disk here instead, up to the record of the operation that changed the root
+  if (log_manager_ != nullptr && enable_logging) {
+    log_manager_->Flush(log_manager_->GetNextLSN() - 1);
+  }
+}
+
+/*
+ * Append the log record of an insert into or a remove from this index, with the
+ * raw bytes of the key, for the pages the operation changes to take its LSN.
+ * @return: the LSN of the record, INVALID_LSN if logging is off
+ */
+INDEX_TEMPLATE_ARGUMENTS
+lsn_t BPLUSTREE_TYPE::LogOperation(LogRecordType type, const KeyType &key, const ValueType &value,
+                                   Transaction *transaction) {
+  if (log_manager_ == nullptr || !enable_logging) {
+    return INVALID_LSN;
+  }
+  txn_id_t txn_id = transaction == nullptr ? INVALID_TXN_ID : transaction->GetTransactionId();
+  lsn_t prev_lsn = transaction == nullptr ? INVALID_LSN : transaction->GetPrevLSN();
+  LogRecord record(txn_id, prev_lsn, type, index_name_, reinterpret_cast<const char *>(&key), sizeof(KeyType), value);
+  lsn_t lsn = log_manager_->AppendLogRecord(&record);
+  if (transaction != nullptr) {
+    transaction->SetPrevLSN(lsn);
+  }
+  return lsn;
+}
+
+/*
+ * Read the root page id of this index from the header page, for a tree whose
+ * pages were written before this BPlusTree was created.
+ * @return: false if the header page has no record <index_name, root_page_id>
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::LoadRootPageId() {
+  PageHandle header = buffer_pool_manager_->FetchPageHandle(HEADER_PAGE_ID);
+  if (!header) {
+    return false;
+  }
+  page_id_t root_page_id;
+  if (!static_cast<HeaderPage *>(header.GetPage())->GetRootId(index_name_, &root_page_id)) {
+    return false;
+  }
+  root_page_id_.store(root_page_id, std::memory_order_release);
+  return true;
 }
 
 /*
@@ -2,16 +2,60 @@
  * index_iterator.cpp
  */
 #include <cassert>
+#include <utility>
 
 #include "storage/index/index_iterator.h"
 
 namespace bustub {
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *bpm, page_id_t page_id, int i) {
+INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *bpm, page_id_t page_id, int i, size_t read_ahead) {
   buffer_pool_manager_ = bpm;
   current_page_id_ = page_id;
   index_ = i;
+  if (page_id != INVALID_PAGE_ID) {
+    current_page_ = bpm->FetchPageHandle(page_id, AccessType::SCAN);
+    if (!current_page_) {
+      // the leaf could not be fetched: end the scan rather than hold an empty handle
+      current_page_id_ = INVALID_PAGE_ID;
+      index_ = 0;
+    }
+  }
+  read_ahead_ = read_ahead;
+  ReadAhead();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *bpm, PageHandle leaf, int i, size_t read_ahead) {
+  buffer_pool_manager_ = bpm;
+  current_page_id_ = leaf.GetPageId();
+  current_page_ = std::move(leaf);
+  current_page_.SetAccessType(AccessType::SCAN);
+  index_ = i;
+  read_ahead_ = read_ahead;
+  ReadAhead();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::IndexIterator(const IndexIterator &other)
+    : current_page_id_(other.current_page_id_),
+      current_page_(other.current_page_.Repin()),
+      buffer_pool_manager_(other.buffer_pool_manager_),
+      index_(other.index_),
+      read_ahead_(other.read_ahead_),
+      ahead_(other.ahead_) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator=(const IndexIterator &other) {
+  if (this != &other) {
+    current_page_id_ = other.current_page_id_;
+    current_page_ = other.current_page_.Repin();
+    buffer_pool_manager_ = other.buffer_pool_manager_;
+    index_ = other.index_;
+    read_ahead_ = other.read_ahead_;
+    ahead_ = other.ahead_;
+  }
+  return *this;
 }
 
 // INDEX_TEMPLATE_ARGUMENTS
@@ -34,32 +78,83 @@ bool INDEXITERATOR_TYPE::operator!=(const IndexIterator &itr) const {
   return current_page_id_ != itr.current_page_id_ || index_ != itr.index_;
 }
 
+// Iterator accesses are hinted as SCAN so a full index scan does not flush the buffer pool
 INDEX_TEMPLATE_ARGUMENTS
 const MappingType &INDEXITERATOR_TYPE::operator*() {
-  Page *page = buffer_pool_manager_->FetchPage(current_page_id_);
-  page->RLatch();
-  B_PLUS_TREE_LEAF_PAGE_TYPE *leaf = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page->GetData());
+  current_page_->RLatch();
+  B_PLUS_TREE_LEAF_PAGE_TYPE *leaf = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(current_page_.GetData());
   const MappingType &val = leaf->GetItem(index_);
-  page->RUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  current_page_->RUnlatch();
   return val;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() {
   index_++;
-  Page *page = buffer_pool_manager_->FetchPage(current_page_id_);
-  page->RLatch();
-  B_PLUS_TREE_LEAF_PAGE_TYPE *leaf = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page->GetData());
-  if (index_ >= leaf->GetSize()) {
+  current_page_->RLatch();
+  B_PLUS_TREE_LEAF_PAGE_TYPE *leaf = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(current_page_.GetData());
+  bool next_leaf = index_ >= leaf->GetSize();
+  if (next_leaf) {
     current_page_id_ = leaf->GetNextPageId();
     index_ = 0;
   }
-  page->RUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  current_page_->RUnlatch();
+  if (next_leaf) {
+    // unpin the leaf we are leaving before pinning the next one
+    current_page_.Release();
+    if (current_page_id_ != INVALID_PAGE_ID) {
+      current_page_ = buffer_pool_manager_->FetchPageHandle(current_page_id_, AccessType::SCAN);
+      if (!current_page_) {
+        // every frame is pinned: the scan stops here, as End(), rather than hold an empty handle
+        current_page_id_ = INVALID_PAGE_ID;
+      }
+    }
+    ReadAhead();
+  }
   return *this;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::ReadAhead() {
+  if (read_ahead_ == 0 || current_page_id_ == INVALID_PAGE_ID) {
+    return;
+  }
+  // the leaf we moved onto leaves the window; if it is not the front, the window is stale
+  if (!ahead_.empty() && ahead_.front() == current_page_id_) {
+    ahead_.pop_front();
+  } else {
+    ahead_.clear();
+  }
+  page_id_t last = ahead_.empty() ? current_page_id_ : ahead_.back();
+  while (ahead_.size() < read_ahead_) {
+    page_id_t next;
+    if (last == current_page_id_) {
+      // the current leaf is pinned by the iterator already
+      current_page_->RLatch();
+      next = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(current_page_.GetData())->GetNextPageId();
+      current_page_->RUnlatch();
+    } else {
+      // any later leaf is only looked at once its prefetch has completed, and without pinning it: a SCAN unpin would
+      // make it the next victim before the iterator gets to it
+      uint64_t version;
+      Page *page = buffer_pool_manager_->PeekPage(last, &version);
+      if (page == nullptr) {
+        break;
+      }
+      next = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page->GetData())->GetNextPageId();
+      if (!page->ValidateVersion(version)) {
+        break;
+      }
+    }
+    if (next == INVALID_PAGE_ID) {
+      break;
+    }
+    buffer_pool_manager_->PrefetchPage(next, AccessType::SCAN);
+    ahead_.push_back(next);
+    last = next;
+  }
+}
+
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
 
 template class IndexIterator<GenericKey<8>, RID, GenericComparator<8>>;
@@ -9,6 +9,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 
@@ -93,6 +94,28 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyCo
   return array[cur - 1].second;
 }
 
+/*
+ * Lookup on a page that may be written concurrently. The size is read once and
+ * checked against the capacity of the page, so torn contents can give a wrong
+ * child (the caller's ValidateVersion catches that) but never a read past the
+ * page.
+ * @return: false if the size is out of range, i.e. the page is being rewritten
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::LookupOptimistic(const KeyType &key, const KeyComparator &comparator,
+                                                      ValueType *value) const {
+  int size = GetSize();
+  if (size <= 0 || static_cast<size_t>(size) > INTERNAL_PAGE_SIZE) {
+    return false;
+  }
+  int cur = 1;
+  while (cur < size && comparator(key, array[cur].first) >= 0) {
+    cur++;
+  }
+  *value = array[cur - 1].second;
+  return true;
+}
+
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
@@ -142,14 +165,16 @@ int B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value,
  *****************************************************************************/
 /*
  * Remove half of key & value pairs from this page to "recipient" page
+ * latched_child is a child the caller holds the write latch on, if any, e.g.
+ * the node whose split made this page overflow
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(BPlusTreeInternalPage *recipient,
-                                                BufferPoolManager *buffer_pool_manager) {
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(BPlusTreeInternalPage *recipient, BufferPoolManager *buffer_pool_manager,
+                                                page_id_t latched_child) {
   // have this node get the majority because size counts the key-less pointer at index 0
   // LOG_INFO("Moving half of page %d to page %d, starting with %ld:%d", GetPageId(), recipient->GetPageId(),
   //          array[(GetSize() + 1) / 2].first.ToInt64(), array[(GetSize() + 1) / 2].second);
-  recipient->CopyNFrom(array + (GetSize() + 1) / 2, GetSize() / 2, buffer_pool_manager);
+  recipient->CopyNFrom(array + (GetSize() + 1) / 2, GetSize() / 2, buffer_pool_manager, latched_child);
   recipient->SetSize(GetSize() / 2);
   SetSize((GetSize() + 1) / 2);
 }
@@ -159,15 +184,13 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(BPlusTreeInternalPage *recipient
  * So I need to 'adopt' them by changing their parent page id, which needs to be persisted with BufferPoolManger
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager) {
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager,
+                                               page_id_t latched_child) {
   // assume I am an empty page
   BUSTUB_ASSERT(GetSize() == 0, "entries will be overwritten");
   for (int cur = 0; cur < size; cur++) {
     array[cur] = items[cur];
-    BPlusTreeInternalPage *child_page =
-        reinterpret_cast<BPlusTreeInternalPage *>(buffer_pool_manager->FetchPage(array[cur].second)->GetData());
-    child_page->SetParentPageId(GetPageId());
-    buffer_pool_manager->UnpinPage(child_page->GetPageId(), true);
+    Adopt(array[cur].second, buffer_pool_manager, array[cur].second == latched_child);
   }
 }
 
@@ -207,18 +230,11 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient,
   // assume recipient is a predecessor (i.e., middle key goes at the end, then everything from this node)
   BUSTUB_ASSERT(recipient->GetSize() + GetSize() <= recipient->GetMaxSize(), "recipient does not have room");
   int cur = recipient->GetSize();
-  recipient->array[cur].first = middle_key;
-  recipient->array[cur].second = array[0].second;
-  BPlusTreeInternalPage *child_page =
-      reinterpret_cast<BPlusTreeInternalPage *>(buffer_pool_manager->FetchPage(array[0].second)->GetData());
-  child_page->SetParentPageId(recipient->GetPageId());
-  buffer_pool_manager->UnpinPage(child_page->GetPageId(), true);
-  cur++;
-  for (int i = 1; i < GetSize(); i++, cur++) {
-    recipient->array[cur] = array[i];
-    child_page = reinterpret_cast<BPlusTreeInternalPage *>(buffer_pool_manager->FetchPage(array[i].second)->GetData());
-    child_page->SetParentPageId(recipient->GetPageId());
-    buffer_pool_manager->UnpinPage(child_page->GetPageId(), true);
+  for (int i = 0; i < GetSize(); i++, cur++) {
+    // the key-less pointer at index 0 takes the middle key
+    recipient->array[cur].first = i == 0 ? middle_key : array[i].first;
+    recipient->array[cur].second = array[i].second;
+    recipient->Adopt(array[i].second, buffer_pool_manager);
   }
   recipient->IncreaseSize(GetSize());
 }
@@ -254,10 +270,7 @@ INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager) {
   array[GetSize()] = pair;
   IncreaseSize(1);
-  BPlusTreeInternalPage *child_page =
-      reinterpret_cast<BPlusTreeInternalPage *>(buffer_pool_manager->FetchPage(pair.second)->GetData());
-  child_page->SetParentPageId(GetPageId());
-  buffer_pool_manager->UnpinPage(child_page->GetPageId(), true);
+  Adopt(pair.second, buffer_pool_manager);
 }
 
 /*
@@ -288,10 +301,29 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyFirstFrom(const MappingType &pair, Buff
   array[1].first = pair.first;
   array[0].second = pair.second;
   IncreaseSize(1);
-  BPlusTreeInternalPage *child_page =
-      reinterpret_cast<BPlusTreeInternalPage *>(buffer_pool_manager->FetchPage(pair.second)->GetData());
-  child_page->SetParentPageId(GetPageId());
-  buffer_pool_manager->UnpinPage(child_page->GetPageId(), true);
+  Adopt(pair.second, buffer_pool_manager);
+}
+
+/* Make me the parent of a child page and persist it with BufferPoolManager.
+ * The child changes as part of the same operation as me, so it also takes my LSN, unless it has a later one: the
+ * log must be on disk up to there before the child is written.
+ * The child is changed under its write latch, which also makes optimistic readers of it retry; is_latched says the
+ * caller holds that latch already. Like the rest of a split, this assumes one writer at a time.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Adopt(page_id_t child_page_id, BufferPoolManager *buffer_pool_manager,
+                                           bool is_latched) {
+  PageHandle child = buffer_pool_manager->FetchPageHandle(child_page_id);
+  auto *child_node = reinterpret_cast<BPlusTreePage *>(child.GetData());
+  if (!is_latched) {
+    child->WLatch();
+  }
+  child_node->SetParentPageId(GetPageId());
+  child_node->SetLSN(std::max(child_node->GetLSN(), GetLSN()));
+  if (!is_latched) {
+    child->WUnlatch();
+  }
+  child.MarkDirty();
 }
 
 // valuetype for internalNode should be page id_t
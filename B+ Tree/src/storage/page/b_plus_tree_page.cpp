@@ -76,8 +76,9 @@ void BPlusTreePage::SetPageId(page_id_t page_id) {
 }
 
 /*
- * Helper methods to set lsn
+ * Helper methods to get/set lsn
  */
+lsn_t BPlusTreePage::GetLSN() const { return lsn_; }
 void BPlusTreePage::SetLSN(lsn_t lsn) { lsn_ = lsn; }
 
 }  // namespace bustub
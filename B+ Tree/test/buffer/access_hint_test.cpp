@@ -0,0 +1,129 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// access_hint_test.cpp
+//
+// Identification: test/buffer/access_hint_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <string>
+
+#include "buffer/arc_replacer.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+template <typename T>
+class AccessHintTest : public ::testing::Test {
+ protected:
+  /** Fetch page_id into frame_id and unpin it again, with the given hint on both. */
+  void Reference(frame_id_t frame_id, page_id_t page_id, AccessType access_type) {
+    replacer_.RecordAccess(frame_id, page_id, access_type);
+    replacer_.Pin(frame_id);
+    replacer_.Unpin(frame_id, access_type);
+  }
+
+  /** Frame 0 holds a hot page, frame 2 a page referenced once; a scan re-reads frame 0 and brings a page into
+   * frame 1. */
+  void ScanOverHotFrame(AccessType hint) {
+    Reference(0, 10, AccessType::NORMAL);
+    Reference(0, 10, AccessType::NORMAL);
+    Reference(2, 12, AccessType::NORMAL);
+    Reference(0, 10, hint);
+    Reference(1, 11, hint);
+  }
+
+  T replacer_{8};
+};
+
+using Replacers = ::testing::Types<LRUReplacer, ClockReplacer, LRUKReplacer, ARCReplacer>;
+TYPED_TEST_SUITE(AccessHintTest, Replacers);
+
+// NOLINTNEXTLINE
+TYPED_TEST(AccessHintTest, ScanPageGoesFirstTest) {
+  this->ScanOverHotFrame(AccessType::SCAN);
+
+  // The page the scan brought in goes before anything the working set touched, the hot page included.
+  int value;
+  ASSERT_TRUE(this->replacer_.Victim(&value));
+  EXPECT_EQ(1, value);
+  EXPECT_EQ(2, this->replacer_.Size());
+}
+
+// NOLINTNEXTLINE
+TYPED_TEST(AccessHintTest, OncePageGoesFirstTest) {
+  this->ScanOverHotFrame(AccessType::ONCE);
+
+  int value;
+  ASSERT_TRUE(this->replacer_.Victim(&value));
+  EXPECT_EQ(1, value);
+  EXPECT_EQ(2, this->replacer_.Size());
+}
+
+// NOLINTNEXTLINE
+TYPED_TEST(AccessHintTest, ReusedFrameLosesHotnessTest) {
+  this->ScanOverHotFrame(AccessType::SCAN);
+  int value;
+  ASSERT_TRUE(this->replacer_.Victim(&value));
+  ASSERT_TRUE(this->replacer_.Victim(&value));
+
+  // Frame 0 is reused for a page the scan brings in: the references of its previous page no longer protect it.
+  this->Reference(0, 99, AccessType::SCAN);
+  this->Reference(3, 13, AccessType::NORMAL);
+  ASSERT_TRUE(this->replacer_.Victim(&value));
+  EXPECT_EQ(0, value);
+}
+
+// NOLINTNEXTLINE
+TEST(AccessHintTest, ScanKeepsWorkingSetTest) {
+  const std::string db_name = "access_hint_test.db";
+  for (auto policy : {ReplacerPolicy::LRU, ReplacerPolicy::CLOCK, ReplacerPolicy::LRU_K, ReplacerPolicy::ARC}) {
+    remove(db_name.c_str());
+    auto *disk_manager = new DiskManager(db_name);
+    BufferPoolOptions options;
+    options.replacer_policy_ = policy;
+    auto *bpm = new BufferPoolManagerInstance(8, disk_manager, nullptr, options);
+
+    page_id_t page_id;
+    for (int i = 0; i < 100; i++) {
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+      EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+
+    // Pages 0..5 are the working set, touched twice.
+    for (int round = 0; round < 2; round++) {
+      for (page_id_t i = 0; i < 6; i++) {
+        ASSERT_NE(nullptr, bpm->FetchPage(i));
+        EXPECT_TRUE(bpm->UnpinPage(i, false));
+      }
+    }
+
+    // A scan over the rest of the table only recycles the frames the working set does not use.
+    for (page_id_t i = 10; i < 100; i++) {
+      ASSERT_NE(nullptr, bpm->FetchPage(i, AccessType::SCAN));
+      EXPECT_TRUE(bpm->UnpinPage(i, false, AccessType::SCAN));
+    }
+    uint64_t misses = bpm->GetMetrics().fetch_misses_;
+    for (page_id_t i = 0; i < 6; i++) {
+      ASSERT_NE(nullptr, bpm->FetchPage(i));
+      EXPECT_TRUE(bpm->UnpinPage(i, false));
+    }
+    EXPECT_EQ(misses, bpm->GetMetrics().fetch_misses_);
+
+    disk_manager->ShutDown();
+    remove(db_name.c_str());
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,198 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer_test.cpp
+//
+// Identification: test/buffer/arc_replacer_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/arc_replacer.h"
+
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+namespace {
+
+/** Minimal page table driving an ARCReplacer the way the buffer pool manager does. */
+class ARCPool {
+ public:
+  explicit ARCPool(size_t pool_size) : replacer_(pool_size), frames_(pool_size, INVALID_PAGE_ID) {
+    for (size_t i = 0; i < pool_size; i++) {
+      free_list_.push_back(static_cast<frame_id_t>(i));
+    }
+  }
+
+  /** Fetch and unpin a page. Returns true on a hit. */
+  bool Access(page_id_t page_id) {
+    auto it = page_table_.find(page_id);
+    bool hit = it != page_table_.end();
+    frame_id_t frame_id;
+    if (hit) {
+      frame_id = it->second;
+    } else {
+      if (!free_list_.empty()) {
+        frame_id = free_list_.front();
+        free_list_.pop_front();
+      } else {
+        EXPECT_TRUE(replacer_.Victim(&frame_id));
+        page_table_.erase(frames_[frame_id]);
+      }
+      page_table_[page_id] = frame_id;
+      frames_[frame_id] = page_id;
+    }
+    replacer_.RecordAccess(frame_id, page_id);
+    replacer_.Pin(frame_id);
+    replacer_.Unpin(frame_id);
+    return hit;
+  }
+
+  ARCReplacer *GetReplacer() { return &replacer_; }
+
+ private:
+  ARCReplacer replacer_;
+  std::unordered_map<page_id_t, frame_id_t> page_table_;
+  std::vector<page_id_t> frames_;
+  std::list<frame_id_t> free_list_;
+};
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(ARCReplacerTest, SampleTest) {
+  ARCReplacer arc_replacer(7);
+
+  // Unpinning a frame that is already unpinned is not a reference.
+  for (frame_id_t i : {1, 2, 3, 4, 5, 6, 1}) {
+    arc_replacer.Unpin(i);
+  }
+  EXPECT_EQ(6, arc_replacer.Size());
+  EXPECT_EQ(6, arc_replacer.GetRecencySize());
+
+  int value;
+  arc_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  arc_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  arc_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+
+  arc_replacer.Pin(3);
+  arc_replacer.Pin(4);
+  EXPECT_EQ(2, arc_replacer.Size());
+
+  // A pinned frame keeps its place in its list, so frame 4 is still the least recently used once unpinned.
+  arc_replacer.Unpin(4);
+  arc_replacer.Victim(&value);
+  EXPECT_EQ(4, value);
+  arc_replacer.Victim(&value);
+  EXPECT_EQ(5, value);
+  arc_replacer.Victim(&value);
+  EXPECT_EQ(6, value);
+  EXPECT_FALSE(arc_replacer.Victim(&value));
+}
+
+// NOLINTNEXTLINE
+TEST(ARCReplacerTest, FrequencyTest) {
+  ARCReplacer arc_replacer(4);
+  for (frame_id_t i = 0; i < 4; i++) {
+    arc_replacer.RecordAccess(i, 10 + i);
+    arc_replacer.Pin(i);
+    arc_replacer.Unpin(i);
+  }
+
+  // A second reference moves frame 0 from T1 to T2.
+  arc_replacer.RecordAccess(0, 10);
+  arc_replacer.Pin(0);
+  arc_replacer.Unpin(0);
+  EXPECT_EQ(3, arc_replacer.GetRecencySize());
+  EXPECT_EQ(1, arc_replacer.GetFrequencySize());
+
+  // With a target of 0, T1 is replaced first.
+  int value;
+  for (frame_id_t i = 1; i < 4; i++) {
+    arc_replacer.Victim(&value);
+    EXPECT_EQ(i, value);
+  }
+  arc_replacer.Victim(&value);
+  EXPECT_EQ(0, value);
+  EXPECT_EQ(3, arc_replacer.GetGhostRecencySize());
+  EXPECT_EQ(1, arc_replacer.GetGhostFrequencySize());
+}
+
+// NOLINTNEXTLINE
+TEST(ARCReplacerTest, ScanResistanceTest) {
+  ARCPool pool(4);
+
+  // The hot set {0, 1} is referenced twice and lives in T2.
+  for (int round = 0; round < 2; round++) {
+    pool.Access(0);
+    pool.Access(1);
+  }
+  EXPECT_EQ(2, pool.GetReplacer()->GetFrequencySize());
+
+  // A scan only churns T1.
+  for (page_id_t page_id = 100; page_id < 120; page_id++) {
+    EXPECT_FALSE(pool.Access(page_id));
+  }
+  EXPECT_TRUE(pool.Access(0));
+  EXPECT_TRUE(pool.Access(1));
+}
+
+// NOLINTNEXTLINE
+TEST(ARCReplacerTest, GhostHitTest) {
+  ARCPool pool(4);
+  ARCReplacer *arc_replacer = pool.GetReplacer();
+
+  for (int round = 0; round < 2; round++) {
+    pool.Access(0);
+    pool.Access(1);
+  }
+  for (page_id_t page_id = 100; page_id < 110; page_id++) {
+    pool.Access(page_id);
+  }
+  EXPECT_GT(arc_replacer->GetGhostRecencySize(), 0);
+  EXPECT_EQ(0, arc_replacer->GetTargetSize());
+
+  // A miss on a page still in B1 means T1 was too small: the target grows and the page comes back into T2.
+  size_t frequency_size = arc_replacer->GetFrequencySize();
+  EXPECT_FALSE(pool.Access(107));
+  EXPECT_GT(arc_replacer->GetTargetSize(), 0);
+  EXPECT_EQ(frequency_size + 1, arc_replacer->GetFrequencySize());
+
+  // The directory never holds more than twice the pool size.
+  EXPECT_EQ(4, arc_replacer->GetRecencySize() + arc_replacer->GetFrequencySize());
+  EXPECT_LE(arc_replacer->GetRecencySize() + arc_replacer->GetFrequencySize() + arc_replacer->GetGhostRecencySize() +
+                arc_replacer->GetGhostFrequencySize(),
+            8);
+}
+
+// NOLINTNEXTLINE
+TEST(ARCReplacerTest, RemoveTest) {
+  ARCReplacer arc_replacer(4);
+  for (frame_id_t i = 0; i < 4; i++) {
+    arc_replacer.RecordAccess(i, 10 + i);
+    arc_replacer.Pin(i);
+    arc_replacer.Unpin(i);
+  }
+
+  // A removed frame is gone for good and leaves no ghost behind.
+  arc_replacer.Remove(1);
+  EXPECT_EQ(3, arc_replacer.Size());
+  EXPECT_EQ(0, arc_replacer.GetGhostRecencySize());
+
+  std::vector<frame_id_t> victims;
+  arc_replacer.PeekVictims(4, &victims);
+  EXPECT_EQ((std::vector<frame_id_t>{0, 2, 3}), victims);
+  EXPECT_EQ(3, arc_replacer.Size());
+}
+
+}  // namespace bustub
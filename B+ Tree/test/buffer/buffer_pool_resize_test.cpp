@@ -0,0 +1,266 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_resize_test.cpp
+//
+// Identification: test/buffer/buffer_pool_resize_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(BufferPoolResizeTest, BoundsTest) {
+  const std::string db_name = "buffer_pool_resize_test.db";
+  auto *disk_manager = new DiskManager(db_name);
+  BufferPoolOptions options;
+  options.max_pool_size_ = 16;
+  auto *bpm = new BufferPoolManagerInstance(4, disk_manager, nullptr, options);
+
+  page_id_t page_id;
+  for (int i = 0; i < 4; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+
+  // Neither an empty pool nor one above the maximum it was created with.
+  EXPECT_FALSE(bpm->Resize(0));
+  EXPECT_FALSE(bpm->Resize(17));
+  EXPECT_EQ(4, bpm->GetPoolSize());
+
+  // Growing adds free frames.
+  EXPECT_TRUE(bpm->Resize(8));
+  EXPECT_EQ(8, bpm->GetPoolSize());
+  for (int i = 0; i < 4; i++) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolResizeTest, ShrinkTest) {
+  const std::string db_name = "buffer_pool_resize_test.db";
+  auto *disk_manager = new DiskManager(db_name);
+  BufferPoolOptions options;
+  options.max_pool_size_ = 16;
+  auto *bpm = new BufferPoolManagerInstance(8, disk_manager, nullptr, options);
+
+  // Frame i holds page_ids[i], dirty, with a marker.
+  std::vector<page_id_t> page_ids;
+  for (int i = 0; i < 8; i++) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page%d", page_id);
+    page_ids.push_back(page_id);
+  }
+  for (int i = 0; i < 8; i++) {
+    if (i != 5 && i != 7) {
+      EXPECT_TRUE(bpm->UnpinPage(page_ids[i], true));
+    }
+  }
+
+  // The dirty pages in frames 4 and 6 are written back; the pinned ones in frames 5 and 7 stay readable.
+  EXPECT_TRUE(bpm->Resize(4));
+  EXPECT_EQ(4, bpm->GetPoolSize());
+  EXPECT_EQ(2, bpm->GetMetrics().resize_writes_);
+  Page *page = bpm->FetchPage(page_ids[5]);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, strcmp(page->GetData(), "page5"));
+  EXPECT_TRUE(bpm->UnpinPage(page_ids[5], false));
+
+  // Page 6 comes back from disk into one of the remaining frames.
+  page = bpm->FetchPage(page_ids[6]);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, strcmp(page->GetData(), "page6"));
+  EXPECT_LT(page - bpm->GetPages(), 4);
+  EXPECT_TRUE(bpm->UnpinPage(page_ids[6], false));
+
+  // The last unpin of a page in a removed frame evicts it.
+  EXPECT_TRUE(bpm->UnpinPage(page_ids[5], true));
+  EXPECT_TRUE(bpm->UnpinPage(page_ids[7], true));
+  for (size_t i = 4; i < 16; i++) {
+    EXPECT_EQ(INVALID_PAGE_ID, bpm->GetPages()[i].GetPageId());
+  }
+  for (int i = 0; i < 8; i++) {
+    page = bpm->FetchPage(page_ids[i]);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page" + std::to_string(page_ids[i]), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(page_ids[i], false));
+  }
+
+  // Growing again over the removed frames makes all of them usable.
+  EXPECT_TRUE(bpm->Resize(16));
+  std::vector<page_id_t> new_page_ids;
+  page_id_t page_id;
+  while (bpm->NewPage(&page_id) != nullptr) {
+    new_page_ids.push_back(page_id);
+  }
+  EXPECT_EQ(16, new_page_ids.size());
+  for (auto id : new_page_ids) {
+    EXPECT_TRUE(bpm->UnpinPage(id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolResizeTest, PartitionMinimumTest) {
+  const std::string db_name = "buffer_pool_resize_test.db";
+  auto *disk_manager = new DiskManager(db_name);
+  BufferPoolOptions options;
+  options.max_pool_size_ = 32;
+  auto *bpm = new BufferPoolManagerInstance(16, disk_manager, nullptr, options);
+
+  // The pool never shrinks below the frames its partitions are guaranteed.
+  ASSERT_NE(nullptr, bpm->CreatePartition("index", 6, 10));
+  EXPECT_FALSE(bpm->Resize(5));
+  EXPECT_EQ(16, bpm->GetPoolSize());
+  EXPECT_TRUE(bpm->Resize(6));
+  EXPECT_EQ(nullptr, bpm->CreatePartition("heap", 1, 2));
+
+  // Every frame is usable after each shrink and grow.
+  for (int round = 0; round < 20; round++) {
+    ASSERT_TRUE(bpm->Resize(6 + (round * 7) % 26));
+    std::vector<page_id_t> page_ids;
+    page_id_t page_id;
+    while (bpm->NewPage(&page_id) != nullptr) {
+      page_ids.push_back(page_id);
+    }
+    EXPECT_EQ(bpm->GetPoolSize(), page_ids.size());
+    for (auto id : page_ids) {
+      EXPECT_TRUE(bpm->UnpinPage(id, false));
+      EXPECT_TRUE(bpm->DeletePage(id));
+    }
+  }
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolResizeTest, ParallelTest) {
+  const std::string db_name = "buffer_pool_resize_test.db";
+  auto *disk_manager = new DiskManager(db_name);
+  BufferPoolOptions options;
+  options.max_pool_size_ = 10;
+
+  {
+    ParallelBufferPoolManager bpm(3, 5, disk_manager, nullptr, options);
+    EXPECT_EQ(15, bpm.GetPoolSize());
+
+    // The new size is spread over the instances, the first ones taking the remainder.
+    EXPECT_TRUE(bpm.Resize(28));
+    EXPECT_EQ(28, bpm.GetPoolSize());
+    EXPECT_EQ(10, bpm.GetInstance(0)->GetPoolSize());
+    EXPECT_EQ(9, bpm.GetInstance(2)->GetPoolSize());
+
+    // Each instance is bounded by its own maximum.
+    EXPECT_FALSE(bpm.Resize(31));
+    EXPECT_EQ(28, bpm.GetPoolSize());
+    EXPECT_FALSE(bpm.Resize(2));
+  }
+
+  {
+    ParallelBufferPoolManager bpm(2, 8, disk_manager, nullptr, options);
+    ASSERT_NE(nullptr, bpm.CreatePartition("index", 8, 12));
+    EXPECT_FALSE(bpm.Resize(7));
+    EXPECT_EQ(16, bpm.GetPoolSize());
+    EXPECT_TRUE(bpm.Resize(8));
+    EXPECT_EQ(8, bpm.GetPoolSize());
+  }
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolResizeTest, ConcurrentResizeTest) {
+  const std::string db_name = "buffer_pool_resize_test.db";
+  const int num_pages = 200;
+  auto *disk_manager = new DiskManager(db_name);
+  char data[PAGE_SIZE];
+  for (page_id_t i = 0; i < num_pages; i++) {
+    memset(data, 0, PAGE_SIZE);
+    snprintf(data, PAGE_SIZE, "page%d", i);
+    disk_manager->WritePage(i, data);
+  }
+
+  BufferPoolOptions options;
+  options.max_pool_size_ = 64;
+  options.cleaner_interval_ms_ = 1;
+  auto *bpm = new BufferPoolManagerInstance(32, disk_manager, nullptr, options);
+
+  // Readers, writers and prefetches race with a thread that keeps resizing the pool.
+  std::atomic<bool> stop{false};
+  std::atomic<int> mismatches{0};
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < 4; tid++) {
+    threads.emplace_back([&, tid] {
+      std::mt19937 rng(tid);
+      for (int i = 0; i < 5000; i++) {
+        page_id_t page_id = rng() % num_pages;
+        if (i % 7 == 0) {
+          bpm->PrefetchPage(page_id);
+          continue;
+        }
+        Page *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          continue;
+        }
+        page->RLatch();
+        if (std::string(page->GetData()) != "page" + std::to_string(page_id)) {
+          mismatches++;
+        }
+        page->RUnlatch();
+        bpm->UnpinPage(page_id, i % 3 == 0);
+      }
+    });
+  }
+  std::thread resizer([&] {
+    std::mt19937 rng(9);
+    while (!stop) {
+      bpm->Resize(2 + rng() % 63);
+      std::this_thread::yield();
+    }
+  });
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  stop = true;
+  resizer.join();
+  EXPECT_EQ(0, mismatches);
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  delete disk_manager;
+}
+
+}  // namespace bustub
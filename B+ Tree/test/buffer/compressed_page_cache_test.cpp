@@ -0,0 +1,220 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache_test.cpp
+//
+// Identification: test/buffer/compressed_page_cache_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/compressed_page_cache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+namespace {
+
+/** A B+ tree leaf 60% full of (int64_t key, RID) pairs after a 24-byte header. */
+std::vector<char> MakeLeafPage() {
+  std::vector<char> page(PAGE_SIZE, 0);
+  int num_pairs = (PAGE_SIZE - 24) / 16 * 6 / 10;
+  for (int i = 0; i < num_pairs; i++) {
+    int64_t key = 100000 + i * 3;
+    int32_t page_id = 77;
+    int32_t slot = i;
+    memcpy(&page[24 + i * 16], &key, sizeof(key));
+    memcpy(&page[32 + i * 16], &page_id, sizeof(page_id));
+    memcpy(&page[36 + i * 16], &slot, sizeof(slot));
+  }
+  return page;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(CompressedPageCacheTest, RoundTripTest) {
+  std::mt19937_64 rng(1);
+  std::vector<char> out(PAGE_SIZE);
+
+  std::vector<char> zeros(PAGE_SIZE, 0);
+  std::string compressed = CompressedPageCache::Compress(zeros.data());
+  EXPECT_LT(compressed.size(), PAGE_SIZE / 16);
+  ASSERT_TRUE(CompressedPageCache::Decompress(compressed, out.data()));
+  EXPECT_EQ(0, memcmp(out.data(), zeros.data(), PAGE_SIZE));
+
+  std::vector<char> leaf = MakeLeafPage();
+  compressed = CompressedPageCache::Compress(leaf.data());
+  EXPECT_LE(compressed.size(), CompressedPageCache::MAX_COMPRESSED_SIZE);
+  ASSERT_TRUE(CompressedPageCache::Decompress(compressed, out.data()));
+  EXPECT_EQ(0, memcmp(out.data(), leaf.data(), PAGE_SIZE));
+
+  // Random bytes do not compress, but still round trip.
+  std::vector<char> random(PAGE_SIZE);
+  for (auto &c : random) {
+    c = static_cast<char>(rng());
+  }
+  compressed = CompressedPageCache::Compress(random.data());
+  EXPECT_GT(compressed.size(), CompressedPageCache::MAX_COMPRESSED_SIZE);
+  ASSERT_TRUE(CompressedPageCache::Decompress(compressed, out.data()));
+  EXPECT_EQ(0, memcmp(out.data(), random.data(), PAGE_SIZE));
+}
+
+// NOLINTNEXTLINE
+TEST(CompressedPageCacheTest, CorruptInputTest) {
+  std::mt19937_64 rng(2);
+  std::vector<char> leaf = MakeLeafPage();
+  std::string compressed = CompressedPageCache::Compress(leaf.data());
+  std::vector<char> out(PAGE_SIZE);
+
+  // Damaged or truncated input is rejected or decodes to garbage, but never reads or writes out of bounds.
+  EXPECT_FALSE(CompressedPageCache::Decompress(compressed.substr(0, compressed.size() / 2), out.data()));
+  for (int i = 0; i < 2000; i++) {
+    std::string damaged = compressed;
+    damaged[rng() % damaged.size()] = static_cast<char>(rng());
+    if (i % 3 == 0) {
+      damaged.resize(rng() % damaged.size());
+    }
+    CompressedPageCache::Decompress(damaged, out.data());
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(CompressedPageCacheTest, CapacityTest) {
+  std::vector<char> leaf = MakeLeafPage();
+  size_t compressed_size = CompressedPageCache::Compress(leaf.data()).size();
+  CompressedPageCache cache(compressed_size * 3 + 10);
+  std::vector<char> out(PAGE_SIZE);
+
+  // Room for three pages: the oldest ones are dropped.
+  for (page_id_t i = 0; i < 5; i++) {
+    EXPECT_TRUE(cache.Insert(i, leaf.data()));
+  }
+  EXPECT_EQ(3, cache.Size());
+  EXPECT_LE(cache.Bytes(), compressed_size * 3 + 10);
+  EXPECT_FALSE(cache.Take(0, out.data()));
+  EXPECT_FALSE(cache.Take(1, out.data()));
+
+  // Take is exclusive: the page leaves the cache.
+  ASSERT_TRUE(cache.Take(4, out.data()));
+  EXPECT_EQ(0, memcmp(out.data(), leaf.data(), PAGE_SIZE));
+  EXPECT_EQ(2, cache.Size());
+  EXPECT_FALSE(cache.Take(4, out.data()));
+
+  cache.Erase(3);
+  EXPECT_EQ(1, cache.Size());
+  EXPECT_EQ(compressed_size, cache.Bytes());
+
+  // A page that does not compress well enough is not kept.
+  std::vector<char> random(PAGE_SIZE);
+  std::mt19937_64 rng(3);
+  for (auto &c : random) {
+    c = static_cast<char>(rng());
+  }
+  EXPECT_FALSE(cache.Insert(5, random.data()));
+  EXPECT_EQ(1, cache.Size());
+
+  // Pages dropped to make room for a precompressed insert are handed back.
+  std::vector<CompressedPageCache::DroppedPage> dropped;
+  for (page_id_t i = 6; i < 9; i++) {
+    EXPECT_TRUE(cache.Insert(i, CompressedPageCache::Compress(leaf.data()), &dropped));
+  }
+  ASSERT_EQ(1, dropped.size());
+  EXPECT_EQ(2, dropped[0].first);
+}
+
+// NOLINTNEXTLINE
+TEST(CompressedPageCacheTest, BufferPoolTest) {
+  const std::string db_name = "compressed_page_cache_test.db";
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  BufferPoolOptions options;
+  options.compressed_cache_bytes_ = 1 << 20;
+  auto *bpm = new BufferPoolManagerInstance(8, disk_manager, nullptr, options);
+
+  page_id_t page_id;
+  for (int i = 0; i < 64; i++) {
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page%d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Every page evicted from the pool fits in the tier: fetching them again never reads the disk, dirty ones
+  // included.
+  uint64_t reads = bpm->GetMetrics().read_latency_.count_;
+  for (int round = 0; round < 3; round++) {
+    for (page_id_t i = 0; i < 64; i++) {
+      Page *page = bpm->FetchPage(i);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ("page" + std::to_string(i), std::string(page->GetData()));
+      EXPECT_TRUE(bpm->UnpinPage(i, i % 5 == 0));
+    }
+  }
+  auto metrics = bpm->GetMetrics();
+  EXPECT_EQ(reads, metrics.read_latency_.count_);
+  EXPECT_EQ(192, metrics.compressed_hits_);
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(CompressedPageCacheTest, ParallelTest) {
+  const std::string db_name = "compressed_page_cache_test.db";
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+
+  // A tier too small for the working set drops pages, which then come back from disk.
+  BufferPoolOptions options;
+  options.compressed_cache_bytes_ = 200;
+  auto *bpm = new ParallelBufferPoolManager(2, 4, disk_manager, nullptr, options);
+
+  std::vector<page_id_t> page_ids;
+  page_id_t page_id;
+  for (int i = 0; i < 40; i++) {
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page%d", page_id);
+    page_ids.push_back(page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  // Cycling over 12 pages, 6 per instance, misses the frames but hits the tier; cycling over all of them misses both.
+  for (size_t num_pages : {page_ids.size(), static_cast<size_t>(12)}) {
+    uint64_t reads = bpm->GetMetrics().read_latency_.count_;
+    for (int round = 0; round < 3; round++) {
+      for (size_t i = 0; i < num_pages; i++) {
+        Page *page = bpm->FetchPage(page_ids[i]);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ("page" + std::to_string(page_ids[i]), std::string(page->GetData()));
+        EXPECT_TRUE(bpm->UnpinPage(page_ids[i], false));
+      }
+    }
+    if (num_pages == 12) {
+      EXPECT_LE(bpm->GetMetrics().read_latency_.count_, reads + 12);
+    } else {
+      EXPECT_EQ(reads + 3 * num_pages, bpm->GetMetrics().read_latency_.count_);
+    }
+  }
+  EXPECT_GT(bpm->GetMetrics().compressed_hits_, 0);
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  delete disk_manager;
+}
+
+}  // namespace bustub
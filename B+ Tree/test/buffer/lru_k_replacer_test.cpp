@@ -0,0 +1,238 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer_test.cpp
+//
+// Identification: test/buffer/lru_k_replacer_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/lru_k_replacer.h"
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+namespace {
+
+/** Reference a frame the way the buffer pool does on a fetch: record the access, then pin. Frame f holds page 100 + f
+ * unless a page is given. */
+void Reference(LRUKReplacer *replacer, frame_id_t frame_id, page_id_t page_id = INVALID_PAGE_ID) {
+  replacer->RecordAccess(frame_id, page_id == INVALID_PAGE_ID ? 100 + frame_id : page_id);
+  replacer->Pin(frame_id);
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer lru_k_replacer(7, 2);
+
+  // Frames 1..6 are referenced once, frame 1 a second time.
+  for (frame_id_t i = 1; i <= 6; i++) {
+    Reference(&lru_k_replacer, i);
+  }
+  Reference(&lru_k_replacer, 1);
+  for (frame_id_t i = 1; i <= 6; i++) {
+    lru_k_replacer.Unpin(i);
+  }
+  EXPECT_EQ(6, lru_k_replacer.Size());
+
+  // Frames with fewer than K references have infinite backward K-distance and go first, oldest reference first.
+  int value;
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+
+  // Frame 4 picks up its second reference.
+  Reference(&lru_k_replacer, 4);
+  lru_k_replacer.Unpin(4);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(5, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(6, value);
+
+  // Frame 1's second most recent reference is older than frame 4's.
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(4, value);
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(0, lru_k_replacer.Size());
+}
+
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, PinTest) {
+  LRUKReplacer lru_k_replacer(4, 2);
+  for (frame_id_t i = 0; i < 4; i++) {
+    Reference(&lru_k_replacer, i);
+    lru_k_replacer.Unpin(i);
+  }
+  lru_k_replacer.Pin(0);
+  lru_k_replacer.Pin(2);
+  EXPECT_EQ(2, lru_k_replacer.Size());
+
+  int value;
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+}
+
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, ScanResistanceTest) {
+  LRUKReplacer lru_k_replacer(4, 2);
+
+  // Frame 0 is hot: two references.
+  Reference(&lru_k_replacer, 0);
+  lru_k_replacer.Unpin(0);
+  Reference(&lru_k_replacer, 0);
+  lru_k_replacer.Unpin(0);
+
+  // A scan touches every other frame once, after the hot frame was last used.
+  for (frame_id_t i = 1; i < 4; i++) {
+    Reference(&lru_k_replacer, i);
+    lru_k_replacer.Unpin(i);
+  }
+
+  int value;
+  for (frame_id_t i = 1; i < 4; i++) {
+    lru_k_replacer.Victim(&value);
+    EXPECT_EQ(i, value);
+  }
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(0, value);
+}
+
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, CorrelatedReferenceTest) {
+  LRUKReplacer lru_k_replacer(4, 2, 2);
+
+  // A burst on frame 1 counts as one reference; frame 2 has two uncorrelated ones.
+  Reference(&lru_k_replacer, 1);
+  Reference(&lru_k_replacer, 1);
+  Reference(&lru_k_replacer, 1);
+  Reference(&lru_k_replacer, 2);
+  Reference(&lru_k_replacer, 3);
+  Reference(&lru_k_replacer, 0);
+  Reference(&lru_k_replacer, 2);
+  lru_k_replacer.Unpin(1);
+  lru_k_replacer.Unpin(2);
+
+  int value;
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+}
+
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, CorrelatedWindowTest) {
+  LRUKReplacer lru_k_replacer(4, 2, 3);
+
+  Reference(&lru_k_replacer, 0);
+  lru_k_replacer.Unpin(0);
+  Reference(&lru_k_replacer, 1);
+  lru_k_replacer.Unpin(1);
+
+  // Both frames are still inside the window: the oldest goes.
+  int value;
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(0, value);
+
+  Reference(&lru_k_replacer, 2);
+  Reference(&lru_k_replacer, 3);
+  lru_k_replacer.Unpin(2);
+  EXPECT_EQ(2, lru_k_replacer.Size());
+
+  // Frames 1 and 2 age out of the window while frame 3 is referenced again.
+  for (int i = 0; i < 4; i++) {
+    Reference(&lru_k_replacer, 3);
+  }
+  lru_k_replacer.Unpin(3);
+
+  // Frame 3 was just referenced, so it is passed over while other candidates exist.
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+}
+
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, RetainedHistoryTest) {
+  LRUKReplacer lru_k_replacer(3, 2);
+
+  // Page 200 is referenced twice, then evicted.
+  Reference(&lru_k_replacer, 0, 200);
+  lru_k_replacer.Unpin(0);
+  Reference(&lru_k_replacer, 0, 200);
+  lru_k_replacer.Unpin(0);
+  int value;
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(0, value);
+
+  Reference(&lru_k_replacer, 0, 201);
+  lru_k_replacer.Unpin(0);
+  Reference(&lru_k_replacer, 1, 202);
+  lru_k_replacer.Unpin(1);
+
+  // Page 200 comes back in another frame and keeps its K references, so it outranks the once-referenced pages.
+  Reference(&lru_k_replacer, 2, 200);
+  lru_k_replacer.Unpin(2);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(0, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+
+  // Remove forgets the history: a deleted page comes back as a new one.
+  Reference(&lru_k_replacer, 0, 300);
+  lru_k_replacer.Unpin(0);
+  Reference(&lru_k_replacer, 0, 300);
+  lru_k_replacer.Remove(0);
+  Reference(&lru_k_replacer, 1, 300);
+  lru_k_replacer.Unpin(1);
+  Reference(&lru_k_replacer, 2, 301);
+  lru_k_replacer.Unpin(2);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+}
+
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, RetainedInformationPeriodTest) {
+  LRUKReplacer lru_k_replacer(2, 2);
+
+  Reference(&lru_k_replacer, 0, 10);
+  lru_k_replacer.Unpin(0);
+  Reference(&lru_k_replacer, 0, 10);
+  lru_k_replacer.Unpin(0);
+  int value;
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(0, value);
+
+  // num_pages further evictions push page 10's history out.
+  for (page_id_t page_id = 20; page_id < 22; page_id++) {
+    Reference(&lru_k_replacer, 0, page_id);
+    lru_k_replacer.Unpin(0);
+    Reference(&lru_k_replacer, 0, page_id);
+    lru_k_replacer.Unpin(0);
+    lru_k_replacer.Victim(&value);
+  }
+
+  // Page 10 is new again: with one reference it goes before the newer page 30.
+  Reference(&lru_k_replacer, 0, 10);
+  lru_k_replacer.Unpin(0);
+  Reference(&lru_k_replacer, 1, 30);
+  lru_k_replacer.Unpin(1);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(0, value);
+}
+
+}  // namespace bustub
@@ -0,0 +1,281 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// spill_cache_test.cpp
+//
+// Identification: test/buffer/spill_cache_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/spill_cache.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <future>  // NOLINT
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+namespace {
+
+/** Read a page out of the cache and wait for it. @return false if it was not cached or the read failed */
+bool ReadPage(SpillCache *cache, page_id_t page_id, char *data) {
+  std::promise<bool> promise;
+  std::future<bool> future = promise.get_future();
+  if (!cache->Read(page_id, data, &promise, [](std::promise<bool> failed) { failed.set_value(false); })) {
+    return false;
+  }
+  return future.get();
+}
+
+/** Check that a file exists. */
+bool FileExists(const std::string &file_name) {
+  FILE *file = fopen(file_name.c_str(), "r");
+  if (file == nullptr) {
+    return false;
+  }
+  fclose(file);
+  return true;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(SpillCacheTest, ReadWriteTest) {
+  const std::string file_name = "spill_cache_test.cache";
+  char data[PAGE_SIZE];
+  char buffer[PAGE_SIZE];
+
+  {
+    SpillCache cache(file_name, 8, 8);
+    for (page_id_t i = 0; i < 4; i++) {
+      memset(data, 'a' + i, PAGE_SIZE);
+      EXPECT_TRUE(cache.Insert(i, data));
+    }
+    EXPECT_EQ(4, cache.Size());
+    EXPECT_TRUE(FileExists(file_name));
+
+    // Read is exclusive: the page leaves the cache, whether its write finished or not.
+    ASSERT_TRUE(ReadPage(&cache, 2, buffer));
+    memset(data, 'c', PAGE_SIZE);
+    EXPECT_EQ(0, memcmp(buffer, data, PAGE_SIZE));
+    EXPECT_EQ(3, cache.Size());
+    EXPECT_FALSE(ReadPage(&cache, 2, buffer));
+
+    cache.Erase(1);
+    EXPECT_EQ(2, cache.Size());
+    EXPECT_FALSE(ReadPage(&cache, 1, buffer));
+
+    // A newer copy of a page replaces the older one.
+    memset(data, 'z', PAGE_SIZE);
+    EXPECT_TRUE(cache.Insert(0, data));
+    ASSERT_TRUE(ReadPage(&cache, 0, buffer));
+    EXPECT_EQ(0, memcmp(buffer, data, PAGE_SIZE));
+
+    ASSERT_TRUE(ReadPage(&cache, 3, buffer));
+    memset(data, 'd', PAGE_SIZE);
+    EXPECT_EQ(0, memcmp(buffer, data, PAGE_SIZE));
+    EXPECT_EQ(0, cache.Size());
+  }
+
+  // The cache file goes away with the cache.
+  EXPECT_FALSE(FileExists(file_name));
+}
+
+// NOLINTNEXTLINE
+TEST(SpillCacheTest, CapacityTest) {
+  const std::string file_name = "spill_cache_test.cache";
+  SpillCache cache(file_name, 4, 1);
+  char data[PAGE_SIZE];
+  char buffer[PAGE_SIZE];
+
+  // The cache holds at most capacity pages, whatever Insert drops while slots are busy.
+  for (page_id_t i = 0; i < 16; i++) {
+    memset(data, 'a' + i, PAGE_SIZE);
+    cache.Insert(i, data);
+    EXPECT_LE(cache.Size(), 4);
+  }
+
+  // Whatever is still cached reads back intact.
+  size_t cached = 0;
+  for (page_id_t i = 0; i < 16; i++) {
+    if (ReadPage(&cache, i, buffer)) {
+      memset(data, 'a' + i, PAGE_SIZE);
+      EXPECT_EQ(0, memcmp(buffer, data, PAGE_SIZE));
+      cached++;
+    }
+  }
+  EXPECT_GT(cached, 0);
+  EXPECT_LE(cached, 4);
+  EXPECT_EQ(0, cache.Size());
+}
+
+// NOLINTNEXTLINE
+TEST(SpillCacheTest, BufferPoolTest) {
+  const std::string db_name = "spill_cache_test.db";
+  const std::string file_name = "spill_cache_test.cache";
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  BufferPoolOptions options;
+  options.spill_file_ = file_name;
+  options.spill_capacity_pages_ = 48;
+  auto *bpm = new BufferPoolManagerInstance(8, disk_manager, nullptr, options);
+
+  std::vector<page_id_t> page_ids;
+  std::vector<int> versions(100, 0);
+  page_id_t page_id;
+  for (int i = 0; i < 100; i++) {
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page%d v0", page_id);
+    page_ids.push_back(page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Random reads and writes: every fetch sees the latest version, whether it comes from the pool, the spill file or
+  // the database file.
+  std::mt19937 rng(1);
+  for (int i = 0; i < 5000; i++) {
+    page_id = page_ids[rng() % page_ids.size()];
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page" + std::to_string(page_id) + " v" + std::to_string(versions[page_id]),
+              std::string(page->GetData()));
+    bool is_dirty = rng() % 4 == 0;
+    if (is_dirty) {
+      snprintf(page->GetData(), PAGE_SIZE, "page%d v%d", page_id, ++versions[page_id]);
+    }
+    EXPECT_TRUE(bpm->UnpinPage(page_id, is_dirty));
+  }
+  auto metrics = bpm->GetMetrics();
+  EXPECT_GT(metrics.spill_writes_, 0);
+  EXPECT_GT(metrics.spill_hits_, 0);
+
+  // A deleted page never comes back from the spill file.
+  for (size_t i = 0; i < page_ids.size(); i += 7) {
+    EXPECT_TRUE(bpm->DeletePage(page_ids[i]));
+  }
+  EXPECT_TRUE(FileExists(file_name));
+
+  delete bpm;
+  EXPECT_FALSE(FileExists(file_name));
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(SpillCacheTest, CompressedTierTest) {
+  const std::string db_name = "spill_cache_test.db";
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  BufferPoolOptions options;
+  options.spill_file_ = "spill_cache_test.cache";
+  options.spill_capacity_pages_ = 64;
+  options.compressed_cache_bytes_ = 1 << 20;
+  auto *bpm = new BufferPoolManagerInstance(4, disk_manager, nullptr, options);
+
+  // Even pages are random bytes that do not compress and go on to the spill tier; odd ones stay compressed.
+  std::mt19937 rng(5);
+  std::vector<std::string> contents;
+  page_id_t page_id;
+  for (int i = 0; i < 32; i++) {
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    for (size_t j = 0; j < PAGE_SIZE; j++) {
+      page->GetData()[j] = i % 2 == 0 ? static_cast<char>(rng()) : 0;
+    }
+    contents.emplace_back(page->GetData(), PAGE_SIZE);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  for (int round = 0; round < 3; round++) {
+    for (page_id_t i = 0; i < 32; i++) {
+      Page *page = bpm->FetchPage(i);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(0, memcmp(page->GetData(), contents[i].data(), PAGE_SIZE));
+      EXPECT_TRUE(bpm->UnpinPage(i, false));
+    }
+  }
+  auto metrics = bpm->GetMetrics();
+  EXPECT_GT(metrics.spill_writes_, 0);
+  EXPECT_GT(metrics.spill_hits_, 0);
+  EXPECT_GT(metrics.compressed_hits_, 0);
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(SpillCacheTest, ParallelTest) {
+  const std::string db_name = "spill_cache_test.db";
+  const int num_threads = 4;
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  BufferPoolOptions options;
+  options.spill_file_ = "spill_cache_test.cache";
+  options.spill_capacity_pages_ = 32;
+  auto *bpm = new ParallelBufferPoolManager(4, 8, disk_manager, nullptr, options);
+
+  // Each thread reads and writes pages of its own.
+  std::vector<std::vector<page_id_t>> page_ids(num_threads);
+  page_id_t page_id;
+  for (int tid = 0; tid < num_threads; tid++) {
+    for (int i = 0; i < 40; i++) {
+      Page *page = bpm->NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "page%d v0", page_id);
+      page_ids[tid].push_back(page_id);
+      EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+  }
+  std::vector<std::thread> threads;
+  std::atomic<int> mismatches{0};
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&, tid] {
+      std::mt19937 rng(tid);
+      std::unordered_map<page_id_t, int> versions;
+      for (int i = 0; i < 3000; i++) {
+        page_id_t id = page_ids[tid][rng() % page_ids[tid].size()];
+        Page *page = bpm->FetchPage(id);
+        if (page == nullptr) {
+          mismatches++;
+          continue;
+        }
+        if (std::string(page->GetData()) != "page" + std::to_string(id) + " v" + std::to_string(versions[id])) {
+          mismatches++;
+        }
+        bool is_dirty = rng() % 4 == 0;
+        if (is_dirty) {
+          snprintf(page->GetData(), PAGE_SIZE, "page%d v%d", id, ++versions[id]);
+        }
+        bpm->UnpinPage(id, is_dirty);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(0, mismatches);
+  EXPECT_GT(bpm->GetMetrics().spill_hits_, 0);
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  delete disk_manager;
+}
+
+}  // namespace bustub
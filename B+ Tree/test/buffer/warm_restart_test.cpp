@@ -0,0 +1,279 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// warm_restart_test.cpp
+//
+// Identification: test/buffer/warm_restart_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+namespace {
+
+/** Magic number at the start of a warm restart file, "WRM1". */
+constexpr uint32_t WARM_FILE_MAGIC = 0x57524d31;
+
+/** Write num_pages pages to the database file, each starting with its id. */
+void WritePages(DiskManager *disk_manager, int num_pages) {
+  char data[PAGE_SIZE];
+  for (page_id_t i = 0; i < num_pages; i++) {
+    memset(data, 0, PAGE_SIZE);
+    snprintf(data, PAGE_SIZE, "page%d", i);
+    disk_manager->WritePage(i, data);
+  }
+}
+
+/** Fetch a page, check its contents and unpin it. */
+void CheckPage(BufferPoolManager *bpm, page_id_t page_id) {
+  Page *page = bpm->FetchPage(page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ("page" + std::to_string(page_id), std::string(page->GetData()));
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+}
+
+/** Write a warm restart file: the magic number, the number of page ids, then the page ids. */
+void WriteWarmFile(const std::string &file_name, const std::vector<page_id_t> &page_ids) {
+  std::ofstream out(file_name, std::ios::binary | std::ios::trunc);
+  uint64_t count = page_ids.size();
+  out.write(reinterpret_cast<const char *>(&WARM_FILE_MAGIC), sizeof(WARM_FILE_MAGIC));
+  out.write(reinterpret_cast<const char *>(&count), sizeof(count));
+  out.write(reinterpret_cast<const char *>(page_ids.data()), static_cast<std::streamsize>(count * sizeof(page_id_t)));
+}
+
+/** Read a warm restart file back. @return false if it is not one */
+bool ReadWarmFile(const std::string &file_name, std::vector<page_id_t> *page_ids) {
+  std::ifstream in(file_name, std::ios::binary);
+  uint32_t magic = 0;
+  uint64_t count = 0;
+  in.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+  in.read(reinterpret_cast<char *>(&count), sizeof(count));
+  if (!in || magic != WARM_FILE_MAGIC) {
+    return false;
+  }
+  page_ids->resize(count);
+  in.read(reinterpret_cast<char *>(page_ids->data()), static_cast<std::streamsize>(count * sizeof(page_id_t)));
+  return static_cast<bool>(in) && in.peek() == EOF;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(WarmRestartTest, SaveLoadTest) {
+  const std::string db_name = "warm_restart_test.db";
+  const std::string warm_name = "warm_restart_test.ids";
+  remove(db_name.c_str());
+  remove(warm_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  WritePages(disk_manager, 400);
+
+  BufferPoolOptions options;
+  options.warm_file_ = warm_name;
+  options.warm_max_run_pages_ = 8;
+
+  // A scattered hot set plus a run of consecutive pages.
+  std::vector<page_id_t> hot_pages;
+  for (page_id_t i = 0; i < 30; i++) {
+    hot_pages.push_back(i * 7 % 400);
+  }
+  for (page_id_t i = 100; i < 130; i++) {
+    if (i % 7 != 0) {
+      hot_pages.push_back(i);
+    }
+  }
+
+  {
+    BufferPoolManagerInstance bpm(64, disk_manager, nullptr, options);
+    EXPECT_EQ(0, bpm.GetMetrics().warm_loads_);
+    for (page_id_t page_id : hot_pages) {
+      CheckPage(&bpm, page_id);
+    }
+    EXPECT_EQ(hot_pages.size(), bpm.SaveWarmSet());
+  }
+
+  // The next pool starts with the hot set resident; the run is read back with vectored reads.
+  {
+    BufferPoolManagerInstance bpm(64, disk_manager, nullptr, options);
+    EXPECT_EQ(hot_pages.size(), bpm.GetMetrics().warm_loads_);
+    for (page_id_t page_id : hot_pages) {
+      CheckPage(&bpm, page_id);
+    }
+    auto metrics = bpm.GetMetrics();
+    EXPECT_EQ(0, metrics.fetch_misses_);
+    EXPECT_EQ(hot_pages.size(), metrics.fetch_hits_);
+    auto stats = bpm.GetDiskScheduler()->GetStats();
+    EXPECT_EQ(hot_pages.size(), stats.pages_read_);
+    EXPECT_LT(stats.reads_, hot_pages.size());
+  }
+
+  // A smaller pool loads as many pages as it has frames.
+  {
+    BufferPoolManagerInstance bpm(16, disk_manager, nullptr, options);
+    EXPECT_EQ(16, bpm.GetMetrics().warm_loads_);
+  }
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  remove(warm_name.c_str());
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(WarmRestartTest, FileFormatTest) {
+  const std::string db_name = "warm_restart_test.db";
+  const std::string warm_name = "warm_restart_test.ids";
+  remove(db_name.c_str());
+  remove(warm_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  WritePages(disk_manager, 64);
+
+  BufferPoolOptions options;
+  options.warm_file_ = warm_name;
+
+  // The file lists the pinned pages first, then the others hottest first, i.e. most recently used first for LRU.
+  {
+    BufferPoolManagerInstance bpm(8, disk_manager, nullptr, options);
+    for (page_id_t page_id : {1, 2, 3, 4}) {
+      CheckPage(&bpm, page_id);
+    }
+    ASSERT_NE(nullptr, bpm.FetchPage(9));
+    EXPECT_EQ(5, bpm.SaveWarmSet());
+    EXPECT_TRUE(bpm.UnpinPage(9, false));
+  }
+  std::vector<page_id_t> page_ids;
+  ASSERT_TRUE(ReadWarmFile(warm_name, &page_ids));
+  EXPECT_EQ((std::vector<page_id_t>{9, 4, 3, 2, 1}), page_ids);
+
+  // A pool loads the hottest pages of a file written by hand, as many as fit.
+  WriteWarmFile(warm_name, {40, 10, 11, 12, 50});
+  {
+    BufferPoolManagerInstance bpm(4, disk_manager, nullptr, options);
+    EXPECT_EQ(4, bpm.GetMetrics().warm_loads_);
+    for (page_id_t page_id : {40, 10, 11, 12}) {
+      CheckPage(&bpm, page_id);
+    }
+    EXPECT_EQ(0, bpm.GetMetrics().fetch_misses_);
+  }
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  remove(warm_name.c_str());
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(WarmRestartTest, MalformedFileTest) {
+  const std::string db_name = "warm_restart_test.db";
+  const std::string warm_name = "warm_restart_test.ids";
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  WritePages(disk_manager, 16);
+
+  BufferPoolOptions options;
+  options.warm_file_ = warm_name;
+  std::vector<std::string> malformed_files;
+
+  // Not a warm restart file at all.
+  malformed_files.emplace_back("garbage");
+
+  // The wrong magic number.
+  WriteWarmFile(warm_name, {1, 2, 3});
+  std::ifstream in(warm_name, std::ios::binary);
+  std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  in.close();
+  std::string bad_magic = contents;
+  bad_magic[0] ^= 0x01;
+  malformed_files.push_back(bad_magic);
+
+  // A count that does not match the page ids that follow.
+  malformed_files.push_back(contents.substr(0, contents.size() - 1));
+  malformed_files.push_back(contents + std::string(sizeof(page_id_t), '\0'));
+
+  // Each of them is a cold start, and the pool works as usual.
+  for (const auto &malformed_file : malformed_files) {
+    std::ofstream(warm_name, std::ios::binary | std::ios::trunc) << malformed_file;
+    BufferPoolManagerInstance bpm(8, disk_manager, nullptr, options);
+    EXPECT_EQ(0, bpm.GetMetrics().warm_loads_);
+    CheckPage(&bpm, 1);
+  }
+
+  // The pool above saved a well-formed file again on destruction.
+  std::vector<page_id_t> page_ids;
+  ASSERT_TRUE(ReadWarmFile(warm_name, &page_ids));
+  EXPECT_EQ((std::vector<page_id_t>{1}), page_ids);
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  remove(warm_name.c_str());
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(WarmRestartTest, ParallelTest) {
+  const std::string db_name = "warm_restart_test.db";
+  const std::string warm_name = "warm_restart_test.ids";
+  const size_t num_instances = 4;
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  WritePages(disk_manager, 200);
+
+  BufferPoolOptions options;
+  options.warm_file_ = warm_name;
+
+  // Each instance saves its own pages to its own file.
+  {
+    ParallelBufferPoolManager bpm(num_instances, 32, disk_manager, nullptr, options);
+    for (page_id_t page_id = 0; page_id < 100; page_id++) {
+      CheckPage(&bpm, page_id);
+    }
+  }
+  for (size_t i = 0; i < num_instances; i++) {
+    std::vector<page_id_t> page_ids;
+    ASSERT_TRUE(ReadWarmFile("warm_restart_test." + std::to_string(i) + ".ids", &page_ids));
+    EXPECT_EQ(25, page_ids.size());
+    for (page_id_t page_id : page_ids) {
+      EXPECT_EQ(i, page_id % num_instances);
+    }
+  }
+
+  {
+    ParallelBufferPoolManager bpm(num_instances, 32, disk_manager, nullptr, options);
+    EXPECT_EQ(100, bpm.GetMetrics().warm_loads_);
+    for (page_id_t page_id = 0; page_id < 100; page_id++) {
+      CheckPage(&bpm, page_id);
+    }
+    EXPECT_EQ(0, bpm.GetMetrics().fetch_misses_);
+  }
+
+  // Split differently, each instance only loads the pages it owns.
+  {
+    ParallelBufferPoolManager bpm(2, 64, disk_manager, nullptr, options);
+    EXPECT_EQ(50, bpm.GetMetrics().warm_loads_);
+    for (page_id_t page_id = 0; page_id < 200; page_id++) {
+      CheckPage(&bpm, page_id);
+    }
+  }
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  for (size_t i = 0; i < num_instances; i++) {
+    remove(("warm_restart_test." + std::to_string(i) + ".ids").c_str());
+  }
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -0,0 +1,221 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler_test.cpp
+//
+// Identification: test/storage/disk_scheduler_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_scheduler.h"
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <future>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+namespace {
+
+/** Fill a page with a byte that depends on its id. */
+void FillPage(page_id_t page_id, char *data) { memset(data, 'a' + page_id % 26, PAGE_SIZE); }
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(DiskSchedulerTest, ScheduleTest) {
+  const std::string db_name = "disk_scheduler_test.db";
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *disk_scheduler = new DiskScheduler(disk_manager);
+  EXPECT_EQ(DiskScheduler::DEFAULT_QUEUE_DEPTH, disk_scheduler->GetQueueDepth());
+
+  char data[PAGE_SIZE];
+  char buffer[PAGE_SIZE];
+  FillPage(0, data);
+
+  // A write, then a read of the same page; the hook runs before the promise is set.
+  bool hook_ran = false;
+  DiskRequest write{true, data, 0, disk_scheduler->CreatePromise(), [&](bool ok, uint64_t) { hook_ran = ok; }, {}, {}};
+  auto write_done = write.callback_.get_future();
+  disk_scheduler->Schedule(std::move(write));
+  ASSERT_TRUE(write_done.get());
+  EXPECT_TRUE(hook_ran);
+
+  DiskRequest read{false, buffer, 0, disk_scheduler->CreatePromise(), nullptr, {}, {}};
+  auto read_done = read.callback_.get_future();
+  disk_scheduler->Schedule(std::move(read));
+  ASSERT_TRUE(read_done.get());
+  EXPECT_EQ(0, memcmp(buffer, data, PAGE_SIZE));
+
+  auto stats = disk_scheduler->GetStats();
+  EXPECT_EQ(1, stats.reads_);
+  EXPECT_EQ(1, stats.writes_);
+  EXPECT_EQ(0, stats.in_flight_);
+
+  delete disk_scheduler;
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(DiskSchedulerTest, VectoredTest) {
+  const std::string db_name = "disk_scheduler_test.db";
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *disk_scheduler = new DiskScheduler(disk_manager, 2, db_name);
+
+  // Pages 3..10 in one write, then back in one read.
+  std::vector<std::vector<char>> pages(8, std::vector<char>(PAGE_SIZE));
+  DiskRequest write{true, nullptr, 3, disk_scheduler->CreatePromise(), nullptr, {}, {}};
+  for (size_t i = 0; i < pages.size(); i++) {
+    FillPage(3 + i, pages[i].data());
+    write.iov_.push_back(pages[i].data());
+  }
+  auto write_done = write.callback_.get_future();
+  disk_scheduler->Schedule(std::move(write));
+  ASSERT_TRUE(write_done.get());
+
+  std::vector<std::vector<char>> buffers(8, std::vector<char>(PAGE_SIZE));
+  DiskRequest read{false, nullptr, 3, disk_scheduler->CreatePromise(), nullptr, {}, {}};
+  for (auto &buffer : buffers) {
+    read.iov_.push_back(buffer.data());
+  }
+  auto read_done = read.callback_.get_future();
+  disk_scheduler->Schedule(std::move(read));
+  ASSERT_TRUE(read_done.get());
+  EXPECT_EQ(pages, buffers);
+
+  auto stats = disk_scheduler->GetStats();
+  EXPECT_EQ(1, stats.reads_);
+  EXPECT_EQ(8, stats.pages_read_);
+  EXPECT_EQ(1, stats.writes_);
+  EXPECT_EQ(8, stats.pages_written_);
+
+  // The pages went to the database file itself.
+  char buffer[PAGE_SIZE];
+  disk_manager->ReadPage(7, buffer);
+  EXPECT_EQ(0, memcmp(buffer, pages[4].data(), PAGE_SIZE));
+
+  delete disk_scheduler;
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(DiskSchedulerTest, EndOfFileTest) {
+  const std::string db_name = "disk_scheduler_test.db";
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *disk_scheduler = new DiskScheduler(disk_manager, 2, db_name);
+
+  char data[PAGE_SIZE];
+  char buffer[PAGE_SIZE];
+  FillPage(0, data);
+  ASSERT_TRUE(disk_scheduler->WritePage(0, data));
+  ASSERT_TRUE(disk_scheduler->WritePage(1, data));
+
+  // A page past the end of the file reads as zeros.
+  memset(buffer, 'x', PAGE_SIZE);
+  ASSERT_TRUE(disk_scheduler->ReadPage(5, buffer));
+  char zeros[PAGE_SIZE] = {};
+  EXPECT_EQ(0, memcmp(buffer, zeros, PAGE_SIZE));
+
+  // A file that ends in the middle of a page is an error, not a short page.
+  ASSERT_EQ(0, truncate(db_name.c_str(), PAGE_SIZE + PAGE_SIZE / 2));
+  EXPECT_FALSE(disk_scheduler->ReadPage(1, buffer));
+  ASSERT_TRUE(disk_scheduler->ReadPage(0, buffer));
+  EXPECT_EQ(0, memcmp(buffer, data, PAGE_SIZE));
+
+  delete disk_scheduler;
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(DiskSchedulerTest, DirectIOTest) {
+  const std::string db_name = "disk_scheduler_test.db";
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+
+  // Direct I/O if the file system supports it, buffered I/O otherwise; the pages come back either way, from buffers
+  // that are not aligned too.
+  auto *disk_scheduler = new DiskScheduler(disk_manager, 2, db_name, true);
+  std::vector<char> data(PAGE_SIZE + 1);
+  std::vector<char> buffer(PAGE_SIZE + 1);
+  for (page_id_t i = 0; i < 4; i++) {
+    FillPage(i, data.data() + 1);
+    ASSERT_TRUE(disk_scheduler->WritePage(i, data.data() + 1));
+  }
+  for (page_id_t i = 0; i < 4; i++) {
+    FillPage(i, data.data() + 1);
+    ASSERT_TRUE(disk_scheduler->ReadPage(i, buffer.data() + 1));
+    EXPECT_EQ(0, memcmp(buffer.data() + 1, data.data() + 1, PAGE_SIZE));
+  }
+
+  delete disk_scheduler;
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(DiskSchedulerTest, ConcurrentTest) {
+  const std::string db_name = "disk_scheduler_test.db";
+  const size_t num_pages = 256;
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *disk_scheduler = new DiskScheduler(disk_manager, 8, db_name);
+
+  // Every request is scheduled before any is waited for.
+  std::vector<std::vector<char>> pages(num_pages, std::vector<char>(PAGE_SIZE));
+  std::vector<std::future<bool>> done;
+  for (size_t i = 0; i < num_pages; i++) {
+    FillPage(i, pages[i].data());
+    DiskRequest write{true, pages[i].data(), static_cast<page_id_t>(i), disk_scheduler->CreatePromise(), nullptr, {},
+                      {}};
+    done.push_back(write.callback_.get_future());
+    disk_scheduler->Schedule(std::move(write));
+  }
+  for (auto &future : done) {
+    EXPECT_TRUE(future.get());
+  }
+
+  std::vector<std::vector<char>> buffers(num_pages, std::vector<char>(PAGE_SIZE));
+  done.clear();
+  for (size_t i = 0; i < num_pages; i++) {
+    DiskRequest read{false, buffers[i].data(), static_cast<page_id_t>(i), disk_scheduler->CreatePromise(), nullptr, {},
+                     {}};
+    done.push_back(read.callback_.get_future());
+    disk_scheduler->Schedule(std::move(read));
+  }
+  for (auto &future : done) {
+    EXPECT_TRUE(future.get());
+  }
+  EXPECT_EQ(pages, buffers);
+
+  auto stats = disk_scheduler->GetStats();
+  EXPECT_EQ(num_pages, stats.reads_);
+  EXPECT_EQ(num_pages, stats.writes_);
+  EXPECT_EQ(num_pages, stats.read_latency_.count_);
+  EXPECT_EQ(0, stats.in_flight_);
+
+  delete disk_scheduler;
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  delete disk_manager;
+}
+
+}  // namespace bustub
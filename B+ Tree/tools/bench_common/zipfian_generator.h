@@ -0,0 +1,65 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// zipfian_generator.h
+//
+// Identification: tools/bench_common/zipfian_generator.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <random>
+
+namespace bustub {
+
+/** Zipfian generator over [0, n), as in YCSB (Gray et al., "Quickly Generating Billion-Record Synthetic Databases"). */
+class ZipfianGenerator {
+ public:
+  /**
+   * @param n number of items
+   * @param theta skew, see IsValidTheta
+   */
+  ZipfianGenerator(size_t n, double theta) : n_(n), theta_(theta) {
+    for (size_t i = 1; i <= n_; i++) {
+      zeta_n_ += 1.0 / std::pow(static_cast<double>(i), theta_);
+    }
+    double zeta_2 = 1.0 + 1.0 / std::pow(2.0, theta_);
+    alpha_ = 1.0 / (1.0 - theta_);
+    eta_ = (1.0 - std::pow(2.0 / static_cast<double>(n_), 1.0 - theta_)) / (1.0 - zeta_2 / zeta_n_);
+  }
+
+  /**
+   * @return true if theta is in [0, 1): 0 is uniform, the skew grows towards 1. The approximation divides by 1 - theta,
+   * and is off for theta > 1.
+   */
+  static bool IsValidTheta(double theta) { return theta >= 0.0 && theta < 1.0; }
+
+  /** Thread safe as long as every thread brings its own rng. */
+  size_t Next(std::mt19937_64 *rng) const {
+    double u = std::uniform_real_distribution<double>(0.0, 1.0)(*rng);
+    double uz = u * zeta_n_;
+    if (uz < 1.0) {
+      return 0;
+    }
+    if (uz < 1.0 + std::pow(0.5, theta_)) {
+      return 1;
+    }
+    return std::min(n_ - 1, static_cast<size_t>(static_cast<double>(n_) * std::pow(eta_ * u - eta_ + 1.0, alpha_)));
+  }
+
+ private:
+  size_t n_;
+  double theta_;
+  double zeta_n_{0};
+  double alpha_;
+  double eta_;
+};
+
+}  // namespace bustub
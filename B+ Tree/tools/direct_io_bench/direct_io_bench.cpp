@@ -0,0 +1,260 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// direct_io_bench.cpp
+//
+// Identification: tools/direct_io_bench/direct_io_bench.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+/**
+ * Compares buffered I/O with direct I/O (BufferPoolOptions::direct_io_) on the same workload and buffer pool size:
+ * threads fetching and unpinning pages of a database file larger than the pool, with Zipfian skew. Reports, per pool
+ * size and mode:
+ *   - fetch throughput and FetchPage + UnpinPage latency percentiles,
+ *   - the number and p99 latency of the page reads that reached the file,
+ *   - how much of the file the OS page cache holds at the end, i.e. the memory buffered I/O uses on top of the pool.
+ *
+ * Each run starts with the file dropped from the OS page cache. Without a memory limit, buffered I/O can keep the
+ * whole file in the page cache and looks better than it would on a loaded machine. To hold both modes to the same
+ * memory budget, run the bench in a memory cgroup, which is charged for the page cache too, e.g.
+ *   systemd-run --scope -p MemoryMax=512M direct_io_bench --pool-sizes=65536
+ * The database file must be on a file system with O_DIRECT support, i.e. not on tmpfs with older kernels.
+ *
+ * Usage:
+ *   direct_io_bench [--dir=PATH] [--pages=N] [--pool-sizes=a,b,c] [--ops=N] [--threads=N] [--theta=F]
+ *                   [--write-ratio=F] [--io-depth=N] [--seed=N]
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "../bench_common/zipfian_generator.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/disk/latency_histogram.h"
+
+namespace bustub {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchConfig {
+  std::string dir_{"."};
+  size_t num_pages_{262144};
+  std::vector<size_t> pool_sizes_{16384, 65536};
+  size_t num_ops_{1000000};
+  size_t threads_{4};
+  double theta_{0.9};
+  double write_ratio_{0.1};
+  size_t io_depth_{DiskScheduler::DEFAULT_QUEUE_DEPTH};
+  uint64_t seed_{15445};
+};
+
+/** Write the file back and drop it from the OS page cache, so that a run starts cold. */
+void DropFromPageCache(const std::string &file) {
+  int fd = open(file.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return;
+  }
+  fdatasync(fd);
+  posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+  close(fd);
+}
+
+/** @return the bytes of the file in the OS page cache */
+size_t BytesInPageCache(const std::string &file, size_t size) {
+  int fd = open(file.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return 0;
+  }
+  void *addr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    return 0;
+  }
+  auto os_page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  std::vector<unsigned char> resident((size + os_page - 1) / os_page);
+  size_t bytes = 0;
+  if (mincore(addr, size, resident.data()) == 0) {
+    bytes = std::count_if(resident.begin(), resident.end(), [](unsigned char r) { return (r & 1) != 0; }) * os_page;
+  }
+  munmap(addr, size);
+  return bytes;
+}
+
+struct RunResult {
+  double ops_per_sec_{0};
+  LatencyHistogram op_latency_;
+  BufferPoolMetrics metrics_;
+  size_t page_cache_bytes_{0};
+  bool direct_{false};
+};
+
+RunResult Run(const BenchConfig &config, const std::string &db_file, size_t pool_size, bool direct,
+              const ZipfianGenerator &zipf) {
+  DropFromPageCache(db_file);
+  RunResult result;
+  DiskManager disk_manager(db_file);
+  {
+    BufferPoolOptions options;
+    options.io_queue_depth_ = config.io_depth_;
+    options.db_file_ = db_file;
+    options.direct_io_ = direct;
+    BufferPoolManagerInstance bpm(pool_size, &disk_manager, nullptr, options);
+    result.direct_ = bpm.GetDiskScheduler()->IsDirectIO();
+
+    std::vector<LatencyHistogram> latencies(config.threads_);
+    std::vector<std::thread> threads;
+    auto start = Clock::now();
+    for (size_t t = 0; t < config.threads_; t++) {
+      threads.emplace_back([&, t] {
+        std::mt19937_64 rng(config.seed_ + t);
+        std::bernoulli_distribution is_write(config.write_ratio_);
+        // scatter the hot pages over the file, as the Zipfian ranks would otherwise all be at its start
+        auto scatter = [&config](size_t rank) {
+          return static_cast<page_id_t>(rank * 2654435761U % config.num_pages_);
+        };
+        for (size_t i = t; i < config.num_ops_; i += config.threads_) {
+          page_id_t page_id = scatter(zipf.Next(&rng));
+          bool write = is_write(rng);
+          auto op_start = Clock::now();
+          Page *page = bpm.FetchPage(page_id);
+          if (page == nullptr) {
+            std::cerr << "FetchPage(" << page_id << ") failed" << std::endl;
+            exit(1);
+          }
+          if (write) {
+            page->WLatch();
+            page->GetData()[PAGE_SIZE - 1]++;
+            page->WUnlatch();
+          }
+          bpm.UnpinPage(page_id, write);
+          latencies[t].Record(
+              std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - op_start).count());
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    result.ops_per_sec_ = static_cast<double>(config.num_ops_) / elapsed;
+    for (const auto &latency : latencies) {
+      result.op_latency_.Merge(latency);
+    }
+    result.metrics_ = bpm.GetMetrics();
+    result.page_cache_bytes_ = BytesInPageCache(db_file, config.num_pages_ * PAGE_SIZE);
+  }
+  disk_manager.ShutDown();
+  return result;
+}
+
+std::vector<size_t> ParseSizes(const std::string &list) {
+  std::vector<size_t> sizes;
+  size_t pos = 0;
+  while (pos < list.size()) {
+    size_t comma = list.find(',', pos);
+    if (comma == std::string::npos) {
+      comma = list.size();
+    }
+    sizes.push_back(std::stoull(list.substr(pos, comma - pos)));
+    pos = comma + 1;
+  }
+  return sizes;
+}
+
+BenchConfig ParseArgs(int argc, char **argv) {
+  BenchConfig config;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    auto value = [&arg]() { return arg.substr(arg.find('=') + 1); };
+    if (arg.rfind("--dir=", 0) == 0) {
+      config.dir_ = value();
+    } else if (arg.rfind("--pages=", 0) == 0) {
+      config.num_pages_ = std::stoull(value());
+    } else if (arg.rfind("--pool-sizes=", 0) == 0) {
+      config.pool_sizes_ = ParseSizes(value());
+    } else if (arg.rfind("--ops=", 0) == 0) {
+      config.num_ops_ = std::stoull(value());
+    } else if (arg.rfind("--threads=", 0) == 0) {
+      config.threads_ = std::max<size_t>(std::stoull(value()), 1);
+    } else if (arg.rfind("--theta=", 0) == 0) {
+      config.theta_ = std::stod(value());
+      if (!ZipfianGenerator::IsValidTheta(config.theta_)) {
+        std::cerr << "theta must be in [0, 1), not " << config.theta_ << std::endl;
+        exit(1);
+      }
+    } else if (arg.rfind("--write-ratio=", 0) == 0) {
+      config.write_ratio_ = std::stod(value());
+    } else if (arg.rfind("--io-depth=", 0) == 0) {
+      config.io_depth_ = std::stoull(value());
+    } else if (arg.rfind("--seed=", 0) == 0) {
+      config.seed_ = std::stoull(value());
+    } else {
+      std::cerr << "unknown argument " << arg << std::endl;
+      exit(1);
+    }
+  }
+  return config;
+}
+
+}  // namespace
+
+}  // namespace bustub
+
+int main(int argc, char **argv) {
+  auto config = bustub::ParseArgs(argc, argv);
+  std::string db_file = config.dir_ + "/direct_io_bench.db";
+  std::remove(db_file.c_str());
+  {
+    bustub::DiskManager disk_manager(db_file);
+    std::vector<char> page(bustub::PAGE_SIZE, 0);
+    for (size_t i = 0; i < config.num_pages_; i++) {
+      disk_manager.WritePage(static_cast<bustub::page_id_t>(i), page.data());
+    }
+    disk_manager.ShutDown();
+  }
+  bustub::ZipfianGenerator zipf(config.num_pages_, config.theta_);
+
+  printf("file=%s pages=%zu (%.0f MB) ops=%zu threads=%zu theta=%.2f write_ratio=%.2f\n", db_file.c_str(),
+         config.num_pages_, config.num_pages_ * bustub::PAGE_SIZE / 1048576.0, config.num_ops_, config.threads_,
+         config.theta_, config.write_ratio_);
+  printf("%-8s %8s %7s %10s %8s %8s %9s %9s %10s %10s %12s\n", "mode", "pool", "pool_MB", "ops/s", "p50_us", "p99_us",
+         "p999_us", "reads", "read_p99", "hit%", "os_cache_MB");
+  bool fell_back = false;
+  for (size_t pool_size : config.pool_sizes_) {
+    for (bool direct : {false, true}) {
+      auto r = bustub::Run(config, db_file, pool_size, direct, zipf);
+      fell_back = fell_back || (direct && !r.direct_);
+      const char *mode = !direct ? "buffered" : r.direct_ ? "direct" : "direct?";
+      printf("%-8s %8zu %7.0f %10.0f %8.1f %8.1f %9.1f %9lu %10.1f %9.2f%% %12.1f\n", mode, pool_size,
+             pool_size * bustub::PAGE_SIZE / 1048576.0, r.ops_per_sec_, r.op_latency_.Percentile(50) / 1e3,
+             r.op_latency_.Percentile(99) / 1e3, r.op_latency_.Percentile(99.9) / 1e3,
+             static_cast<unsigned long>(r.metrics_.read_latency_.count_),  // NOLINT
+             r.metrics_.read_latency_.Percentile(99) / 1e3, 100.0 * r.metrics_.HitRatio(),
+             r.page_cache_bytes_ / 1048576.0);
+    }
+  }
+  if (fell_back) {
+    printf("direct? = O_DIRECT is not supported in %s, the run fell back to buffered I/O\n", config.dir_.c_str());
+  }
+  std::remove(db_file.c_str());
+  std::remove((db_file.substr(0, db_file.size() - 3) + ".log").c_str());
+  return 0;
+}
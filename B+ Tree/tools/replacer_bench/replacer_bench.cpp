@@ -0,0 +1,453 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// replacer_bench.cpp
+//
+// Identification: tools/replacer_bench/replacer_bench.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+/**
+ * Replays a page access trace through every Replacer implementation and through BufferPoolManager, and reports, per
+ * policy and pool size:
+ *   - hit ratio and evictions (replacer replay),
+ *   - nanoseconds per Pin / Unpin / Victim call (replacer replay, timer overhead subtracted),
+ *   - nanoseconds per FetchPage + UnpinPage and dirty writebacks (buffer pool replay).
+ *
+ * The buffer pool replay needs a DiskManager. To keep disk latency out of the numbers, the database file goes to a
+ * RAM-backed directory (/dev/shm by default).
+ *
+ * Usage:
+ *   replacer_bench [--trace=zipf|scan|loop|<file>] [--pages=N] [--ops=N] [--pool-sizes=a,b,c] [--theta=F]
+ *                  [--write-ratio=F] [--scan-every=N] [--scan-length=N] [--dir=PATH] [--seed=N] [--cleaner-ms=N]
+ *                  [--io-depth=N] [--huge-pages=none|thp|explicit] [--compressed-cache=BYTES] [--spill-pages=N]
+ *                  [--metrics=text|json]
+ *
+ * --cleaner-ms runs the buffer pool replay with the background page cleaner waking up every N ms.
+ * --io-depth sets the number of disk requests the buffer pool's DiskScheduler carries out at the same time.
+ * --huge-pages picks how the buffer pool's frame arena is backed (see HugePagePolicy).
+ * --compressed-cache gives the buffer pool a compressed second tier of that many bytes for its evicted pages.
+ * --spill-pages gives the buffer pool a spill tier of that many pages, in a file next to the database file.
+ * --metrics prints the buffer pool's BufferPoolMetrics after each replay, as text; with json, the output is only JSON:
+ * one object per replay and line, holding the table's columns and the metrics.
+ *
+ * A trace file holds one access per line: a page id >= 0, optionally followed by whitespace and "w" for a write. Empty
+ * lines and lines starting with '#' are skipped; anything else stops the bench.
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../bench_common/zipfian_generator.h"
+#include "buffer/arc_replacer.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Access {
+  page_id_t page_id_;
+  bool is_write_;
+};
+
+struct BenchConfig {
+  std::string trace_{"zipf"};
+  size_t num_pages_{10000};
+  size_t num_ops_{1000000};
+  std::vector<size_t> pool_sizes_{100, 1000, 5000};
+  double theta_{0.99};
+  double write_ratio_{0.1};
+  size_t scan_every_{10000};
+  size_t scan_length_{2000};
+  std::string dir_{"/dev/shm"};
+  uint64_t seed_{15445};
+  uint32_t cleaner_ms_{0};
+  size_t io_depth_{DiskScheduler::DEFAULT_QUEUE_DEPTH};
+  HugePagePolicy huge_pages_{HugePagePolicy::TRANSPARENT};
+  size_t compressed_cache_bytes_{0};
+  size_t spill_pages_{0};
+  /** "text", "json", or empty for no metrics. */
+  std::string metrics_;
+};
+
+std::vector<Access> GenerateTrace(const BenchConfig &config) {
+  std::vector<Access> trace;
+  trace.reserve(config.num_ops_);
+  std::mt19937_64 rng(config.seed_);
+  std::bernoulli_distribution is_write(config.write_ratio_);
+
+  if (config.trace_ == "loop") {
+    // cyclic sweep over all pages: the classic LRU worst case once the loop is larger than the pool
+    for (size_t i = 0; i < config.num_ops_; i++) {
+      trace.push_back({static_cast<page_id_t>(i % config.num_pages_), is_write(rng)});
+    }
+    return trace;
+  }
+
+  if (config.trace_ == "zipf" || config.trace_ == "scan") {
+    ZipfianGenerator zipf(config.num_pages_, config.theta_);
+    // scramble ranks so hot pages are not physically adjacent
+    std::vector<page_id_t> permutation(config.num_pages_);
+    for (size_t i = 0; i < config.num_pages_; i++) {
+      permutation[i] = static_cast<page_id_t>(i);
+    }
+    std::shuffle(permutation.begin(), permutation.end(), rng);
+    std::uniform_int_distribution<size_t> scan_start(0, config.num_pages_ - 1);
+    while (trace.size() < config.num_ops_) {
+      if (config.trace_ == "scan" && config.scan_every_ > 0 && !trace.empty() &&
+          trace.size() % config.scan_every_ == 0) {
+        // a read-only range scan over consecutive pages, e.g. an index scan through the leaf chain
+        size_t start = scan_start(rng);
+        for (size_t i = 0; i < config.scan_length_ && trace.size() < config.num_ops_; i++) {
+          trace.push_back({static_cast<page_id_t>((start + i) % config.num_pages_), false});
+        }
+        continue;
+      }
+      trace.push_back({permutation[zipf.Next(&rng)], is_write(rng)});
+    }
+    return trace;
+  }
+
+  // anything else is a recorded trace file
+  std::ifstream in(config.trace_);
+  if (!in.is_open()) {
+    std::cerr << "cannot open trace file " << config.trace_ << std::endl;
+    exit(1);
+  }
+  std::string line;
+  size_t line_number = 0;
+  while (std::getline(in, line)) {
+    line_number++;
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    const char *start = line.c_str();
+    char *end;
+    errno = 0;
+    long page_id = std::strtol(start, &end, 10);  // NOLINT
+    // the op field, if any, follows the page id after whitespace
+    const char *op = end;
+    while (*op == ' ' || *op == '\t') {
+      op++;
+    }
+    size_t op_length = std::strlen(op);
+    while (op_length > 0 && (op[op_length - 1] == ' ' || op[op_length - 1] == '\t' || op[op_length - 1] == '\r')) {
+      op_length--;
+    }
+    bool page_ok = end != start && errno == 0 && page_id >= 0 && page_id <= std::numeric_limits<page_id_t>::max();
+    bool op_ok = op_length == 0 || (op != end && op_length == 1 && *op == 'w');
+    if (!page_ok || !op_ok) {
+      std::cerr << config.trace_ << ":" << line_number << ": not a page id >= 0, optionally followed by \"w\": " << line
+                << std::endl;
+      exit(1);
+    }
+    trace.push_back({static_cast<page_id_t>(page_id), op_length == 1});
+  }
+  return trace;
+}
+
+std::unique_ptr<Replacer> MakeReplacer(ReplacerPolicy policy, size_t pool_size) {
+  switch (policy) {
+    case ReplacerPolicy::CLOCK:
+      return std::make_unique<ClockReplacer>(pool_size);
+    case ReplacerPolicy::LRU_K:
+      return std::make_unique<LRUKReplacer>(pool_size);
+    case ReplacerPolicy::ARC:
+      return std::make_unique<ARCReplacer>(pool_size);
+    case ReplacerPolicy::LRU:
+    default:
+      return std::make_unique<LRUReplacer>(pool_size);
+  }
+}
+
+const char *PolicyName(ReplacerPolicy policy) {
+  switch (policy) {
+    case ReplacerPolicy::CLOCK:
+      return "CLOCK";
+    case ReplacerPolicy::LRU_K:
+      return "LRU_K";
+    case ReplacerPolicy::ARC:
+      return "ARC";
+    case ReplacerPolicy::LRU:
+    default:
+      return "LRU";
+  }
+}
+
+/** Cost of one Clock::now() pair, subtracted from every timed call. */
+double TimerOverheadNs() {
+  const int rounds = 100000;
+  auto start = Clock::now();
+  int64_t sink = 0;
+  for (int i = 0; i < rounds; i++) {
+    auto a = Clock::now();
+    auto b = Clock::now();
+    sink += (b - a).count();
+  }
+  auto total = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+  return sink >= 0 ? total / rounds / 2 : 0;
+}
+
+struct ReplacerResult {
+  size_t hits_{0};
+  size_t misses_{0};
+  size_t evictions_{0};
+  double pin_ns_{0};
+  double unpin_ns_{0};
+  double victim_ns_{0};
+  size_t pins_{0};
+  size_t victims_{0};
+};
+
+/** Drive a replacer with a minimal page table, the way BufferPoolManager does. */
+ReplacerResult ReplayReplacer(Replacer *replacer, size_t pool_size, const std::vector<Access> &trace,
+                              double timer_overhead_ns) {
+  ReplacerResult result;
+  std::unordered_map<page_id_t, frame_id_t> page_table;
+  std::vector<page_id_t> frame_page(pool_size, INVALID_PAGE_ID);
+  size_t next_free = 0;
+  double pin_ns = 0;
+  double unpin_ns = 0;
+  double victim_ns = 0;
+
+  for (const auto &access : trace) {
+    frame_id_t frame_id;
+    auto it = page_table.find(access.page_id_);
+    if (it != page_table.end()) {
+      result.hits_++;
+      frame_id = it->second;
+    } else {
+      result.misses_++;
+      if (next_free < pool_size) {
+        frame_id = static_cast<frame_id_t>(next_free++);
+      } else {
+        auto start = Clock::now();
+        bool found = replacer->Victim(&frame_id);
+        victim_ns += std::chrono::duration<double, std::nano>(Clock::now() - start).count() - timer_overhead_ns;
+        result.victims_++;
+        if (!found) {
+          std::cerr << "replacer returned no victim with nothing pinned" << std::endl;
+          exit(1);
+        }
+        result.evictions_++;
+        page_table.erase(frame_page[frame_id]);
+      }
+      page_table[access.page_id_] = frame_id;
+      frame_page[frame_id] = access.page_id_;
+    }
+
+    auto start = Clock::now();
+    replacer->RecordAccess(frame_id, access.page_id_);
+    replacer->Pin(frame_id);
+    auto mid = Clock::now();
+    replacer->Unpin(frame_id);
+    auto end = Clock::now();
+    pin_ns += std::chrono::duration<double, std::nano>(mid - start).count() - timer_overhead_ns;
+    unpin_ns += std::chrono::duration<double, std::nano>(end - mid).count() - timer_overhead_ns;
+    result.pins_++;
+  }
+  result.pin_ns_ = result.pins_ > 0 ? pin_ns / result.pins_ : 0;
+  result.unpin_ns_ = result.pins_ > 0 ? unpin_ns / result.pins_ : 0;
+  result.victim_ns_ = result.victims_ > 0 ? victim_ns / result.victims_ : 0;
+  return result;
+}
+
+struct PoolResult {
+  double op_ns_{0};
+  int writebacks_{0};
+  BufferPoolMetrics metrics_;
+};
+
+/** Drive a real BufferPoolManager; the pages are written to "disk" up front so every fetch finds its page there. */
+PoolResult ReplayBufferPool(ReplacerPolicy policy, size_t pool_size, size_t num_pages, const std::vector<Access> &trace,
+                            const BenchConfig &config) {
+  std::string db_file = config.dir_ + "/replacer_bench.db";
+  std::remove(db_file.c_str());
+  PoolResult result;
+  {
+    DiskManager disk_manager(db_file);
+    std::vector<char> zero_page(PAGE_SIZE, 0);
+    for (size_t i = 0; i < num_pages; i++) {
+      disk_manager.WritePage(static_cast<page_id_t>(i), zero_page.data());
+    }
+    int writes_before = disk_manager.GetNumWrites();
+
+    BufferPoolOptions options;
+    options.replacer_policy_ = policy;
+    options.cleaner_interval_ms_ = config.cleaner_ms_;
+    options.io_queue_depth_ = config.io_depth_;
+    options.huge_pages_ = config.huge_pages_;
+    options.compressed_cache_bytes_ = config.compressed_cache_bytes_;
+    options.spill_file_ = config.dir_ + "/replacer_bench_spill.db";
+    options.spill_capacity_pages_ = config.spill_pages_;
+    BufferPoolManagerInstance bpm(pool_size, &disk_manager, nullptr, options);
+
+    auto start = Clock::now();
+    for (const auto &access : trace) {
+      Page *page = bpm.FetchPage(access.page_id_);
+      if (page == nullptr) {
+        std::cerr << "FetchPage(" << access.page_id_ << ") failed" << std::endl;
+        exit(1);
+      }
+      if (access.is_write_) {
+        page->GetData()[PAGE_SIZE - 1]++;
+      }
+      bpm.UnpinPage(access.page_id_, access.is_write_);
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    result.op_ns_ = trace.empty() ? 0 : elapsed / trace.size();
+    result.writebacks_ = disk_manager.GetNumWrites() - writes_before;
+    result.metrics_ = bpm.GetMetrics();
+    disk_manager.ShutDown();
+  }
+  std::remove(db_file.c_str());
+  std::remove((db_file.substr(0, db_file.size() - 3) + ".log").c_str());
+  // the spill cache deletes its file, but not the log its DiskManager opens
+  std::remove((config.dir_ + "/replacer_bench_spill.log").c_str());
+  return result;
+}
+
+std::vector<size_t> ParseSizes(const std::string &list) {
+  std::vector<size_t> sizes;
+  size_t pos = 0;
+  while (pos < list.size()) {
+    size_t comma = list.find(',', pos);
+    if (comma == std::string::npos) {
+      comma = list.size();
+    }
+    sizes.push_back(std::stoull(list.substr(pos, comma - pos)));
+    pos = comma + 1;
+  }
+  return sizes;
+}
+
+BenchConfig ParseArgs(int argc, char **argv) {
+  BenchConfig config;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    auto value = [&arg]() { return arg.substr(arg.find('=') + 1); };
+    if (arg.rfind("--trace=", 0) == 0) {
+      config.trace_ = value();
+    } else if (arg.rfind("--pages=", 0) == 0) {
+      config.num_pages_ = std::stoull(value());
+    } else if (arg.rfind("--ops=", 0) == 0) {
+      config.num_ops_ = std::stoull(value());
+    } else if (arg.rfind("--pool-sizes=", 0) == 0) {
+      config.pool_sizes_ = ParseSizes(value());
+    } else if (arg.rfind("--theta=", 0) == 0) {
+      config.theta_ = std::stod(value());
+      if (!ZipfianGenerator::IsValidTheta(config.theta_)) {
+        std::cerr << "theta must be in [0, 1), not " << config.theta_ << std::endl;
+        exit(1);
+      }
+    } else if (arg.rfind("--write-ratio=", 0) == 0) {
+      config.write_ratio_ = std::stod(value());
+    } else if (arg.rfind("--scan-every=", 0) == 0) {
+      config.scan_every_ = std::stoull(value());
+    } else if (arg.rfind("--scan-length=", 0) == 0) {
+      config.scan_length_ = std::stoull(value());
+    } else if (arg.rfind("--dir=", 0) == 0) {
+      config.dir_ = value();
+    } else if (arg.rfind("--seed=", 0) == 0) {
+      config.seed_ = std::stoull(value());
+    } else if (arg.rfind("--cleaner-ms=", 0) == 0) {
+      config.cleaner_ms_ = std::stoul(value());
+    } else if (arg.rfind("--io-depth=", 0) == 0) {
+      config.io_depth_ = std::stoull(value());
+    } else if (arg.rfind("--compressed-cache=", 0) == 0) {
+      config.compressed_cache_bytes_ = std::stoull(value());
+    } else if (arg.rfind("--spill-pages=", 0) == 0) {
+      config.spill_pages_ = std::stoull(value());
+    } else if (arg.rfind("--metrics=", 0) == 0) {
+      config.metrics_ = value();
+      if (config.metrics_ != "text" && config.metrics_ != "json") {
+        std::cerr << "unknown metrics format " << config.metrics_ << std::endl;
+        exit(1);
+      }
+    } else if (arg.rfind("--huge-pages=", 0) == 0) {
+      std::string policy = value();
+      if (policy == "none") {
+        config.huge_pages_ = HugePagePolicy::NONE;
+      } else if (policy == "thp") {
+        config.huge_pages_ = HugePagePolicy::TRANSPARENT;
+      } else if (policy == "explicit") {
+        config.huge_pages_ = HugePagePolicy::EXPLICIT;
+      } else {
+        std::cerr << "unknown huge page policy " << policy << std::endl;
+        exit(1);
+      }
+    } else {
+      std::cerr << "unknown argument " << arg << std::endl;
+      exit(1);
+    }
+  }
+  return config;
+}
+
+}  // namespace
+
+}  // namespace bustub
+
+int main(int argc, char **argv) {
+  using bustub::ReplacerPolicy;
+  auto config = bustub::ParseArgs(argc, argv);
+  auto trace = bustub::GenerateTrace(config);
+  size_t num_pages = config.num_pages_;
+  for (const auto &access : trace) {
+    num_pages = std::max(num_pages, static_cast<size_t>(access.page_id_) + 1);
+  }
+  double timer_overhead_ns = bustub::TimerOverheadNs();
+
+  // JSON output is one object per line and nothing else, so that it can be piped straight into a JSON tool
+  bool json = config.metrics_ == "json";
+  if (!json) {
+    printf("trace=%s accesses=%zu pages=%zu timer_overhead=%.1fns\n", config.trace_.c_str(), trace.size(), num_pages,
+           timer_overhead_ns);
+    printf("%-6s %8s %8s %10s %9s %9s %9s %11s %10s\n", "policy", "pool", "hit%", "evictions", "pin_ns", "unpin_ns",
+           "victim_ns", "bpm_op_ns", "writebacks");
+  }
+  for (size_t pool_size : config.pool_sizes_) {
+    for (auto policy : {ReplacerPolicy::LRU, ReplacerPolicy::CLOCK, ReplacerPolicy::LRU_K, ReplacerPolicy::ARC}) {
+      auto replacer = bustub::MakeReplacer(policy, pool_size);
+      auto r = bustub::ReplayReplacer(replacer.get(), pool_size, trace, timer_overhead_ns);
+      auto p = bustub::ReplayBufferPool(policy, pool_size, num_pages, trace, config);
+      double hit_ratio = 100.0 * r.hits_ / std::max<size_t>(1, r.hits_ + r.misses_);
+      if (json) {
+        printf(
+            "{\"trace\":\"%s\",\"policy\":\"%s\",\"pool\":%zu,\"hit_pct\":%.2f,\"evictions\":%zu,\"pin_ns\":%.1f,"
+            "\"unpin_ns\":%.1f,\"victim_ns\":%.1f,\"bpm_op_ns\":%.1f,\"writebacks\":%d,\"metrics\":%s}\n",
+            config.trace_.c_str(), bustub::PolicyName(policy), pool_size, hit_ratio, r.evictions_, r.pin_ns_,
+            r.unpin_ns_, r.victim_ns_, p.op_ns_, p.writebacks_, p.metrics_.ToJson().c_str());
+        continue;
+      }
+      printf("%-6s %8zu %7.2f%% %10zu %9.1f %9.1f %9.1f %11.1f %10d\n", bustub::PolicyName(policy), pool_size,
+             hit_ratio, r.evictions_, r.pin_ns_, r.unpin_ns_, r.victim_ns_, p.op_ns_, p.writebacks_);
+      if (config.metrics_ == "text") {
+        printf("%s", p.metrics_.ToString().c_str());
+      }
+    }
+  }
+  return 0;
+}